@@ -0,0 +1,173 @@
+// ===================================================================================
+// Cycle Benchmarks for CH551, CH552 and CH554                                * v1.0 *
+// ===================================================================================
+//
+// Replaces the main file of the firmware and measures the time critical functions
+// of the firmware sources (src/) with timer0. The image is executed in the 8051
+// simulator of SDCC (ucsim/s51) by ucsim_cycles.py, the results are sent via UART0
+// as lines of text:
+//
+// <name> <cycles> <repetitions>
+//
+// The cycles are machine cycles of timer0 (Fsys/12, the default of timer0 on the
+// CH55x) for all repetitions including the loop overhead. The loop overhead is
+// measured as 'empty' and subtracted by ucsim_cycles.py. The image is built by
+// 'make bench' in the folder of the firmware. The firmware is selected by the
+// define BENCH_<target name> (set by the makefile).
+//
+// Measurements:
+// -------------
+// empty          loop overhead
+// i2c_write      I2C_write() of one byte (9 SCL clocks)
+// i2c_startstop  I2C_start() followed by I2C_stop()
+// dly_us         DLY_us(10)
+// usb_out        USB interrupt of a 64-byte OUT packet to the data endpoint (the
+//                packet is overwritten by the next one without being read)
+// usb_packet     USB interrupt of a 64-byte OUT packet and reading all bytes
+// usb_i2c        like usb_packet, all bytes passed to the I2C bus (bridge loop)
+// oled_char      OLED_plotChar() (terminal only)
+//
+// 2022 by Stefan Wagner:   https://github.com/wagiminator
+
+#include "config.h"
+#include "ch554.h"
+#include "delay.h"
+#include "i2c.h"
+
+// ===================================================================================
+// Firmware Selection
+// ===================================================================================
+#if defined(BENCH_vendor_i2c_bridge)
+  #include "usb_vendor.h"
+  #define BENCH_USB_init()        VEN_init()
+  #define BENCH_USB_available()   VEN_available()
+  #define BENCH_USB_read()        VEN_read()
+  #define BENCH_USB_EP            1
+#elif defined(BENCH_hid_i2c_bridge)
+  #include "usb_hid_data.h"
+  #define BENCH_USB_init()        HID_init()
+  #define BENCH_USB_available()   HID_available()
+  #define BENCH_USB_read()        HID_read()
+  #define BENCH_USB_EP            1
+#elif defined(BENCH_cdc_i2c_bridge) || defined(BENCH_cdc_oled_terminal) \
+   || defined(BENCH_composite_oled_terminal)
+  #include "usb_cdc.h"
+  #define BENCH_USB_init()        CDC_init()
+  #define BENCH_USB_available()   CDC_available()
+  #define BENCH_USB_read()        CDC_read()
+  #define BENCH_USB_EP            2
+#else
+  #error Unknown firmware, define BENCH_<target name>
+#endif
+
+#if defined(BENCH_cdc_oled_terminal) || defined(BENCH_composite_oled_terminal)
+  #include "oled_term.h"
+  #define BENCH_I2C_start()       I2C_start(0x78)       // OLED write address
+  void OLED_plotChar(char c);               // not part of the header of oled_term
+#else
+  #define BENCH_I2C_start()       I2C_start()
+#endif
+
+// ===================================================================================
+// Timer0 (Machine Cycle Counter) and UART0 (Output to ucsim)
+// ===================================================================================
+#define BENCH_start()   {TR0 = 0; TH0 = 0; TL0 = 0; TF0 = 0; TR0 = 1;}
+#define BENCH_stop()    {TR0 = 0;}
+#define BENCH_cycles()  (TF0 ? 0xFFFF : ((uint16_t)TH0 << 8) | TL0)
+
+void BENCH_init(void) {
+  TMOD  = 0x21;                             // timer0: 16-bit, timer1: 8-bit auto-reload
+  TH1   = 0xFF;                             // fastest baud rate
+  PCON |= SMOD;
+  SCON  = 0x50;                             // UART0 mode 1, receiver enabled
+  TR1   = 1;                                // start baud rate generator
+}
+
+void BENCH_putc(char c) {
+  SBUF = c;
+  while(!TI);                               // wait for transmission
+  TI = 0;
+}
+
+void BENCH_print(__code char* str) {
+  while(*str) BENCH_putc(*str++);
+}
+
+void BENCH_printNum(uint16_t n) {
+  __data char buf[6];
+  uint8_t i = 0;
+  do {
+    buf[i++] = '0' + n % 10;
+    n /= 10;
+  } while(n);
+  while(i) BENCH_putc(buf[--i]);
+}
+
+// Send one result line
+void BENCH_report(__code char* name, uint8_t reps) {
+  uint16_t cycles = BENCH_cycles();
+  BENCH_init();                             // timer1 may be used by the perf counters
+  BENCH_print(name);
+  BENCH_putc(' ');
+  BENCH_printNum(cycles);
+  BENCH_putc(' ');
+  BENCH_printNum(reps);
+  BENCH_putc('\n');
+}
+
+// Measure statement for reps repetitions (max 65534 cycles in total)
+#define BENCH_run(name, reps, statement) {  \
+  uint8_t n = reps;                         \
+  BENCH_start();                            \
+  do {statement;} while(--n);               \
+  BENCH_stop();                             \
+  BENCH_report(name, reps);                 \
+}
+
+// ===================================================================================
+// USB Packet Emulation
+// ===================================================================================
+// Sets the registers like the USB device controller after an OUT packet of 64 bytes
+// to the data endpoint and calls the USB interrupt handler.
+void USB_interrupt(void);
+
+void BENCH_usbOut(void) {
+  USB_RX_LEN   = 64;
+  USB_INT_ST   = UIS_TOKEN_OUT | BENCH_USB_EP;
+  U_TOG_OK     = 1;
+  UIF_TRANSFER = 1;
+  USB_interrupt();
+}
+
+void BENCH_usbPacket(void) {
+  BENCH_usbOut();
+  while(BENCH_USB_available()) BENCH_USB_read();
+}
+
+void BENCH_usbI2C(void) {
+  BENCH_usbOut();
+  while(BENCH_USB_available()) I2C_write(BENCH_USB_read());
+}
+
+// ===================================================================================
+// Main Function
+// ===================================================================================
+void main(void) {
+  BENCH_init();                             // no CLK_config()/DLY_ms(): no USB clock
+  I2C_init();
+  BENCH_USB_init();                         // endpoints as after enumeration
+
+  BENCH_run("empty",         16, );
+  BENCH_run("i2c_write",     16, I2C_write(0x55));
+  BENCH_run("i2c_startstop", 16, {BENCH_I2C_start(); I2C_stop();});
+  BENCH_run("dly_us",         4, DLY_us(10));
+  BENCH_run("usb_out",       16, BENCH_usbOut());
+  BENCH_run("usb_packet",     4, BENCH_usbPacket());
+  BENCH_run("usb_i2c",        1, BENCH_usbI2C());
+  #if defined(BENCH_cdc_oled_terminal) || defined(BENCH_composite_oled_terminal)
+  BENCH_run("oled_char",      4, OLED_plotChar('W'));
+  #endif
+
+  BENCH_print("end\n");
+  __asm__(".db 0xa5");                      // undefined opcode: stops ucsim
+}
@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   Cycle Benchmarks in ucsim for CH551, CH552, CH554
+# Version:   v1.0
+# Year:      2022
+# Author:    Stefan Wagner
+# Github:    https://github.com/wagiminator
+# License:   http://creativecommons.org/licenses/by-sa/3.0/
+# ===================================================================================
+#
+# Description:
+# ------------
+# Runs the benchmark image of a firmware (bench.c, built by 'make bench') in the
+# 8051 simulator of SDCC (s51/ucsim) and evaluates the measurements that the image
+# sends via UART0. Reports the cycles per operation. The cycles are compared with
+# the baseline file of the firmware and system clock, the script exits with an
+# error if an operation got slower or if the baseline file is missing. Only
+# '--update' writes the baseline (after an intended change, commit the file).
+#
+# Note: ucsim executes the instructions with the timing of the classic 8051 (12
+# clocks per machine cycle). The E8051 core of the CH55x needs fewer clocks for
+# most instructions, and the ratio differs from instruction to instruction. The
+# cycle counts are exact and reproducible for comparisons between versions of the
+# firmware, but the times, SCL frequency and data rate derived from them are only
+# relative figures, not the timing of the CH55x. Real timings have to be measured
+# on the hardware (e.g. SCL with a logic analyzer).
+#
+# Usage example:
+# --------------
+# python3 ucsim_cycles.py vendor_i2c_bridge_bench.ihx -f 16000000 -b bench_baseline_16000000.json
+#
+# Dependencies:
+# -------------
+# - SDCC with ucsim (s51)
+
+import os
+import sys
+import json
+import argparse
+import tempfile
+import subprocess
+
+# Simulator settings
+UCSIM       = 's51'
+UCSIM_TYPE  = '8052'                    # with timer2 and 256 bytes IRAM
+UCSIM_CMDS  = 'run\nstate\nquit\n'      # run until the undefined opcode at the end
+TIMEOUT     = 60                        # max runtime in seconds
+
+# Derived values
+I2C_BITS    = 9                         # SCL clocks per I2C_write (8 data + ACK)
+DLY_US      = 10                        # parameter of DLY_us() in bench.c
+
+# ===================================================================================
+# Run Image in ucsim
+# ===================================================================================
+
+def runucsim(image, freq):
+    with tempfile.TemporaryDirectory() as tmp:
+        cmdfile = os.path.join(tmp, 'ucsim.cmd')
+        uart    = os.path.join(tmp, 'uart.txt')
+        with open(cmdfile, 'w') as f:
+            f.write(UCSIM_CMDS)
+        result = subprocess.run([UCSIM, '-t', UCSIM_TYPE, '-X', str(freq),
+                                 '-S', 'in=/dev/null,out=' + uart, '-C', cmdfile, image],
+                                stdin = subprocess.DEVNULL, stdout = subprocess.PIPE,
+                                stderr = subprocess.STDOUT, timeout = TIMEOUT,
+                                universal_newlines = True)
+        with open(uart) as f:
+            output = f.read()
+    clocks = None
+    for line in result.stdout.splitlines():
+        if 'clks)' in line:             # Total time since last reset= 0.1 sec (N clks)
+            clocks = int(line.split('(')[-1].split()[0])
+    return output, clocks
+
+# ===================================================================================
+# Evaluate Measurements
+# ===================================================================================
+
+def evaluate(output):
+    raw = {}
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 3:
+            raw[fields[0]] = (int(fields[1]), int(fields[2]))
+    if 'end' not in output or 'empty' not in raw:
+        raise Exception('Benchmark did not complete, UART output:\n' + output)
+    overhead = raw['empty'][0] / raw['empty'][1]
+    cycles   = {}
+    for name, (total, reps) in raw.items():
+        if name == 'empty':
+            continue
+        if total == 0xFFFF:
+            raise Exception('Timer overflow in ' + name + ', reduce repetitions')
+        cycles[name] = round(total / reps - overhead, 1)
+    return cycles
+
+def report(cycles, freq, clocks):
+    us = lambda c: c * clocks * 1000000 / freq
+    print('%-16s %10s %10s' % ('operation', 'cycles', 'us (rel.)'))
+    for name, c in cycles.items():
+        print('%-16s %10.1f %10.2f' % (name, c, us(c)))
+    print('Relative figures (%g clocks per cycle as in ucsim, not CH55x timing):' % clocks)
+    if cycles.get('i2c_write'):
+        print('  SCL:           %.0f kHz' % (I2C_BITS * 1000 / us(cycles['i2c_write'])))
+    if cycles.get('dly_us'):
+        print('  DLY_us(%d):    %.2f us' % (DLY_US, us(cycles['dly_us'])))
+    if cycles.get('usb_i2c'):
+        print('  Bridge rate:   %.0f bytes/s' % (64 * 1000000 / us(cycles['usb_i2c'])))
+
+# ===================================================================================
+# Regression Check
+# ===================================================================================
+
+def compare(cycles, baseline, tolerance):
+    failed = []
+    for name, c in cycles.items():
+        base = baseline.get(name)
+        if base is None:
+            continue
+        if c > base * (1 + tolerance / 100):
+            failed.append(name)
+            print('REGRESSION: %s %.1f cycles (baseline %.1f)' % (name, c, base))
+        elif c < base:
+            print('Improved:   %s %.1f cycles (baseline %.1f)' % (name, c, base))
+    return failed
+
+# ===================================================================================
+# Main Function
+# ===================================================================================
+
+def _main():
+    parser = argparse.ArgumentParser(description = 'Cycle benchmarks in ucsim')
+    parser.add_argument('image', help = 'benchmark image (.ihx)')
+    parser.add_argument('-f', '--freq', type = int, default = 16000000,
+                        help = 'system clock frequency (F_CPU)')
+    parser.add_argument('-c', '--clocks', type = float, default = 12,
+                        help = 'clocks per machine cycle for the relative times '
+                               '(12: classic 8051 as in ucsim)')
+    parser.add_argument('-b', '--baseline', help = 'baseline file (JSON)')
+    parser.add_argument('-t', '--tolerance', type = float, default = 0,
+                        help = 'allowed increase of cycles in percent')
+    parser.add_argument('--update', action = 'store_true', help = 'renew baseline')
+    args = parser.parse_args()
+
+    try:
+        output, total = runucsim(args.image, args.freq)
+        cycles = evaluate(output)
+    except Exception as ex:
+        sys.stderr.write('ERROR: ' + str(ex) + '!\n')
+        sys.exit(1)
+
+    report(cycles, args.freq, args.clocks)
+    if total:
+        print('Total clocks:    %d' % total)
+
+    if not args.baseline:
+        sys.exit(0)
+    if args.update:
+        with open(args.baseline, 'w') as f:
+            json.dump(cycles, f, indent = 2)
+        print('Baseline written to ' + args.baseline)
+        sys.exit(0)
+    if not os.path.exists(args.baseline):
+        sys.stderr.write('ERROR: Baseline ' + args.baseline + ' not found (none is '
+                         'committed yet), create it with --update and commit it!\n')
+        sys.exit(1)
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    if compare(cycles, baseline, args.tolerance):
+        sys.exit(1)
+    print('No regressions.')
+    sys.exit(0)
+
+# ===================================================================================
+
+if __name__ == "__main__":
+    _main()
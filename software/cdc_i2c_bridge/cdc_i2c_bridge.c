@@ -35,7 +35,7 @@
 // Compilation Instructions:
 // -------------------------
 // - Chip:  CH551, CH552 or CH554
-// - Clock: 16 MHz internal
+// - Clock: 16 MHz internal (or 24 MHz with 5V supply: 'make flash FREQ_SYS=24000000')
 // - Adjust the firmware parameters in src/config.h if necessary.
 // - Make sure SDCC toolchain and Python3 with PyUSB is installed.
 // - Press BOOT button on the board and keep it pressed while connecting it via USB
@@ -59,6 +59,13 @@
 #include "src/delay.h"                    // for delays
 #include "src/i2c.h"                      // for I²C
 #include "src/usb_cdc.h"                  // for USB-CDC serial
+#include "src/perf.h"                     // for performance counters
+#include "src/tick.h"                     // for millisecond tick and timestamps
+#include "src/devcfg.h"                   // for persistent device configuration
+#include "src/frames.h"                   // for frame store (splash, suspend)
+#include "src/tiles.h"                    // for tile table (tile based drawing)
+#include "src/task.h"                     // for cooperative tasks and timeouts
+#include "src/power.h"                    // for USB suspend and power-down
 
 // Prototypes for used interrupts
 void USB_interrupt(void);
@@ -66,6 +73,65 @@ void USB_ISR(void) __interrupt(INT_NO_USB) {
   USB_interrupt();
 }
 
+void TMR2_ISR(void) __interrupt(INT_NO_TMR2) {
+  TICK_interrupt();
+}
+
+// ===================================================================================
+// Tasks of the Main Loop
+// ===================================================================================
+
+// Task numbers (performance counter taskId)
+#define TASK_CONFIG     0
+#define TASK_STREAM     1
+#define TASK_FRAME      2
+#define TASK_TILE       3
+#define TASK_POWER      4
+
+__bit streaming = 0;                      // I2C transaction of the CDC stream open
+__bit stalled   = 0;                      // transaction aborted while RTS stays set
+TASK_TIMER streamTimer;                   // timeout of the open transaction
+
+// Pass one received CDC packet to the I2C bus. The transaction lasts as long as
+// RTS is set and ends when all bytes received until then have been written. It is
+// aborted with an I2C bus clear if no data has come for STREAM_TIMEOUT ms. Data
+// that comes while RTS stays set belongs to the aborted transaction and is
+// discarded, the next one starts when RTS has been cleared and set again.
+void streamTask(void) {
+  uint8_t len;
+  if(!streaming) {
+    if(!CDC_getRTS()) {                   // incoming CDC data stream?
+      stalled = 0;
+      return;
+    }
+    if(stalled) {                         // RTS stuck: discard the rest of the
+      while(CDC_available()) CDC_read();  // aborted transaction
+      return;
+    }
+    I2C_start();                          // start I2C transmission
+    streaming = 1;
+    stalled   = 0;
+    TASK_timerStart(streamTimer, STREAM_TIMEOUT);
+  }
+  if(!CDC_getRTS() && !CDC_available()) { // RTS cleared and all bytes written?
+    I2C_stop();                           // stop I2C transmission
+    streaming = 0;
+    return;
+  }
+  len = CDC_available();                  // bytes of the current packet
+  if(!len) {
+    if(TASK_timerExpired(streamTimer)) {  // RTS not cleared (host died)?
+      I2C_clear();                        // abort transaction, free the bus
+      streaming = 0;
+      stalled   = 1;
+      PERF_inc(timeouts);
+    }
+    return;
+  }
+  TASK_timerStart(streamTimer, STREAM_TIMEOUT);
+  while(len--) I2C_write(CDC_read());     // write received data bytes via I2C
+}
+
 // ===================================================================================
 // Main Function
 // ===================================================================================
@@ -74,18 +140,26 @@ void main(void) {
   // Setup
   CLK_config();                           // configure system clock
   DLY_ms(5);                              // wait for clock to stabilize
-  CDC_init();                             // init USB CDC
+  PERF_init();                            // init performance counters
+  TICK_init();                            // start millisecond tick
+  CFG_init();                             // load device configuration
   I2C_init();                             // init I2C
+  CFG_initOLED();                         // init OLED according to power-up mode
+  CDC_init();                             // init USB CDC
+  #ifdef WATCHDOG
+  WDT_start();                            // start watchdog timer
+  #endif
 
   // Loop
   while(1) {
-    if(CDC_getRTS()) {                    // incoming CDC data stream?
-      I2C_start();                        // start I2C transmission
-      while(CDC_getRTS()) {               // repeat for all incoming bytes
-        while(CDC_available())            // incoming CDC data byte?
-          I2C_write(CDC_read());          // write received data byte via I2C
-      }
-      I2C_stop();                         // stop I2C transmission
+    WDT_reset();                          // feed watchdog
+    PERF_loop();                          // measure main loop latency
+    TASK_run(TASK_CONFIG, CFG_update);    // store received device configuration
+    TASK_run(TASK_STREAM, streamTask);    // pass CDC data to I2C
+    if(!streaming) {                      // tasks with own I2C transactions:
+      TASK_run(TASK_FRAME, FRAME_update); // store frame chunk, show frame
+      TASK_run(TASK_TILE,  TILE_update);  // store tiles, draw tile run
+      TASK_run(TASK_POWER, POWER_update); // OLED off and power-down on suspend
     }
   }
 }
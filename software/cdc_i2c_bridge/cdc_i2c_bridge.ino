@@ -9,7 +9,7 @@
 //   and name it like the .ino file. Open the .ino file in the Arduino IDE. Go to 
 //   "Tools -> Board -> CH55x Boards -> CH552 Board". Under "Tools" select the 
 //   following board options:
-//   - Clock Source:  16 MHz (internal)
+//   - Clock Source:  16 MHz (internal) or 24 MHz (internal), 5V
 //   - Upload Method: USB
 //   - USB Settings:  USER CODE /w 266B USB RAM
 // - Press BOOT button on the board and keep it pressed while connecting it via USB
@@ -0,0 +1,124 @@
+// ===================================================================================
+// Frame Store in Code Flash for CH551, CH552 and CH554                       * v1.1 *
+// ===================================================================================
+
+#include "frames.h"
+#include "devcfg.h"
+#include "i2c.h"
+#include "usb_handler.h"
+#include "power.h"
+
+// ===================================================================================
+// Variables
+// ===================================================================================
+__xdata uint8_t FRAME_buffer[FRAME_CHUNK];         // chunk received via USB
+__xdata uint16_t FRAME_addr;                       // code flash address of the chunk
+volatile __bit FRAME_pending = 0;                  // received chunk not yet stored
+volatile uint8_t FRAME_request = FRAME_NONE;       // frame to be shown by main loop
+
+// ===================================================================================
+// Frame Functions
+// ===================================================================================
+
+// Set OLED write position to page and column (works in all addressing modes)
+void FRAME_locate(uint8_t page, uint8_t column) {
+  I2C_start();
+  I2C_write(CFG_record.addr);                     // OLED write address
+  I2C_write(0x00);                                // command mode
+  I2C_write(0xB0 | page);                         // page (page addressing mode)
+  I2C_write(column & 0x0F); I2C_write(0x10 | (column >> 4));  // column
+  I2C_write(0x21); I2C_write(column); I2C_write(127);   // columns and page for
+  I2C_write(0x22); I2C_write(page); I2C_write(page);    // the other modes
+  I2C_stop();
+}
+
+// Set OLED back to full screen, write position to home
+void FRAME_home(void) {
+  I2C_start();
+  I2C_write(CFG_record.addr);
+  I2C_write(0x00);
+  I2C_write(0x21); I2C_write(0); I2C_write(127);
+  I2C_write(0x22); I2C_write(0); I2C_write(7);
+  I2C_write(0xB0); I2C_write(0x00); I2C_write(0x10);
+  I2C_stop();
+}
+
+// Send frame page by page to the OLED
+void FRAME_show(uint8_t frame) {
+  uint8_t i, page;
+  uint16_t addr = FRAME_ADDR + frame * FRAME_SIZE;
+  for(page=0; page<8; page++) {
+    FRAME_locate(page, 0);
+    I2C_start();
+    I2C_write(CFG_record.addr);
+    I2C_write(0x40);                              // data mode
+    for(i=128; i; i--) I2C_write(frame == FRAME_BLANK ? 0x00 : FLASH_readCode(addr++));
+    I2C_stop();
+  }
+  I2C_start();                                    // show frame from display RAM
+  I2C_write(CFG_record.addr);                     // line 0 (undo page flipping and
+  I2C_write(0x00);                                // scrolling of the host)
+  I2C_write(0x40);                                // display start line 0
+  I2C_write(0xD3); I2C_write(0x00);               // display offset 0
+  I2C_stop();
+  FRAME_home();
+}
+
+// Store received chunk in code flash and show requested frame (main loop)
+void FRAME_update(void) {
+  uint8_t i, frame;
+  if(FRAME_pending) {
+    for(i=0; i<FRAME_CHUNK; i+=2)
+      FLASH_writeCode(FRAME_addr + i, FRAME_buffer[i] | (uint16_t)FRAME_buffer[i+1] << 8);
+    FRAME_pending = 0;
+  }
+  frame = FRAME_request;
+  if(frame != FRAME_NONE) {
+    FRAME_request = FRAME_NONE;
+    FRAME_show(frame);
+  }
+}
+
+// Show suspend frame if enabled, then power-down (called by the USB suspend interrupt)
+void FRAME_suspend(void) {
+  if(CFG_record.mode & CFG_MODE_SUSPEND) FRAME_request = FRAME_SUSPEND;
+  POWER_suspend();
+}
+
+// ===================================================================================
+// USB Request Functions
+// ===================================================================================
+
+// Handle vendor setup requests of the frame store
+uint8_t FRAME_control(void) {
+  uint8_t frame = USB_SetupBuf->wValueL;
+  uint16_t offset = ((uint16_t)USB_SetupBuf->wIndexH << 8) | USB_SetupBuf->wIndexL;
+  switch(USB_SetupReq) {
+    case FRAME_REQ_WRITE:                         // write chunk of a frame
+      if(FRAME_pending || frame >= FRAME_COUNT || USB_SetupLen != FRAME_CHUNK
+         || offset >= FRAME_SIZE || offset % FRAME_CHUNK) return 0xff;
+      FRAME_addr = FRAME_ADDR + frame * FRAME_SIZE + offset;
+      USB_pData  = FRAME_buffer;
+      return 0;
+
+    case FRAME_REQ_SHOW:                          // show frame
+      if(frame >= FRAME_COUNT && frame != FRAME_BLANK) return 0xff;
+      FRAME_request = frame;
+      return 0;
+
+    default:
+      return 0xff;
+  }
+}
+
+// Handle vendor control OUT data (chunk of a frame)
+void FRAME_EP0_OUT(void) {
+  if(USB_SetupReq == FRAME_REQ_WRITE) {
+    if(USB_EP0_storeData()) {                     // more packets to come?
+      UEP0_CTRL ^= bUEP_R_TOG;
+      return;
+    }
+    FRAME_pending = 1;                            // store chunk in main loop
+  }
+  UEP0_CTRL = bUEP_T_TOG | UEP_T_RES_ACK | UEP_R_RES_ACK;
+}
@@ -0,0 +1,26 @@
+// ===================================================================================
+// USB Suspend and Power-Down for CH551, CH552 and CH554                      * v1.0 *
+// ===================================================================================
+//
+// When the host suspends the USB bus (idle bus for 3ms, e.g. sleeping PC), the USB
+// interrupt calls POWER_suspend(). The main loop task POWER_update() then switches
+// the OLED off (sleep mode of the SSD1306, the display RAM is kept) and puts the
+// microcontroller into power-down mode with wake-up by USB. When the host resumes
+// the bus (or resets it), the microcontroller continues and switches the OLED on
+// again, so the last picture is back without any action of the host. If the suspend
+// frame is enabled (CFG_MODE_SUSPEND, bridges), the OLED stays on and shows it.
+//
+// The time from wake-up to OLED on and the number of suspends are kept in the
+// performance counters (src/perf.h). The wake-up time of the oscillator is not
+// included, the clock is stopped in power-down mode.
+//
+// Functions available:
+// --------------------
+// POWER_suspend()          USB suspend interrupt handler (USB_SUSPEND_handler)
+// POWER_update()           main loop task: OLED off, power-down, OLED on after resume
+
+#pragma once
+#include <stdint.h>
+
+void POWER_suspend(void);
+void POWER_update(void);
@@ -0,0 +1,45 @@
+// ===================================================================================
+// Cooperative Task Scheduler for CH551, CH552 and CH554                      * v1.0 *
+// ===================================================================================
+//
+// The main loop calls its tasks one after the other with TASK_run(). A task is a
+// function which does a bounded piece of work (e.g. one USB packet) and returns.
+// It never waits in a loop: it keeps its state in static variables and checks
+// again in the next pass of the main loop. So no task can stall the others, and the
+// worst-case latency of every task is the time of one pass (performance counter
+// loopMax). The longest single run of a task and the number of that task are kept
+// in the performance counters as well (see src/perf.h).
+//
+// Timeouts are measured with the millisecond tick (src/tick.h). A timer is a 16-bit
+// variable, timeouts up to 32767ms are possible.
+//
+// Functions available:
+// --------------------
+// TASK_run(id, task)       call task function (no parameters) with number id
+// TASK_timerStart(t, ms)   start timer t, expires after ms milliseconds
+// TASK_timerExpired(t)     check if timer t has expired
+//
+// Example:
+// --------
+// TASK_TIMER beepTimer;
+// void beepTask(void) {
+//   if(beeping && TASK_timerExpired(beepTimer)) {PWM_stop(PIN_BUZZER); beeping = 0;}
+// }
+
+#pragma once
+#include <stdint.h>
+#include "tick.h"
+#include "perf.h"
+
+// ===================================================================================
+// Tasks
+// ===================================================================================
+#define TASK_run(id, task)      {PERF_taskStart(); task(); PERF_taskStop(id);}
+
+// ===================================================================================
+// Timers
+// ===================================================================================
+typedef uint16_t TASK_TIMER;
+
+#define TASK_timerStart(t, ms)  t = (uint16_t)TICK_millis() + (ms)
+#define TASK_timerExpired(t)    ((int16_t)((uint16_t)TICK_millis() - (t)) >= 0)
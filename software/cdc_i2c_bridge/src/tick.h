@@ -0,0 +1,89 @@
+// ===================================================================================
+// Millisecond Tick and Timestamps for CH551, CH552 and CH554                 * v1.0 *
+// ===================================================================================
+//
+// Timer2 runs as free-running time base with F_CPU / 4 and generates an interrupt
+// every millisecond. TICK_millis() returns the milliseconds since TICK_init(),
+// TICK_stamp() a timestamp in units of the timer2 clock (TICK_CLOCK) for short time
+// measurements. Both wrap around (after 49 days or 17 minutes @ 16MHz).
+//
+// The timestamps of the last completed I2C transaction are kept in TICK_trace for
+// end-to-end latency tracing. The host reads them via USB (vendor request, HID
+// feature report or CDC class request, see the respective USB files) in little-
+// endian byte order and maps them to its own clock with the timestamp 'now', which
+// is taken when the request is answered.
+//
+// The millisecond tick is always compiled in, the task scheduler (src/task.h) uses
+// it for timeouts. TICK_TIMESTAMPS must be defined in config.h for the transaction
+// timestamps, otherwise they are compiled out. The timer2 interrupt must be declared
+// in the main file and call TICK_interrupt().
+//
+// Functions available:
+// --------------------
+// TICK_init()              start timer2 and millisecond interrupt
+// TICK_millis()            get milliseconds since start
+// TICK_stamp()             get timestamp in units of 1/TICK_CLOCK s
+// TICK_interrupt()         timer2 interrupt handler
+//
+// TICK_packet(len)         data packet received (in USB interrupt)
+// TICK_drained()           data packet completely read, endpoint ready again
+// TICK_i2cStart()          I2C start condition
+// TICK_i2cStop()           I2C stop condition, transaction completed
+// TICK_copy()              copy TICK_trace to EP0 buffer, returns length (for requests,
+//                          further packets with USB_EP0_copyData())
+//
+// Uses timer2.
+
+#pragma once
+#include <stdint.h>
+#include "ch554.h"
+#include "config.h"
+
+// ===================================================================================
+// Time Base
+// ===================================================================================
+#define TICK_CLOCK    (F_CPU / 4)                 // timer2 clock in Hz
+#define TICK_PERIOD   (TICK_CLOCK / 1000)         // timer2 clocks per millisecond
+#define TICK_RELOAD   (65536 - TICK_PERIOD)       // timer2 reload value
+
+void TICK_init(void);
+uint32_t TICK_millis(void);
+uint32_t TICK_stamp(void);
+void TICK_interrupt(void);
+
+#ifdef TICK_TIMESTAMPS
+
+// ===================================================================================
+// Transaction Timestamps
+// ===================================================================================
+typedef struct {
+  uint32_t clock;         // timestamp frequency in Hz
+  uint32_t now;           // time of the request
+  uint32_t rxFirst;       // first data packet of the transaction received
+  uint32_t rxLast;        // last data packet of the transaction received
+  uint32_t stall;         // time the endpoint was busy (NAK) between first and last packet
+  uint32_t i2cStart;      // I2C start condition
+  uint32_t i2cStop;       // I2C stop condition (transaction completed)
+  uint16_t bytes;         // data bytes received during the transaction
+  uint16_t count;         // number of completed transactions
+} TICK_TRACE_TYPE;
+
+extern __xdata TICK_TRACE_TYPE TICK_trace;
+
+// ===================================================================================
+// Functions
+// ===================================================================================
+void TICK_packet(uint8_t len);
+void TICK_drained(void);
+void TICK_i2cStart(void);
+void TICK_i2cStop(void);
+uint8_t TICK_copy(void);
+
+#else
+
+#define TICK_packet(len)
+#define TICK_drained()
+#define TICK_i2cStart()
+#define TICK_i2cStop()
+
+#endif
@@ -3,6 +3,11 @@
 // ===================================================================================
 
 #include "usb_cdc.h"
+#include "perf.h"
+#include "tick.h"
+#include "devcfg.h"
+#include "frames.h"
+#include "tiles.h"
 
 // ===================================================================================
 // Variables and Defines
@@ -28,6 +33,11 @@ volatile __bit CDC_writeBusyFlag = 0;               // flag of whether upload po
 #define GET_LINE_CODING         0x21  // host reads configured line coding
 #define SET_CONTROL_LINE_STATE  0x22  // generates RS-232/V.24 style control signals
 #define SEND_BREAK              0x23  // send break
+#define GET_PERF_COUNTERS       0x7F  // host reads performance counters (non-standard)
+#define GET_TIMESTAMPS          0x7E  // host reads transaction timestamps (non-standard)
+#define SET_DEVICE_CONFIG       0x7D  // host writes device configuration (non-standard)
+#define GET_DEVICE_CONFIG       0x7C  // host reads device configuration (non-standard)
+#define GET_DEVICE_FEATURES     0x7B  // host reads device feature bits (non-standard)
 
 // ===================================================================================
 // Front End Functions
@@ -68,9 +78,12 @@ char CDC_read(void) {
   char data;
   while(!CDC_readByteCount);                      // wait for data
   data = EP2_buffer[CDC_readPointer++];           // get character
-  if(--CDC_readByteCount == 0)                    // dec number of bytes in buffer
+  if(--CDC_readByteCount == 0) {                  // dec number of bytes in buffer
     UEP2_CTRL = (UEP2_CTRL & ~MASK_UEP_R_RES)
               | UEP_R_RES_ACK;                    // request new data if empty
+    PERF_nakStop();                               // end of endpoint stall
+    TICK_drained();
+  }
   return data;
 }
 
@@ -108,11 +121,48 @@ uint8_t CDC_control(void) {
       return 0;
     case SET_LINE_CODING:                         // 0x20  Configure
       return 0;            
+    #ifdef PERF_COUNTERS
+    case GET_PERF_COUNTERS:                       // 0x7F  read performance counters
+      return PERF_copy();
+    #endif
+    #ifdef TICK_TIMESTAMPS
+    case GET_TIMESTAMPS:                          // 0x7E  read transaction timestamps
+      return TICK_copy();
+    #endif
+    case GET_DEVICE_CONFIG:                       // 0x7C  read device configuration
+      return CFG_copy();
+    case SET_DEVICE_CONFIG:                       // 0x7D  write device configuration
+      return CFG_receive();
+    case GET_DEVICE_FEATURES:                     // 0x7B  read device feature bits
+      return CFG_copyFeatures();
     default:
       return 0xff;                                // command not supported
   }
 }
 
+// Endpoint 0 CLASS IN handler (further packets of the non-standard requests)
+void CDC_EP0_IN(void) {
+  uint8_t len;
+  switch(USB_SetupReq) {
+    #ifdef PERF_COUNTERS
+    case GET_PERF_COUNTERS:
+    #endif
+    #ifdef TICK_TIMESTAMPS
+    case GET_TIMESTAMPS:
+    #endif
+    case GET_DEVICE_CONFIG:
+    case GET_DEVICE_FEATURES:
+      len = USB_EP0_copyData();                   // copy next packet to EP0
+      USB_SetupLen -= len;
+      UEP0_T_LEN    = len;
+      UEP0_CTRL    ^= bUEP_T_TOG;                 // switch between DATA0 and DATA1
+      break;
+    default:
+      UEP0_CTRL = bUEP_R_TOG | UEP_T_RES_NAK | UEP_R_RES_ACK;
+      break;
+  }
+}
+
 // Endpoint 0 CLASS OUT handler
 void CDC_EP0_OUT(void) {
   uint8_t i;
@@ -120,9 +170,43 @@ void CDC_EP0_OUT(void) {
     for(i=0; i<((sizeof(CDC_lineCoding)<=USB_RX_LEN)?sizeof(CDC_lineCoding):USB_RX_LEN); i++)
       ((uint8_t*)&CDC_lineCoding)[i] = EP0_buffer[i];      // receive line coding from host
   }
+  else if(USB_SetupReq == SET_DEVICE_CONFIG) {    // device configuration
+    if(USB_EP0_storeData()) {                     // more packets to come?
+      UEP0_CTRL ^= bUEP_R_TOG;
+      return;
+    }
+    if(CFG_received() == 0xff) {                  // invalid record: stall status stage
+      UEP0_CTRL = bUEP_R_TOG | bUEP_T_TOG | UEP_R_RES_STALL | UEP_T_RES_STALL;
+      return;
+    }
+  }
   UEP0_CTRL = bUEP_T_TOG | UEP_T_RES_ACK | UEP_R_RES_ACK;
 }
 
+// Handle VENDOR SETUP requests (frame store and tile table of the bridge)
+uint8_t CDC_VEN_control(void) {
+  switch(USB_SetupReq) {
+    case TILE_REQ_LOAD:
+    case TILE_REQ_DRAW:
+      return TILE_control();
+    default:
+      return FRAME_control();
+  }
+}
+
+// Endpoint 0 VENDOR OUT handler
+void CDC_VEN_EP0_OUT(void) {
+  switch(USB_SetupReq) {
+    case TILE_REQ_LOAD:
+    case TILE_REQ_DRAW:
+      TILE_EP0_OUT();
+      break;
+    default:
+      FRAME_EP0_OUT();
+      break;
+  }
+}
+
 // Endpoint 1 IN handler
 // No handling is actually necessary here, the auto-NAK is sufficient.
 
@@ -140,5 +224,9 @@ void CDC_EP2_OUT(void) {
               | UEP_R_RES_NAK;                    // not ready to receive more for now
     CDC_readByteCount = USB_RX_LEN;               // set number of received data bytes
     CDC_readPointer   = 0;                        // reset read pointer for fetching
+    PERF_add(bytes, USB_RX_LEN);
+    PERF_inc(naks);
+    PERF_nakStart();
+    TICK_packet(USB_RX_LEN);
   }
 }
@@ -3,6 +3,7 @@
 // ===================================================================================
 
 #include "usb_handler.h"
+#include "perf.h"
 
 // ===================================================================================
 // Variables
@@ -11,6 +12,7 @@ volatile uint8_t  USB_SetupReq, USB_SetupTyp, USB_Config, USB_Addr;
 volatile uint16_t USB_SetupLen;
 volatile __bit    USB_ENUM_OK;
 __code uint8_t*   USB_pDescr;
+__xdata uint8_t*  USB_pData;
 
 // ===================================================================================
 // Setup/Reset Endpoints
@@ -53,6 +55,12 @@ void USB_init(void) {
 // ===================================================================================
 // Copy descriptor *USB_pDescr to EP0_buffer using double pointer
 // (Thanks to Ralph Doncaster)
+#ifdef SIMULATOR
+void USB_EP0_copyDescr(uint8_t len) {
+  uint8_t* tgt = EP0_buffer;
+  while(len--) *tgt++ = *USB_pDescr++;
+}
+#else
 #pragma callee_saves USB_EP0_copyDescr
 void USB_EP0_copyDescr(uint8_t len) {
   len;                          // stop unreferenced argument warning
@@ -77,6 +85,26 @@ void USB_EP0_copyDescr(uint8_t len) {
     pop  acc                    ; acc <- stack
   __endasm;
 }
+#endif
+
+// Copy next packet of data block *USB_pData in XRAM to EP0_buffer for control IN
+// requests of the class/vendor handlers, return number of bytes
+uint8_t USB_EP0_copyData(void) {
+  uint8_t i;
+  uint8_t len = USB_SetupLen >= EP0_SIZE ? EP0_SIZE : USB_SetupLen;
+  for(i=0; i<len; i++) EP0_buffer[i] = *USB_pData++;
+  return len;
+}
+
+// Store data of EP0 OUT packet at *USB_pData for control OUT requests of the
+// class/vendor handlers, return number of bytes still expected
+uint8_t USB_EP0_storeData(void) {
+  uint8_t i;
+  uint8_t len = USB_RX_LEN <= USB_SetupLen ? USB_RX_LEN : USB_SetupLen;
+  for(i=0; i<len; i++) *USB_pData++ = EP0_buffer[i];
+  USB_SetupLen -= len;
+  return USB_SetupLen;
+}
 
 // ===================================================================================
 // Endpoint EP0 Handlers
@@ -408,10 +436,12 @@ void USB_interrupt(void) {
     switch (USB_INT_ST & MASK_UIS_TOKEN) {
 
       case UIS_TOKEN_SETUP:
+        PERF_inc(packetsOut);
         EP0_SETUP_callback();
         break;
 
       case UIS_TOKEN_IN:
+        PERF_inc(packetsIn);
         switch (callIndex) {
           case 0: EP0_IN_callback(); break;
           #ifdef EP1_IN_callback
@@ -431,6 +461,7 @@ void USB_interrupt(void) {
         break;
 
       case UIS_TOKEN_OUT:
+        PERF_inc(packetsOut);
         switch (callIndex) {
           case 0: EP0_OUT_callback(); break;
           #ifdef EP1_OUT_callback
@@ -448,6 +479,12 @@ void USB_interrupt(void) {
           default: break;
         }
         break;
+
+      #ifdef USB_SOF_handler
+      case UIS_TOKEN_SOF:
+        USB_SOF_handler();                  // start of frame (every millisecond)
+        break;
+      #endif
     }
     UIF_TRANSFER = 0;                       // clear interrupt flag
   }
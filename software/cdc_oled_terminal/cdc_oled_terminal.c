@@ -37,7 +37,7 @@
 // Compilation Instructions:
 // -------------------------
 // - Chip:  CH551, CH552 or CH554
-// - Clock: 16 MHz internal
+// - Clock: 16 MHz internal (or 24 MHz with 5V supply: 'make flash FREQ_SYS=24000000')
 // - Adjust the firmware parameters in src/config.h if necessary.
 // - Make sure SDCC toolchain and Python3 with PyUSB is installed.
 // - Press BOOT button on the board and keep it pressed while connecting it via USB
@@ -65,6 +65,11 @@
 #include "src/delay.h"                    // for delays
 #include "src/oled_term.h"                // for OLED
 #include "src/usb_cdc.h"                  // for USB-CDC serial
+#include "src/perf.h"                     // for performance counters
+#include "src/tick.h"                     // for millisecond tick and timestamps
+#include "src/devcfg.h"                   // for persistent device configuration
+#include "src/task.h"                     // for cooperative tasks and timeouts
+#include "src/power.h"                    // for USB suspend and power-down
 
 // Prototypes for used interrupts
 void USB_interrupt(void);
@@ -72,18 +77,52 @@ void USB_ISR(void) __interrupt(INT_NO_USB) {
   USB_interrupt();
 }
 
+void TMR2_ISR(void) __interrupt(INT_NO_TMR2) {
+  TICK_interrupt();
+}
+
 // ===================================================================================
-// Buzzer Function
+// Buzzer Functions
 // ===================================================================================
 
-// Create a short beep on the buzzer
+#define BEEP_FREQ       4000              // tone frequency in Hz
+#define BEEP_MS         64                // length of a beep in ms
+
+__bit beeping = 0;                        // buzzer is on
+TASK_TIMER beepTimer;                     // end of the beep
+
+// Start a short beep on the buzzer (PWM), the buzzer task stops it
 void beep(void) {
-  uint8_t i;
-  for(i=255; i; i--) {
-    PIN_low(PIN_BUZZER);
-    DLY_us(125);
+  PWM_start(PIN_BUZZER);
+  TASK_timerStart(beepTimer, BEEP_MS);
+  beeping = 1;
+}
+
+// ===================================================================================
+// Tasks of the Main Loop
+// ===================================================================================
+
+// Task numbers (performance counter taskId)
+#define TASK_CONFIG     0
+#define TASK_TERMINAL   1
+#define TASK_BUZZER     2
+#define TASK_POWER      3
+
+// Print one received character on the OLED
+void terminalTask(void) {
+  char c;
+  if(!CDC_available()) return;            // something coming in?
+  c = CDC_read();                         // read the character ...
+  OLED_write(c);                          // ... and print it on the OLED
+  if((c == 10) || (c == 7)) beep();       // beep on newline command
+}
+
+// Stop the buzzer at the end of the beep
+void buzzerTask(void) {
+  if(beeping && TASK_timerExpired(beepTimer)) {
+    PWM_stop(PIN_BUZZER);
     PIN_high(PIN_BUZZER);
-    DLY_us(125);
+    beeping = 0;
   }
 }
 
@@ -95,22 +134,33 @@ void main(void) {
   // Setup
   CLK_config();                           // configure system clock
   DLY_ms(5);                              // wait for clock to stabilize
+  PERF_init();                            // init performance counters
+  TICK_init();                            // start millisecond tick
+  CFG_init();                             // load device configuration
   CDC_init();                             // init USB CDC
   OLED_init();                            // init OLED
+  PWM_set_freq(BEEP_FREQ);                // set buzzer tone frequency
+  PWM_write(PIN_BUZZER, 127);             // set buzzer duty cycle 50%
 
-  // Print start message
-  OLED_print("* CDC OLED TERMINAL *");
-  OLED_print("---------------------");
-  OLED_print("Ready\n");
-  OLED_print("_\r");
+  // Print start message (boot splash of the device configuration)
+  if(CFG_record.splash == CFG_SPLASH_TEXT) {
+    OLED_print("* CDC OLED TERMINAL *");
+    OLED_print("---------------------");
+    OLED_print("Ready\n");
+    OLED_print("_\r");
+  }
   beep();
+  #ifdef WATCHDOG
+  WDT_start();                            // start watchdog timer
+  #endif
 
   // Loop
   while(1) {
-    if(CDC_available()) {                 // something coming in?
-      char c = CDC_read();                // read the character ...
-      OLED_write(c);                      // ... and print it on the OLED
-      if((c == 10) || (c == 7)) beep();   // beep on newline command
-    }
+    WDT_reset();                          // feed watchdog
+    PERF_loop();                          // measure main loop latency
+    TASK_run(TASK_CONFIG,   CFG_update);  // store received device configuration
+    TASK_run(TASK_TERMINAL, terminalTask);// print received character
+    TASK_run(TASK_BUZZER,   buzzerTask);  // end of beep
+    TASK_run(TASK_POWER,    POWER_update);// OLED off and power-down on suspend
   }
 }
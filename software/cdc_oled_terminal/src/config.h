@@ -23,3 +23,43 @@
 #define SERIAL_STR          'g','i','t','h','u','b','.','c','o','m','/', \
                             'w','a','g','i','m','i','n','a','t','o','r'
 #define INTERFACE_STR       'C','D','C',' ','S','e','r','i','a','l'
+
+// Performance counters (bytes, I2C transactions, USB packets, NAK time, main loop
+// latency, longest task), readable via USB. Comment out this define to remove them.
+#define PERF_COUNTERS
+
+// Timestamps of the last I2C transaction for latency tracing, readable via USB.
+// Comment out this define to remove them (the millisecond tick of timer2 stays, the
+// tasks of the main loop use it for timeouts).
+#define TICK_TIMESTAMPS
+
+// The watchdog resets the device if the main loop stalls for about one second (the
+// OLED is then initialized again). Comment out this define to disable the watchdog.
+#define WATCHDOG
+
+// OLED geometry: visible pixels, first visible column in the display RAM and COM
+// pins configuration. Common panels (width, height, column offset, COM pins):
+// - SSD1306 128x64: 128, 64,  0, 0x12      - SSD1306 128x32: 128, 32,  0, 0x02
+// - SSD1306  72x40:  72, 40, 28, 0x12      - SSD1306  64x48:  64, 48, 32, 0x12
+// - SH1106  128x64: 128, 64,  2, 0x12 and OLED_SH1106 (132 columns display RAM,
+//   page addressing mode only)
+#define OLED_WIDTH          128       // visible columns
+#define OLED_HEIGHT         64        // visible rows (multiple of 8)
+#define OLED_XOFFSET        0         // first visible column in display RAM
+#define OLED_COM_PINS       0x12      // COM pins configuration
+//#define OLED_SH1106                 // SH1106 controller
+
+// Default device configuration, used as long as no configuration has been written
+// to the DataFlash via USB (see src/devcfg.h). The terminal always sends the init
+// sequence (followed by page addressing mode on the SSD1306) and ignores the
+// power-up mode. The SH1106 has its own DC-DC command and no memory addressing mode.
+#define CFG_DEFAULT_ADDR    0x78      // OLED write address (0x3C << 1)
+#define CFG_DEFAULT_MODE    0         // power-up mode (not used)
+#define CFG_DEFAULT_SPLASH  CFG_SPLASH_TEXT
+#ifdef OLED_SH1106
+#define CFG_DEFAULT_INIT    0xA8,OLED_HEIGHT-1, 0xAD,0x8B, \
+                            0xDA,OLED_COM_PINS, 0xA1,0xC8, 0xAF
+#else
+#define CFG_DEFAULT_INIT    0xA8,OLED_HEIGHT-1, 0x8D,0x14, 0x20,0x02, \
+                            0xDA,OLED_COM_PINS, 0xA1,0xC8, 0xAF
+#endif
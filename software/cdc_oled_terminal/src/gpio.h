@@ -140,11 +140,19 @@ SBIT(PP37, 0xB0, 7);
 // ===================================================================================
 // Pin manipulation macros
 // ===================================================================================
+#ifdef SIMULATOR
+#define PIN_low(PIN)          SIM_pinWrite(PIN, 0)          // set pin to LOW
+#define PIN_high(PIN)         SIM_pinWrite(PIN, 1)          // set pin to HIGH
+#define PIN_toggle(PIN)       SIM_pinWrite(PIN, !SIM_pinRead(PIN))  // TOGGLE pin
+#define PIN_read(PIN)         (SIM_pinRead(PIN))            // READ pin
+#define PIN_write(PIN, val)   SIM_pinWrite(PIN, val)        // WRITE pin value
+#else
 #define PIN_low(PIN)          PIN_h_s(PIN) = 0              // set pin to LOW
 #define PIN_high(PIN)         PIN_h_s(PIN) = 1              // set pin to HIGH
 #define PIN_toggle(PIN)       PIN_h_s(PIN) = !PIN_h_s(PIN)  // TOGGLE pin
 #define PIN_read(PIN)         (PIN_h_s(PIN))                // READ pin
 #define PIN_write(PIN, val)   PIN_h_s(PIN) = val            // WRITE pin value
+#endif
 
 // ===================================================================================
 // (PORT, PIN) manipulation macros
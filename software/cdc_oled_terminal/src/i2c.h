@@ -1,10 +1,13 @@
 // ===================================================================================
-// I2C Functions for CH551, CH552 and CH554                                   * v1.1 *
+// I2C Functions for CH551, CH552 and CH554                                   * v1.2 *
 // ===================================================================================
 //
 // Simple I2C bitbanging for 400kHz slave devices. For system clock < 12MHz the 
 // I2C clock frequency is slower. ACK bit of the slave is ignored. Clock stretching 
-// by the slave is not allowed.
+// by the slave is not allowed. Setting I2C_slow selects standard mode (~100kHz),
+// the fast mode (~500kHz) is an overclock beyond the 400kHz specification.
+// I2C_clear() frees the bus from a slave that holds SDA low (e.g. after an
+// interrupted transaction): up to 9 clock pulses, followed by a stop condition.
 //
 // PIN_SDA and PIN_SCL must be defined in config.h:
 // PIN_SDA - pin connected to serial data of the I2C bus
@@ -21,5 +24,8 @@ void I2C_init(void);            // I2C init function
 void I2C_start(uint8_t addr);   // I2C start transmission
 void I2C_restart(uint8_t addr); // I2C restart transmission
 void I2C_stop(void);            // I2C stop transmission
+void I2C_clear(void);           // I2C bus clear (abort transaction, free SDA)
 void I2C_write(uint8_t data);   // I2C transmit one data byte to the slave
 uint8_t I2C_read(uint8_t ack);  // I2C receive one data byte from the slave
+
+extern __bit I2C_slow;          // I2C standard mode (~100kHz) instead of fast mode
@@ -1,9 +1,10 @@
 // ===================================================================================
-// SSD1306 128x64 Pixels OLED Terminal Functions                              * v1.0 *
+// SSD1306/SH1106 OLED Terminal Functions                                     * v1.2 *
 // ===================================================================================
 //
-// Collection of the most necessary functions for controlling an SSD1306 128x64 pixels
+// Collection of the most necessary functions for controlling an SSD1306 or SH1106
 // I2C OLED for the display of text in the context of emulating a terminal output.
+// The geometry of the panel is set in config.h.
 //
 // References:
 // -----------
@@ -17,12 +18,18 @@
 // 2022 by Stefan Wagner: https://github.com/wagiminator
 
 #include "oled_term.h"
+#include "devcfg.h"
 
 // OLED definitions
-#define OLED_ADDR         0x78    // OLED write address (0x3C << 1)
+#define OLED_ADDR         CFG_record.addr   // OLED write address (device config)
 #define OLED_CMD_MODE     0x00    // set command mode
 #define OLED_DAT_MODE     0x40    // set data mode
 
+// OLED geometry (config.h)
+#define OLED_LINES        (OLED_HEIGHT / 8)   // text lines on the screen
+#define OLED_CHARS        (OLED_WIDTH / 6)    // characters per line
+#define OLED_RAM_MASK     0x07                // display RAM: ring of 8 pages
+
 // OLED commands
 #define OLED_COLUMN_LOW   0x00    // set lower 4 bits of start column (0x00 - 0x0F)
 #define OLED_COLUMN_HIGH  0x10    // set higher 4 bits of start column (0x10 - 0x1F)
@@ -81,16 +88,6 @@ __code uint8_t OLED_FONT[] = {
   0x41, 0x41, 0x36, 0x08, 0x08, 0x08, 0x04, 0x08, 0x10, 0x08, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
 };
 
-// OLED initialisation sequence
-__code uint8_t OLED_INIT_CMD[] = {
-  OLED_MULTIPLEX,   0x3F,                 // set multiplex ratio  
-  OLED_CHARGEPUMP,  0x14,                 // set DC-DC enable  
-  OLED_MEMORYMODE,  0x02,                 // set page addressing mode
-  OLED_COMPINS,     0x12,                 // set com pins
-  OLED_XFLIP, OLED_YFLIP,                 // flip screen
-  OLED_DISPLAY_ON                         // display on
-};
-
 // OLED global variables
 __xdata uint8_t line, column, scroll;
 
@@ -99,7 +96,8 @@ void OLED_setline(uint8_t line) {
   I2C_start(OLED_ADDR);                   // start transmission to OLED
   I2C_write(OLED_CMD_MODE);               // set command mode
   I2C_write(OLED_PAGE + line);            // set line
-  I2C_write(0x00); I2C_write(0x10);       // set column to "0"
+  I2C_write(OLED_COLUMN_LOW  | (OLED_XOFFSET & 0x0F));  // set column to
+  I2C_write(OLED_COLUMN_HIGH | (OLED_XOFFSET >> 4));    // first visible one
   I2C_stop();                             // stop transmission
 }
 
@@ -109,23 +107,23 @@ void OLED_clearline(uint8_t line) {
   OLED_setline(line);                     // set cursor to line start
   I2C_start(OLED_ADDR);                   // start transmission to OLED
   I2C_write(OLED_DAT_MODE);               // set data mode
-  for(i=128; i; i--) I2C_write(0x00);     // clear the line
+  for(i=OLED_WIDTH; i; i--) I2C_write(0x00);  // clear the line
   I2C_stop();                             // stop transmission
 }
 
 // OLED clear screen
 void OLED_clear(void) {
   uint8_t i;
-  for(i=0; i<8; i++) OLED_clearline(i);
-  line = scroll;
-  column = 0;
-  OLED_setline((line + scroll) & 0x07);
+  for(i=0; i<=OLED_RAM_MASK; i++) OLED_clearline(i);
+  line = 0;                               // (cursor line counts from the top of
+  column = 0;                             // the screen, which is at line scroll)
+  OLED_setline(scroll);
 }
 
-// OLED clear the top line, then scroll the display up by one line
+// OLED clear the line below the screen, then scroll the display up by one line
 void OLED_scrollDisplay(void) {
-  OLED_clearline(scroll);                 // clear line
-  scroll = (scroll + 1) & 0x07;           // set next line
+  OLED_clearline((scroll + OLED_LINES) & OLED_RAM_MASK);  // clear line
+  scroll = (scroll + 1) & OLED_RAM_MASK;  // set next line
   I2C_start(OLED_ADDR);                   // start transmission to OLED
   I2C_write(OLED_CMD_MODE);               // set command mode
   I2C_write(OLED_OFFSET);                 // set display offset:
@@ -139,8 +137,12 @@ void OLED_init(void) {
   I2C_init();                             // initialize I2C first
   I2C_start(OLED_ADDR);                   // start transmission to OLED
   I2C_write(OLED_CMD_MODE);               // set command mode
-  for(i = 0; i < sizeof(OLED_INIT_CMD); i++)
-    I2C_write(OLED_INIT_CMD[i]);          // send the command bytes
+  for(i = 0; i < CFG_record.length; i++)
+    I2C_write(CFG_record.init[i]);        // send the command bytes (device config)
+  #ifndef OLED_SH1106                     // (SH1106 only has page addressing)
+  I2C_write(OLED_MEMORYMODE);             // terminal needs
+  I2C_write(0x02);                        // page addressing mode
+  #endif
   I2C_stop();                             // stop transmission
   scroll = 0;                             // start with zero scroll
   OLED_clear();                           // clear screen
@@ -164,24 +166,24 @@ void OLED_write(char c) {
   // normal character
   if(c >= 32) {
     OLED_plotChar(c);
-    if(++column > 20) {
+    if(++column >= OLED_CHARS) {
       column = 0;
-      if(line == 7) OLED_scrollDisplay();
+      if(line == OLED_LINES - 1) OLED_scrollDisplay();
       else line++;
-      OLED_setline((line + scroll) & 0x07);
+      OLED_setline((line + scroll) & OLED_RAM_MASK);
     }
   }
   // new line
   else if(c == '\n') {
     column = 0;
-    if(line == 7) OLED_scrollDisplay();
+    if(line == OLED_LINES - 1) OLED_scrollDisplay();
     else line++;
-    OLED_setline((line + scroll) & 0x07);
+    OLED_setline((line + scroll) & OLED_RAM_MASK);
   }
   // carriage return
   else if(c == '\r') {
     column = 0;
-    OLED_setline((line + scroll) & 0x07);
+    OLED_setline((line + scroll) & OLED_RAM_MASK);
   }
 }
 
@@ -195,3 +197,45 @@ void OLED_println(char* str) {
   OLED_print(str);
   OLED_write('\n');
 }
+
+// OLED leave the display to pixel data of the host: horizontal addressing mode over
+// the visible window and no scroll, as the bridges expect it (SH1106: page mode)
+void OLED_release(void) {
+  I2C_start(OLED_ADDR);                   // start transmission to OLED
+  I2C_write(OLED_CMD_MODE);               // set command mode
+  #ifndef OLED_SH1106
+  I2C_write(OLED_MEMORYMODE);             // horizontal
+  I2C_write(0x00);                        // addressing mode
+  I2C_write(OLED_COLUMNS);                // visible
+  I2C_write(OLED_XOFFSET);                // columns
+  I2C_write(OLED_XOFFSET + OLED_WIDTH - 1);
+  I2C_write(OLED_PAGES);                  // visible
+  I2C_write(0);                           // pages
+  I2C_write(OLED_LINES - 1);
+  #endif
+  I2C_write(OLED_STARTLINE);              // start line 0
+  I2C_write(OLED_OFFSET);                 // no display offset
+  I2C_write(0x00);
+  I2C_stop();                             // stop transmission
+  scroll = 0;                             // picture starts at page 0
+}
+
+// OLED continue the terminal after pixel data of the host: page addressing mode and
+// cursor position of the text, which is then written over the picture
+void OLED_resume(void) {
+  uint8_t x = OLED_XOFFSET + column * 6;  // display RAM column of the cursor
+  scroll = 0;                             // display offset is set to 0 below
+  I2C_start(OLED_ADDR);                   // start transmission to OLED
+  I2C_write(OLED_CMD_MODE);               // set command mode
+  #ifndef OLED_SH1106
+  I2C_write(OLED_MEMORYMODE);             // page
+  I2C_write(0x02);                        // addressing mode
+  #endif
+  I2C_write(OLED_STARTLINE);              // start line 0
+  I2C_write(OLED_OFFSET);                 // no display offset
+  I2C_write(0x00);
+  I2C_write(OLED_PAGE + line);            // set cursor
+  I2C_write(OLED_COLUMN_LOW  | (x & 0x0F));
+  I2C_write(OLED_COLUMN_HIGH | (x >> 4));
+  I2C_stop();                             // stop transmission
+}
@@ -1,9 +1,11 @@
 // ===================================================================================
-// SSD1306 128x64 Pixels OLED Terminal Functions                              * v1.0 *
+// SSD1306/SH1106 OLED Terminal Functions                                     * v1.2 *
 // ===================================================================================
 //
-// Collection of the most necessary functions for controlling an SSD1306 128x64 pixels
+// Collection of the most necessary functions for controlling an SSD1306 or SH1106
 // I2C OLED for the display of text in the context of emulating a terminal output.
+// The geometry of the panel (OLED_WIDTH, OLED_HEIGHT, OLED_XOFFSET) is set in
+// config.h as constants, so that no geometry is calculated at runtime.
 //
 // Functions available:
 // --------------------
@@ -12,6 +14,8 @@
 // OLED_write(c)            Write a character or handle control characters
 // OLED_print(s)            Print string on OLED display
 // OLED_println(s)          Print string with newline
+// OLED_release()           Leave the OLED to pixel data of the host (composite device)
+// OLED_resume()            Continue the terminal after pixel data of the host
 //
 // References:
 // -----------
@@ -26,6 +30,7 @@
 
 #pragma once
 #include <stdint.h>
+#include "config.h"
 #include "i2c.h"
 
 void OLED_init(void);           // OLED init function
@@ -33,3 +38,5 @@ void OLED_clear(void);          // OLED clear screen
 void OLED_write(char c);        // OLED write a character or handle control characters
 void OLED_print(char* str);     // OLED print string
 void OLED_println(char* str);   // OLED print string with newline
+void OLED_release(void);        // OLED addressing mode and window for pixel data
+void OLED_resume(void);         // OLED terminal addressing and cursor again
@@ -0,0 +1,95 @@
+// ===================================================================================
+// Performance Counters for CH551, CH552 and CH554                            * v1.0 *
+// ===================================================================================
+//
+// Lightweight counter block in XRAM, which shows what the device is doing under
+// load. The block is read by the host via USB (vendor request, HID feature report or
+// CDC class request, see the respective USB files) as PERF_counters in little-endian
+// byte order. Times are measured in ticks of timer0/timer1 (F_CPU / 12), the tick
+// frequency is the first entry of the block. Single time measurements saturate at
+// 65535 ticks (49ms @ 16MHz). The longest single run of a task of the main loop
+// (see src/task.h) is measured with the timestamps of timer2 (src/tick.h) and
+// stored as raw timer2 ticks (F_CPU / 4, three per tick of the other times; the
+// host scales them), together with the number of that task. The number of USB
+// suspends and the time from the last wake-up until the OLED was on again are kept
+// for the power-down mode (see src/power.h), and the recoveries from bus hangs:
+// stream transactions aborted after a timeout, I2C bus clears (src/i2c.h) and
+// whether the last reset was caused by the watchdog.
+//
+// PERF_COUNTERS must be defined in config.h, otherwise all counters and functions
+// are compiled out.
+//
+// Functions available:
+// --------------------
+// PERF_init()              init counters and timers (call before USB init)
+// PERF_loop()              mark one pass of the main loop (max main loop latency)
+// PERF_taskStart()         task of the main loop starts
+// PERF_taskStop(id)        task with number id has returned (max task time)
+// PERF_inc(counter)        increase counter by one
+// PERF_add(counter, n)     add n to counter
+// PERF_set(counter, n)     set counter to n
+// PERF_nakStart()          OUT endpoint set to NAK: start stall time measurement
+// PERF_nakStop()           OUT endpoint set to ACK: add stall time
+// PERF_copy()              copy counters to EP0 buffer, returns length (for requests,
+//                          further packets with USB_EP0_copyData())
+//
+// Uses timer0 and timer1.
+
+#pragma once
+#include <stdint.h>
+#include "ch554.h"
+#include "config.h"
+
+#ifdef PERF_COUNTERS
+
+// ===================================================================================
+// Counter Block
+// ===================================================================================
+typedef struct {
+  uint32_t clock;         // tick frequency of the time measurements in Hz
+  uint32_t bytes;         // data bytes received on the data endpoint
+  uint32_t transactions;  // I2C transactions (start conditions)
+  uint32_t packetsOut;    // USB packets received (SETUP and OUT, all endpoints)
+  uint32_t packetsIn;     // USB packets sent (IN, all endpoints)
+  uint32_t naks;          // data packets after which the OUT endpoint responded NAK
+  uint32_t nakTime;       // total time the data OUT endpoint responded NAK in ticks
+  uint16_t loopMax;       // max time of one pass of the main loop in ticks
+  uint32_t taskMax;       // max time of one run of a task in timer2 ticks (F_CPU / 4)
+  uint8_t  taskId;        // number of the task that took taskMax
+  uint16_t suspends;      // USB suspends (power-down mode entered)
+  uint16_t resumeTime;    // time from the last wake-up until OLED on in ticks
+  uint16_t timeouts;      // open I2C transactions aborted (no data for STREAM_TIMEOUT)
+  uint16_t busClears;     // I2C bus clears of a slave that held SDA low
+  uint8_t  watchdog;      // last reset caused by the watchdog (1) or not (0)
+} PERF_COUNTERS_TYPE;
+
+extern __xdata PERF_COUNTERS_TYPE PERF_counters;
+
+// ===================================================================================
+// Functions and Macros
+// ===================================================================================
+void PERF_init(void);
+void PERF_loop(void);
+void PERF_taskStart(void);
+void PERF_taskStop(uint8_t id);
+void PERF_nakStop(void);
+uint8_t PERF_copy(void);
+
+#define PERF_inc(counter)     PERF_counters.counter++
+#define PERF_add(counter, n)  PERF_counters.counter += (n)
+#define PERF_set(counter, n)  PERF_counters.counter  = (n)
+#define PERF_nakStart()       {TR1 = 0; TL1 = 0; TH1 = 0; TF1 = 0; TR1 = 1;}
+
+#else
+
+#define PERF_init()
+#define PERF_loop()
+#define PERF_taskStart()
+#define PERF_taskStop(id)
+#define PERF_inc(counter)
+#define PERF_add(counter, n)
+#define PERF_set(counter, n)
+#define PERF_nakStart()
+#define PERF_nakStop()
+
+#endif
@@ -122,22 +122,40 @@ __code USB_CFG_DESCR_CDC CfgDescr = {
 // String Descriptors
 // ===================================================================================
 
+// String descriptor length (GCC does not allow sizeof() of an array inside its own
+// initializer, therefore the host simulation sets the length on startup)
+#ifdef SIMULATOR
+  #define USB_STR_LEN(descr)  0
+#else
+  #define USB_STR_LEN(descr)  sizeof(descr)
+#endif
+
 // Language Descriptor (Index 0)
 __code uint16_t LangDescr[] = {
-  ((uint16_t)USB_DESCR_TYP_STRING << 8) | sizeof(LangDescr), 0x0409 };  // US English
+  ((uint16_t)USB_DESCR_TYP_STRING << 8) | USB_STR_LEN(LangDescr), 0x0409 };  // US English
 
 // Manufacturer String Descriptor (Index 1)
 __code uint16_t ManufDescr[] = {
-  ((uint16_t)USB_DESCR_TYP_STRING << 8) | sizeof(ManufDescr), MANUFACTURER_STR };
+  ((uint16_t)USB_DESCR_TYP_STRING << 8) | USB_STR_LEN(ManufDescr), MANUFACTURER_STR };
 
 // Product String Descriptor (Index 2)
 __code uint16_t ProdDescr[] = {
-  ((uint16_t)USB_DESCR_TYP_STRING << 8) | sizeof(ProdDescr), PRODUCT_STR };
+  ((uint16_t)USB_DESCR_TYP_STRING << 8) | USB_STR_LEN(ProdDescr), PRODUCT_STR };
 
 // Serial String Descriptor (Index 3)
 __code uint16_t SerDescr[] = {
-  ((uint16_t)USB_DESCR_TYP_STRING << 8) | sizeof(SerDescr), SERIAL_STR };
+  ((uint16_t)USB_DESCR_TYP_STRING << 8) | USB_STR_LEN(SerDescr), SERIAL_STR };
 
 // Interface String Descriptor (Index 4)
 __code uint16_t InterfDescr[] = {
-  ((uint16_t)USB_DESCR_TYP_STRING << 8) | sizeof(InterfDescr), INTERFACE_STR };
+  ((uint16_t)USB_DESCR_TYP_STRING << 8) | USB_STR_LEN(InterfDescr), INTERFACE_STR };
+
+#ifdef SIMULATOR
+__attribute__((constructor)) static void USB_STR_init(void) {
+  LangDescr[0]      |= sizeof(LangDescr);
+  ManufDescr[0]     |= sizeof(ManufDescr);
+  ProdDescr[0]      |= sizeof(ProdDescr);
+  SerDescr[0]       |= sizeof(SerDescr);
+  InterfDescr[0]    |= sizeof(InterfDescr);
+}
+#endif
@@ -15,15 +15,18 @@ extern volatile uint8_t  USB_SetupReq, USB_SetupTyp;
 extern volatile uint16_t USB_SetupLen;
 extern volatile __bit    USB_ENUM_OK;
 extern __code uint8_t*   USB_pDescr;
+extern __xdata uint8_t*  USB_pData;
 
 // ===================================================================================
 // Custom External USB Handler Functions
 // ===================================================================================
 uint8_t CDC_control(void);
 void CDC_EP_init(void);
+void CDC_EP0_IN(void);
 void CDC_EP0_OUT(void);
 void CDC_EP2_IN(void);
 void CDC_EP2_OUT(void);
+void POWER_suspend(void);
 
 // ===================================================================================
 // USB Handler Defines
@@ -32,6 +35,8 @@ void CDC_EP2_OUT(void);
 #define USB_INIT_endpoints      CDC_EP_init     // custom USB EP init handler
 #define USB_CLASS_SETUP_handler CDC_control     // handle class setup requests
 #define USB_CLASS_OUT_handler   CDC_EP0_OUT     // handle class out transfers
+#define USB_CLASS_IN_handler    CDC_EP0_IN      // handle class in transfers
+#define USB_SUSPEND_handler     POWER_suspend   // OLED off, power-down
 
 // Endpoint callback functions
 #define EP0_SETUP_callback  USB_EP0_SETUP
@@ -46,3 +51,5 @@ void CDC_EP2_OUT(void);
 void USB_init(void);
 void USB_interrupt(void);
 void USB_EP0_copyDescr(uint8_t len);
+uint8_t USB_EP0_copyData(void);
+uint8_t USB_EP0_storeData(void);
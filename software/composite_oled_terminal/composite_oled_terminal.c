@@ -0,0 +1,243 @@
+// ===================================================================================
+// Project:   USB Composite OLED Terminal for CH551, CH552, CH554
+// Version:   v1.0
+// Year:      2022
+// Author:    Stefan Wagner
+// Github:    https://github.com/wagiminator
+// EasyEDA:   https://easyeda.com/wagiminator
+// License:   http://creativecommons.org/licenses/by-sa/3.0/
+// ===================================================================================
+//
+// Description:
+// ------------
+// This code implements a USB controlled 128x64 pixels I2C OLED display with two
+// USB functions in one composite device: a communication device class (CDC) for
+// serial communication, which shows text messages on the OLED like the CDC OLED
+// terminal, and a vendor-specific interface with a bulk endpoint, which passes
+// I2C streams of the host (e.g. complete frames) to the OLED like the vendor I2C
+// bridge. Both share the I2C bus: an I2C stream of the vendor interface is always
+// written as a whole, the terminal waits in between. When the owner of the display
+// changes, its addressing mode is switched (page addressing for the text,
+// horizontal addressing over the visible window for pixel data), so that a picture
+// and text can be shown one after the other or on top of each other. The
+// integrated buzzer gives an acoustic signal for every text line received.
+//
+// References:
+// -----------
+// - Blinkinlabs: https://github.com/Blinkinlabs/ch554_sdcc
+// - Deqing Sun: https://github.com/DeqingSun/ch55xduino
+// - Ralph Doncaster: https://github.com/nerdralph/ch554_sdcc
+// - WCH Nanjing Qinheng Microelectronics: http://wch.cn
+// - TinyTerminal: https://github.com/wagiminator/ATtiny85-TinyTerminal
+//
+// Wiring:
+// -------
+//                                       +--\/--+
+//                --------- SCS A1 P14  1|°     |10 V33
+//         BUZZER --- PWM1 MOSI A2 P15  2|      |9  Vcc
+//     OLED (SDA) ------ MISO RXD1 P16  3|      |8  GND
+//     OLED (SCL) ------- SCK TXD1 P17  4|      |7  P37 UDM --- USB D-
+//                ---------------- RST  6|      |6  P36 UDP --- USB D+
+//                                       +------+
+//
+// Compilation Instructions:
+// -------------------------
+// - Chip:  CH551, CH552 or CH554
+// - Clock: 16 MHz internal (or 24 MHz with 5V supply: 'make flash FREQ_SYS=24000000')
+// - Adjust the firmware parameters in src/config.h if necessary.
+// - Make sure SDCC toolchain and Python3 with PyUSB is installed.
+// - Press BOOT button on the board and keep it pressed while connecting it via USB
+//   with your PC.
+// - Run 'make flash' immediatly afterwards.
+// - To compile the firmware using the Arduino IDE, follow the instructions in the 
+//   .ino file.
+//
+// Operating Instructions:
+// -----------------------
+// - Connect the board via USB to your PC. It should be detected as a composite
+//   device with a serial port and a vendor class interface (WinUSB on Windows).
+// - Open a serial monitor and select the correct serial port (BAUD rate doesn't 
+//   matter).
+// - Send a text message, it should be displayed on the OLED.
+// - Pixel data is sent with the vendor bridge of the host library, e.g.
+//   'python3 oled-video.py -t vendor animation.gif'.
+
+
+// ===================================================================================
+// Libraries, Definitions and Macros
+// ===================================================================================
+
+// Libraries
+#include "src/config.h"                   // user configurations
+#include "src/system.h"                   // system functions
+#include "src/gpio.h"                     // for GPIO
+#include "src/delay.h"                    // for delays
+#include "src/i2c.h"                      // for I2C
+#include "src/oled_term.h"                // for OLED
+#include "src/usb_cdc.h"                  // for USB-CDC serial
+#include "src/usb_vendor.h"               // for USB vendor-specific functions
+#include "src/perf.h"                     // for performance counters
+#include "src/tick.h"                     // for millisecond tick and timestamps
+#include "src/devcfg.h"                   // for persistent device configuration
+#include "src/task.h"                     // for cooperative tasks and timeouts
+#include "src/power.h"                    // for USB suspend and power-down
+
+// Prototypes for used interrupts
+void USB_interrupt(void);
+void USB_ISR(void) __interrupt(INT_NO_USB) {
+  USB_interrupt();
+}
+
+void TMR2_ISR(void) __interrupt(INT_NO_TMR2) {
+  TICK_interrupt();
+}
+
+// ===================================================================================
+// Buzzer Functions
+// ===================================================================================
+
+#define BEEP_FREQ       4000              // tone frequency in Hz
+#define BEEP_MS         64                // length of a beep in ms
+
+__bit beeping = 0;                        // buzzer is on
+TASK_TIMER beepTimer;                     // end of the beep
+
+// Start a short beep on the buzzer (PWM), the buzzer task stops it
+void beep(void) {
+  PWM_start(PIN_BUZZER);
+  TASK_timerStart(beepTimer, BEEP_MS);
+  beeping = 1;
+}
+
+// ===================================================================================
+// Tasks of the Main Loop
+// ===================================================================================
+
+// Task numbers (performance counter taskId)
+#define TASK_CONFIG     0
+#define TASK_STREAM     1
+#define TASK_TERMINAL   2
+#define TASK_CONTROL    3
+#define TASK_BUZZER     4
+#define TASK_POWER      5
+
+__bit streaming = 0;                      // I2C stream of the vendor interface open
+__bit addressed = 0;                      // slave address of the stream sent
+__bit graphics  = 0;                      // OLED released to pixel data
+TASK_TIMER streamTimer;                   // timeout of the open stream
+
+// Pass one received bulk packet of the vendor interface to the I2C bus. The stream
+// is opened by the I2C start request (the first byte is the slave address) and
+// closed when the stop request has come and all received bytes have been written.
+// It is aborted with an I2C bus clear if no data has come for STREAM_TIMEOUT ms,
+// bulk data that comes after that is discarded (see VEN_EP3_OUT()).
+void streamTask(void) {
+  uint8_t len;
+  if(!streaming) {
+    if(!VEN_I2C_flag) return;             // I2C start?
+    if(!graphics) {                       // terminal was the last one?
+      OLED_release();                     // addressing for pixel data
+      graphics = 1;
+    }
+    streaming = 1;
+    addressed = 0;
+    TASK_timerStart(streamTimer, STREAM_TIMEOUT);
+  }
+  if(!VEN_I2C_flag && !VEN_available()) { // I2C stop and all bytes written?
+    if(addressed) I2C_stop();             // set I2C stop condition
+    streaming = 0;
+    return;
+  }
+  len = VEN_available();                  // bytes of the current packet
+  if(!len) {
+    if(TASK_timerExpired(streamTimer)) {  // stop request lost (host died)?
+      if(addressed) I2C_clear();          // abort transaction, free the bus
+      VEN_I2C_flag = 0;                   // wait for the next start request
+      while(VEN_available()) VEN_read();  // discard data that came meanwhile
+      streaming = 0;
+      PERF_inc(timeouts);
+    }
+    return;
+  }
+  TASK_timerStart(streamTimer, STREAM_TIMEOUT);
+  if(!addressed) {                        // first byte: slave address
+    I2C_start(VEN_read());                // set I2C start condition, send address
+    addressed = 1;
+    len--;
+  }
+  while(len--) I2C_write(VEN_read());     // write received data bytes via I2C
+}
+
+// Print one received character on the OLED (not while a stream is open)
+void terminalTask(void) {
+  char c;
+  if(!CDC_available()) return;            // something coming in?
+  if(graphics) {                          // pixel data was the last one?
+    OLED_resume();                        // addressing and cursor of the terminal
+    graphics = 0;
+  }
+  c = CDC_read();                         // read the character ...
+  OLED_write(c);                          // ... and print it on the OLED
+  if((c == 10) || (c == 7)) beep();       // beep on newline command
+}
+
+// Bootloader and buzzer requests of the vendor interface
+void controlTask(void) {
+  if(VEN_BOOT_flag) {                     // enter bootloader?
+    WDT_stop();                           // (does not feed the watchdog)
+    BOOT_now();
+  }
+  if(VEN_BUZZER_flag) beep();             // buzzer on until the stop request
+}
+
+// Stop the buzzer at the end of the beep
+void buzzerTask(void) {
+  if(beeping && TASK_timerExpired(beepTimer)) {
+    PWM_stop(PIN_BUZZER);
+    PIN_high(PIN_BUZZER);
+    beeping = 0;
+  }
+}
+
+// ===================================================================================
+// Main Function
+// ===================================================================================
+
+void main(void) {
+  // Setup
+  CLK_config();                           // configure system clock
+  DLY_ms(5);                              // wait for clock to stabilize
+  PERF_init();                            // init performance counters
+  TICK_init();                            // start millisecond tick
+  CFG_init();                             // load device configuration
+  CDC_init();                             // init USB (CDC and vendor interface)
+  OLED_init();                            // init OLED
+  PWM_set_freq(BEEP_FREQ);                // set buzzer tone frequency
+  PWM_write(PIN_BUZZER, 127);             // set buzzer duty cycle 50%
+
+  // Print start message (boot splash of the device configuration)
+  if(CFG_record.splash == CFG_SPLASH_TEXT) {
+    OLED_print("*COMPOSITE  TERMINAL*");
+    OLED_print("---------------------");
+    OLED_print("Ready\n");
+    OLED_print("_\r");
+  }
+  beep();
+  #ifdef WATCHDOG
+  WDT_start();                            // start watchdog timer
+  #endif
+
+  // Loop
+  while(1) {
+    WDT_reset();                          // feed watchdog
+    PERF_loop();                          // measure main loop latency
+    TASK_run(TASK_CONFIG,   CFG_update);  // store received device configuration
+    TASK_run(TASK_STREAM,   streamTask);  // pass bulk data to I2C
+    if(!streaming) {                      // tasks with own I2C transactions:
+      TASK_run(TASK_TERMINAL, terminalTask);  // print received character
+      TASK_run(TASK_POWER,  POWER_update);// OLED off and power-down on suspend
+    }
+    TASK_run(TASK_CONTROL,  controlTask); // bootloader and buzzer requests
+    TASK_run(TASK_BUZZER,   buzzerTask);  // end of beep
+  }
+}
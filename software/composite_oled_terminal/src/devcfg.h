@@ -0,0 +1,81 @@
+// ===================================================================================
+// Persistent Device Configuration for CH551, CH552 and CH554                 * v1.0 *
+// ===================================================================================
+//
+// Configuration record in the DataFlash: I2C address and speed of the OLED, its
+// init sequence, the power-up mode and the boot splash. The terminal initializes
+// the OLED with the stored sequence (OLED_init()) and shows the start message
+// depending on the boot splash, the power-up mode is not used. The host reads and writes the record via USB (vendor
+// request, HID feature report or CDC class request, see the respective USB files)
+// as CFG_record. A written record is checked (magic byte, checksum) when the
+// transfer is completed and stored in the DataFlash by CFG_update() in the main
+// loop. If the DataFlash does not contain a valid record, the defaults of config.h
+// (CFG_DEFAULT_...) are used.
+//
+// Functions available:
+// --------------------
+// CFG_init()               load record from DataFlash (defaults if invalid)
+// CFG_update()             store received record in DataFlash (call in main loop)
+// CFG_copy()               copy record to EP0 buffer, returns length (for requests,
+//                          further packets with USB_EP0_copyData())
+// CFG_receive()            prepare receiving a record, returns 0 or 0xff (stall)
+//                          (packets are stored with USB_EP0_storeData())
+// CFG_received()           record completely received, returns 0 or 0xff (stall)
+// CFG_copyFeatures()       copy feature bits (CFG_FEATURES) to EP0 buffer, returns
+//                          length (the host chooses its encodings from them)
+//
+// 2022 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+#include <stdint.h>
+#include "flash.h"
+#include "config.h"
+
+// ===================================================================================
+// Configuration Record
+// ===================================================================================
+#define CFG_MAGIC         0xC5                    // valid record
+#define CFG_INIT_SIZE     (FLASH_SIZE - 7)        // max length of the init sequence
+
+#define CFG_SPEED_FAST    0                       // I2C clock ~500kHz
+#define CFG_SPEED_SLOW    1                       // I2C clock ~100kHz
+
+#define CFG_MODE_INIT     0x01                    // init OLED at power-up
+#define CFG_MODE_CLEAR    0x02                    // clear display RAM at power-up
+#define CFG_MODE_SUSPEND  0x04                    // show suspend frame on USB suspend
+
+#define CFG_SPLASH_NONE   0                       // no boot splash
+#define CFG_SPLASH_TEXT   1                       // start message (terminal)
+#define CFG_SPLASH_FRAME  2                       // splash frame (bridges, src/frames.h)
+
+typedef struct {
+  uint8_t magic;                                  // CFG_MAGIC
+  uint8_t checksum;                               // all bytes of the record add up to 0
+  uint8_t addr;                                   // I2C write address of the OLED
+  uint8_t speed;                                  // I2C clock (CFG_SPEED_...)
+  uint8_t mode;                                   // power-up mode (CFG_MODE_...)
+  uint8_t splash;                                 // boot splash (CFG_SPLASH_...)
+  uint8_t length;                                 // length of the init sequence
+  uint8_t init[CFG_INIT_SIZE];                    // init sequence (OLED commands)
+} CFG_RECORD_TYPE;
+
+extern __xdata CFG_RECORD_TYPE CFG_record;
+
+// ===================================================================================
+// Device Features
+// ===================================================================================
+#define CFG_FEATURE_FRAMES  0x01                  // frame store (src/frames.h)
+#define CFG_FEATURE_TILES   0x02                  // tile table (src/tiles.h)
+#define CFG_FEATURE_GRAY    0x04                  // grayscale mode (src/gray.h)
+
+#define CFG_FEATURES        0                     // terminal: text only
+
+// ===================================================================================
+// Functions
+// ===================================================================================
+void CFG_init(void);
+void CFG_update(void);
+uint8_t CFG_copy(void);
+uint8_t CFG_receive(void);
+uint8_t CFG_received(void);
+uint8_t CFG_copyFeatures(void);
@@ -0,0 +1,241 @@
+// ===================================================================================
+// SSD1306/SH1106 OLED Terminal Functions                                     * v1.2 *
+// ===================================================================================
+//
+// Collection of the most necessary functions for controlling an SSD1306 or SH1106
+// I2C OLED for the display of text in the context of emulating a terminal output.
+// The geometry of the panel is set in config.h.
+//
+// References:
+// -----------
+// - Neven Boyanov: https://github.com/tinusaur/ssd1306xled
+// - Stephen Denne: https://github.com/datacute/Tiny4kOLED
+// - David Johnson-Davies: http://www.technoblogy.com/show?TV4
+// - TinyOLEDdemo: https://github.com/wagiminator/attiny13-tinyoleddemo
+// - TinyTerminal: https://github.com/wagiminator/ATtiny85-TinyTerminal
+// - USB2OLED: https://github.com/wagiminator/CH552-USB-OLED
+//
+// 2022 by Stefan Wagner: https://github.com/wagiminator
+
+#include "oled_term.h"
+#include "devcfg.h"
+
+// OLED definitions
+#define OLED_ADDR         CFG_record.addr   // OLED write address (device config)
+#define OLED_CMD_MODE     0x00    // set command mode
+#define OLED_DAT_MODE     0x40    // set data mode
+
+// OLED geometry (config.h)
+#define OLED_LINES        (OLED_HEIGHT / 8)   // text lines on the screen
+#define OLED_CHARS        (OLED_WIDTH / 6)    // characters per line
+#define OLED_RAM_MASK     0x07                // display RAM: ring of 8 pages
+
+// OLED commands
+#define OLED_COLUMN_LOW   0x00    // set lower 4 bits of start column (0x00 - 0x0F)
+#define OLED_COLUMN_HIGH  0x10    // set higher 4 bits of start column (0x10 - 0x1F)
+#define OLED_MEMORYMODE   0x20    // set memory addressing mode (following byte)
+#define OLED_COLUMNS      0x21    // set start and end column (following 2 bytes)
+#define OLED_PAGES        0x22    // set start and end page (following 2 bytes)
+#define OLED_STARTLINE    0x40    // set display start line (0x40-0x7F = 0-63)
+#define OLED_CONTRAST     0x81    // set display contrast (following byte)
+#define OLED_CHARGEPUMP   0x8D    // (following byte - 0x14:enable, 0x10: disable)
+#define OLED_XFLIP_OFF    0xA0    // don't flip display horizontally
+#define OLED_XFLIP        0xA1    // flip display horizontally
+#define OLED_INVERT_OFF   0xA6    // set non-inverted display
+#define OLED_INVERT       0xA7    // set inverse display
+#define OLED_MULTIPLEX    0xA8    // set multiplex ratio (following byte)
+#define OLED_DISPLAY_OFF  0xAE    // set display off (sleep mode)
+#define OLED_DISPLAY_ON   0xAF    // set display on
+#define OLED_PAGE         0xB0    // set start page (following byte)
+#define OLED_YFLIP_OFF    0xC0    // don't flip display vertically
+#define OLED_YFLIP        0xC8    // flip display vertically
+#define OLED_OFFSET       0xD3    // set display offset (y-scroll: following byte)
+#define OLED_COMPINS      0xDA    // set COM pin config (following byte)
+
+// Standard ASCII 5x8 font (chars 32 - 127)
+__code uint8_t OLED_FONT[] = {
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5F, 0x00, 0x00, 0x00, 0x07, 0x00, 0x07, 0x00,
+  0x14, 0x7F, 0x14, 0x7F, 0x14, 0x24, 0x2A, 0x7F, 0x2A, 0x12, 0x23, 0x13, 0x08, 0x64, 0x62,
+  0x36, 0x49, 0x55, 0x22, 0x50, 0x00, 0x04, 0x03, 0x00, 0x00, 0x00, 0x1C, 0x22, 0x41, 0x00,
+  0x00, 0x41, 0x22, 0x1C, 0x00, 0x14, 0x08, 0x3E, 0x08, 0x14, 0x08, 0x08, 0x3E, 0x08, 0x08,
+  0x00, 0x80, 0x60, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x60, 0x60, 0x00, 0x00,
+  0x20, 0x10, 0x08, 0x04, 0x02, 0x3E, 0x51, 0x49, 0x45, 0x3E, 0x44, 0x42, 0x7F, 0x40, 0x40,
+  0x42, 0x61, 0x51, 0x49, 0x46, 0x22, 0x41, 0x49, 0x49, 0x36, 0x18, 0x14, 0x12, 0x7F, 0x10,
+  0x2F, 0x49, 0x49, 0x49, 0x31, 0x3E, 0x49, 0x49, 0x49, 0x32, 0x03, 0x01, 0x71, 0x09, 0x07,
+  0x36, 0x49, 0x49, 0x49, 0x36, 0x26, 0x49, 0x49, 0x49, 0x3E, 0x00, 0x36, 0x36, 0x00, 0x00,
+  0x00, 0x80, 0x68, 0x00, 0x00, 0x00, 0x08, 0x14, 0x22, 0x00, 0x14, 0x14, 0x14, 0x14, 0x14,
+  0x00, 0x22, 0x14, 0x08, 0x00, 0x02, 0x01, 0x51, 0x09, 0x06, 0x3E, 0x41, 0x5D, 0x55, 0x5E,
+  0x7C, 0x12, 0x11, 0x12, 0x7C, 0x7F, 0x49, 0x49, 0x49, 0x36, 0x3E, 0x41, 0x41, 0x41, 0x22,
+  0x7F, 0x41, 0x41, 0x22, 0x1C, 0x7F, 0x49, 0x49, 0x49, 0x41, 0x7F, 0x09, 0x09, 0x09, 0x01,
+  0x3E, 0x41, 0x49, 0x49, 0x3A, 0x7F, 0x08, 0x08, 0x08, 0x7F, 0x41, 0x41, 0x7F, 0x41, 0x41,
+  0x20, 0x40, 0x41, 0x3F, 0x01, 0x7F, 0x08, 0x14, 0x22, 0x41, 0x7F, 0x40, 0x40, 0x40, 0x40,
+  0x7F, 0x02, 0x0C, 0x02, 0x7F, 0x7F, 0x04, 0x08, 0x10, 0x7F, 0x3E, 0x41, 0x41, 0x41, 0x3E,
+  0x7F, 0x09, 0x09, 0x09, 0x06, 0x3E, 0x41, 0x41, 0xC1, 0xBE, 0x7F, 0x09, 0x19, 0x29, 0x46,
+  0x26, 0x49, 0x49, 0x49, 0x32, 0x01, 0x01, 0x7F, 0x01, 0x01, 0x3F, 0x40, 0x40, 0x40, 0x3F,
+  0x1F, 0x20, 0x40, 0x20, 0x1F, 0x3F, 0x40, 0x38, 0x40, 0x3F, 0x63, 0x14, 0x08, 0x14, 0x63,
+  0x07, 0x08, 0x70, 0x08, 0x07, 0x61, 0x51, 0x49, 0x45, 0x43, 0x00, 0x7F, 0x41, 0x41, 0x00,
+  0x02, 0x04, 0x08, 0x10, 0x20, 0x00, 0x41, 0x41, 0x7F, 0x00, 0x08, 0x04, 0x02, 0x04, 0x08,
+  0x40, 0x40, 0x40, 0x40, 0x40, 0x00, 0x00, 0x03, 0x04, 0x00, 0x20, 0x54, 0x54, 0x54, 0x78,
+  0x7F, 0x44, 0x44, 0x44, 0x38, 0x38, 0x44, 0x44, 0x44, 0x28, 0x38, 0x44, 0x44, 0x44, 0x7F,
+  0x38, 0x54, 0x54, 0x54, 0x18, 0x08, 0xFE, 0x09, 0x01, 0x02, 0x18, 0xA4, 0xA4, 0xA4, 0x78,
+  0x7F, 0x04, 0x04, 0x04, 0x78, 0x00, 0x44, 0x7D, 0x40, 0x00, 0x00, 0x80, 0x84, 0x7D, 0x00,
+  0x41, 0x7F, 0x10, 0x28, 0x44, 0x00, 0x41, 0x7F, 0x40, 0x00, 0x7C, 0x04, 0x7C, 0x04, 0x78,
+  0x7C, 0x04, 0x04, 0x04, 0x78, 0x38, 0x44, 0x44, 0x44, 0x38, 0xFC, 0x24, 0x24, 0x24, 0x18,
+  0x18, 0x24, 0x24, 0x24, 0xFC, 0x7C, 0x08, 0x04, 0x04, 0x08, 0x08, 0x54, 0x54, 0x54, 0x20,
+  0x04, 0x3F, 0x44, 0x40, 0x20, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x1C, 0x20, 0x40, 0x20, 0x1C,
+  0x3C, 0x40, 0x30, 0x40, 0x3C, 0x44, 0x28, 0x10, 0x28, 0x44, 0x1C, 0xA0, 0xA0, 0xA0, 0x7C,
+  0x44, 0x64, 0x54, 0x4C, 0x44, 0x08, 0x08, 0x36, 0x41, 0x41, 0x00, 0x00, 0xFF, 0x00, 0x00,
+  0x41, 0x41, 0x36, 0x08, 0x08, 0x08, 0x04, 0x08, 0x10, 0x08, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+// OLED global variables
+__xdata uint8_t line, column, scroll;
+
+// OLED set cursor to line start
+void OLED_setline(uint8_t line) {
+  I2C_start(OLED_ADDR);                   // start transmission to OLED
+  I2C_write(OLED_CMD_MODE);               // set command mode
+  I2C_write(OLED_PAGE + line);            // set line
+  I2C_write(OLED_COLUMN_LOW  | (OLED_XOFFSET & 0x0F));  // set column to
+  I2C_write(OLED_COLUMN_HIGH | (OLED_XOFFSET >> 4));    // first visible one
+  I2C_stop();                             // stop transmission
+}
+
+// OLED clear line
+void OLED_clearline(uint8_t line) {
+  uint8_t i;
+  OLED_setline(line);                     // set cursor to line start
+  I2C_start(OLED_ADDR);                   // start transmission to OLED
+  I2C_write(OLED_DAT_MODE);               // set data mode
+  for(i=OLED_WIDTH; i; i--) I2C_write(0x00);  // clear the line
+  I2C_stop();                             // stop transmission
+}
+
+// OLED clear screen
+void OLED_clear(void) {
+  uint8_t i;
+  for(i=0; i<=OLED_RAM_MASK; i++) OLED_clearline(i);
+  line = 0;                               // (cursor line counts from the top of
+  column = 0;                             // the screen, which is at line scroll)
+  OLED_setline(scroll);
+}
+
+// OLED clear the line below the screen, then scroll the display up by one line
+void OLED_scrollDisplay(void) {
+  OLED_clearline((scroll + OLED_LINES) & OLED_RAM_MASK);  // clear line
+  scroll = (scroll + 1) & OLED_RAM_MASK;  // set next line
+  I2C_start(OLED_ADDR);                   // start transmission to OLED
+  I2C_write(OLED_CMD_MODE);               // set command mode
+  I2C_write(OLED_OFFSET);                 // set display offset:
+  I2C_write(scroll << 3);                 // scroll up
+  I2C_stop();                             // stop transmission
+}
+
+// OLED init function
+void OLED_init(void) {
+  uint8_t i;
+  I2C_init();                             // initialize I2C first
+  I2C_start(OLED_ADDR);                   // start transmission to OLED
+  I2C_write(OLED_CMD_MODE);               // set command mode
+  for(i = 0; i < CFG_record.length; i++)
+    I2C_write(CFG_record.init[i]);        // send the command bytes (device config)
+  #ifndef OLED_SH1106                     // (SH1106 only has page addressing)
+  I2C_write(OLED_MEMORYMODE);             // terminal needs
+  I2C_write(0x02);                        // page addressing mode
+  #endif
+  I2C_stop();                             // stop transmission
+  scroll = 0;                             // start with zero scroll
+  OLED_clear();                           // clear screen
+}
+
+// OLED plot a single character
+void OLED_plotChar(char c) {
+  uint8_t i;
+  uint16_t ptr = c - 32;                  // character pointer
+  ptr += ptr << 2;                        // -> ptr = (ch - 32) * 5;
+  I2C_start(OLED_ADDR);                   // start transmission to OLED
+  I2C_write(OLED_DAT_MODE);               // set data mode
+  for(i=5 ; i; i--) I2C_write(OLED_FONT[ptr++]);
+  I2C_write(0x00);                        // write space between characters
+  I2C_stop();                             // stop transmission
+}
+
+// OLED write a character or handle control characters
+void OLED_write(char c) {
+  c = c & 0x7F;                           // ignore top bit
+  // normal character
+  if(c >= 32) {
+    OLED_plotChar(c);
+    if(++column >= OLED_CHARS) {
+      column = 0;
+      if(line == OLED_LINES - 1) OLED_scrollDisplay();
+      else line++;
+      OLED_setline((line + scroll) & OLED_RAM_MASK);
+    }
+  }
+  // new line
+  else if(c == '\n') {
+    column = 0;
+    if(line == OLED_LINES - 1) OLED_scrollDisplay();
+    else line++;
+    OLED_setline((line + scroll) & OLED_RAM_MASK);
+  }
+  // carriage return
+  else if(c == '\r') {
+    column = 0;
+    OLED_setline((line + scroll) & OLED_RAM_MASK);
+  }
+}
+
+// OLED print string
+void OLED_print(char* str) {
+  while(*str) OLED_write(*str++);
+}
+
+// OLED print string with newline
+void OLED_println(char* str) {
+  OLED_print(str);
+  OLED_write('\n');
+}
+
+// OLED leave the display to pixel data of the host: horizontal addressing mode over
+// the visible window and no scroll, as the bridges expect it (SH1106: page mode)
+void OLED_release(void) {
+  I2C_start(OLED_ADDR);                   // start transmission to OLED
+  I2C_write(OLED_CMD_MODE);               // set command mode
+  #ifndef OLED_SH1106
+  I2C_write(OLED_MEMORYMODE);             // horizontal
+  I2C_write(0x00);                        // addressing mode
+  I2C_write(OLED_COLUMNS);                // visible
+  I2C_write(OLED_XOFFSET);                // columns
+  I2C_write(OLED_XOFFSET + OLED_WIDTH - 1);
+  I2C_write(OLED_PAGES);                  // visible
+  I2C_write(0);                           // pages
+  I2C_write(OLED_LINES - 1);
+  #endif
+  I2C_write(OLED_STARTLINE);              // start line 0
+  I2C_write(OLED_OFFSET);                 // no display offset
+  I2C_write(0x00);
+  I2C_stop();                             // stop transmission
+  scroll = 0;                             // picture starts at page 0
+}
+
+// OLED continue the terminal after pixel data of the host: page addressing mode and
+// cursor position of the text, which is then written over the picture
+void OLED_resume(void) {
+  uint8_t x = OLED_XOFFSET + column * 6;  // display RAM column of the cursor
+  scroll = 0;                             // display offset is set to 0 below
+  I2C_start(OLED_ADDR);                   // start transmission to OLED
+  I2C_write(OLED_CMD_MODE);               // set command mode
+  #ifndef OLED_SH1106
+  I2C_write(OLED_MEMORYMODE);             // page
+  I2C_write(0x02);                        // addressing mode
+  #endif
+  I2C_write(OLED_STARTLINE);              // start line 0
+  I2C_write(OLED_OFFSET);                 // no display offset
+  I2C_write(0x00);
+  I2C_write(OLED_PAGE + line);            // set cursor
+  I2C_write(OLED_COLUMN_LOW  | (x & 0x0F));
+  I2C_write(OLED_COLUMN_HIGH | (x >> 4));
+  I2C_stop();                             // stop transmission
+}
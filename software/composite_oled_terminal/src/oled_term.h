@@ -0,0 +1,42 @@
+// ===================================================================================
+// SSD1306/SH1106 OLED Terminal Functions                                     * v1.2 *
+// ===================================================================================
+//
+// Collection of the most necessary functions for controlling an SSD1306 or SH1106
+// I2C OLED for the display of text in the context of emulating a terminal output.
+// The geometry of the panel (OLED_WIDTH, OLED_HEIGHT, OLED_XOFFSET) is set in
+// config.h as constants, so that no geometry is calculated at runtime.
+//
+// Functions available:
+// --------------------
+// OLED_init()              Init OLED display
+// OLED_clear()             Clear screen of OLED display
+// OLED_write(c)            Write a character or handle control characters
+// OLED_print(s)            Print string on OLED display
+// OLED_println(s)          Print string with newline
+// OLED_release()           Leave the OLED to pixel data of the host (composite device)
+// OLED_resume()            Continue the terminal after pixel data of the host
+//
+// References:
+// -----------
+// - Neven Boyanov: https://github.com/tinusaur/ssd1306xled
+// - Stephen Denne: https://github.com/datacute/Tiny4kOLED
+// - David Johnson-Davies: http://www.technoblogy.com/show?TV4
+// - TinyOLEDdemo: https://github.com/wagiminator/attiny13-tinyoleddemo
+// - TinyTerminal: https://github.com/wagiminator/ATtiny85-TinyTerminal
+// - USB2OLED: https://github.com/wagiminator/CH552-USB-OLED
+//
+// 2022 by Stefan Wagner: https://github.com/wagiminator
+
+#pragma once
+#include <stdint.h>
+#include "config.h"
+#include "i2c.h"
+
+void OLED_init(void);           // OLED init function
+void OLED_clear(void);          // OLED clear screen
+void OLED_write(char c);        // OLED write a character or handle control characters
+void OLED_print(char* str);     // OLED print string
+void OLED_println(char* str);   // OLED print string with newline
+void OLED_release(void);        // OLED addressing mode and window for pixel data
+void OLED_resume(void);         // OLED terminal addressing and cursor again
@@ -0,0 +1,72 @@
+// ===================================================================================
+// Performance Counters for CH551, CH552 and CH554                            * v1.0 *
+// ===================================================================================
+
+#include "perf.h"
+
+#ifdef PERF_COUNTERS
+#include "usb_handler.h"
+#include "tick.h"
+#include "system.h"
+
+__xdata PERF_COUNTERS_TYPE PERF_counters;
+__xdata uint32_t PERF_taskBegin;            // timestamp of the task start (timer2)
+
+// ===================================================================================
+// Timer Ticks (saturated at 65535)
+// ===================================================================================
+#define PERF_ticks(T) (TF##T ? 0xFFFF : ((uint16_t)TH##T << 8) | TL##T)
+
+// ===================================================================================
+// Functions
+// ===================================================================================
+
+// Init counters, timer0 and timer1 as 16-bit timers with F_CPU / 12
+void PERF_init(void) {
+  uint8_t i;
+  for(i=0; i<sizeof(PERF_counters); i++) ((__xdata uint8_t*)&PERF_counters)[i] = 0;
+  PERF_counters.clock = F_CPU / 12;
+  PERF_counters.watchdog = RST_wasWDT();
+  TMOD = bT1_M0 | bT0_M0;                   // timer0 and timer1: mode 1 (16-bit)
+  TR0  = 1;                                 // start main loop timer
+}
+
+// Mark one pass of the main loop, restart main loop timer
+void PERF_loop(void) {
+  uint16_t ticks;
+  TR0 = 0;
+  ticks = PERF_ticks(0);
+  TL0 = 0; TH0 = 0; TF0 = 0;
+  TR0 = 1;
+  if(ticks > PERF_counters.loopMax) PERF_counters.loopMax = ticks;
+}
+
+// Task of the main loop starts
+void PERF_taskStart(void) {
+  PERF_taskBegin = TICK_stamp();
+}
+
+// Task has returned: keep max time (raw timer2 ticks, no division in the main loop)
+void PERF_taskStop(uint8_t id) {
+  uint32_t ticks = TICK_stamp() - PERF_taskBegin;
+  if(ticks > PERF_counters.taskMax) {
+    PERF_counters.taskMax = ticks;
+    PERF_counters.taskId  = id;
+  }
+}
+
+// OUT endpoint responds ACK again: add time since PERF_nakStart()
+void PERF_nakStop(void) {
+  TR1 = 0;
+  PERF_counters.nakTime += PERF_ticks(1);
+}
+
+// Copy counters to EP0 buffer for control IN request, return number of bytes
+// (further packets are copied by the IN handler with USB_EP0_copyData())
+uint8_t PERF_copy(void) {
+  if(USB_SetupLen > sizeof(PERF_counters)) USB_SetupLen = sizeof(PERF_counters);
+  USB_pData = (__xdata uint8_t*)&PERF_counters;
+  return USB_EP0_copyData();
+}
+
+#endif
@@ -0,0 +1,124 @@
+// ===================================================================================
+// Millisecond Tick and Timestamps for CH551, CH552 and CH554                 * v1.0 *
+// ===================================================================================
+
+#include "tick.h"
+
+// ===================================================================================
+// Variables
+// ===================================================================================
+volatile __xdata uint32_t TICK_ms;                // milliseconds since start
+volatile __xdata uint32_t TICK_base;              // timestamp of the last reload
+
+#ifdef TICK_TIMESTAMPS
+#include "usb_handler.h"
+
+__xdata TICK_TRACE_TYPE   TICK_trace;             // last completed transaction
+__xdata TICK_TRACE_TYPE   TICK_current;           // transaction in progress
+__xdata TICK_TRACE_TYPE   TICK_report;            // snapshot sent to the host
+__xdata uint32_t          TICK_busy;              // data packet received (endpoint NAK)
+__xdata uint32_t          TICK_pending;           // busy time of the last packet
+#endif
+
+// ===================================================================================
+// Time Base
+// ===================================================================================
+
+// Start timer2: 16-bit auto-reload with F_CPU / 4, interrupt every millisecond
+void TICK_init(void) {
+  T2CON  = 0;                                     // timer, auto-reload, stopped
+  T2MOD |= bT2_CLK;                               // F_CPU / 4
+  RCAP2L = TL2 = TICK_RELOAD & 0xFF;              // reload value
+  RCAP2H = TH2 = TICK_RELOAD >> 8;
+  #ifdef TICK_TIMESTAMPS
+  TICK_trace.clock = TICK_CLOCK;
+  #endif
+  TR2    = 1;                                     // start timer2
+  ET2    = 1;                                     // enable timer2 interrupt
+}
+
+// Timer2 interrupt handler (every millisecond)
+void TICK_interrupt(void) {
+  TF2 = 0;                                        // clear interrupt flag
+  TICK_ms++;
+  TICK_base += TICK_PERIOD;
+}
+
+// Get milliseconds since start
+uint32_t TICK_millis(void) {
+  uint32_t ms;
+  ET2 = 0;                                        // 32-bit read must not be interrupted
+  ms  = TICK_ms;
+  ET2 = 1;
+  return ms;
+}
+
+// Get timestamp in units of the timer2 clock
+uint32_t TICK_stamp(void) {
+  uint32_t base;
+  uint16_t count;
+  uint8_t  ea = EA;
+  EA = 0;
+  do {
+    count = ((uint16_t)TH2 << 8) | TL2;
+  } while((uint8_t)(count >> 8) != TH2);          // repeat if TL2 overflowed meanwhile
+  base = TICK_base;
+  if(TF2 && count < TICK_RELOAD + TICK_PERIOD / 2)
+    base += TICK_PERIOD;                          // reload happened, interrupt pending
+  EA = ea;
+  return base + count - TICK_RELOAD;
+}
+
+#ifdef TICK_TIMESTAMPS
+
+// ===================================================================================
+// Transaction Timestamps
+// ===================================================================================
+
+// Data packet received (called in USB interrupt)
+void TICK_packet(uint8_t len) {
+  uint32_t now = TICK_stamp();
+  if(!TICK_current.bytes) TICK_current.rxFirst = now;
+  else TICK_current.stall += TICK_pending;        // endpoint was busy before this packet
+  TICK_current.rxLast = now;
+  TICK_current.bytes += len;
+  TICK_busy    = now;
+  TICK_pending = 0;
+}
+
+// Data packet completely read, endpoint ready again
+void TICK_drained(void) {
+  TICK_pending = TICK_stamp() - TICK_busy;
+}
+
+// I2C start condition
+void TICK_i2cStart(void) {
+  TICK_current.i2cStart = TICK_stamp();
+}
+
+// I2C stop condition: transaction completed
+void TICK_i2cStop(void) {
+  uint8_t i;
+  TICK_current.i2cStop = TICK_stamp();
+  TICK_current.count   = TICK_trace.count + 1;
+  EA = 0;                                         // requests read TICK_trace
+  for(i=8; i<sizeof(TICK_trace); i++)             // keep clock and now
+    ((__xdata uint8_t*)&TICK_trace)[i] = ((__xdata uint8_t*)&TICK_current)[i];
+  TICK_current.bytes = 0;                         // next transaction
+  TICK_current.stall = 0;
+  EA = 1;
+}
+
+// Copy transaction timestamps to EP0 buffer for control IN request, return length
+// (a snapshot is sent, so that the record cannot change between the packets)
+uint8_t TICK_copy(void) {
+  uint8_t i;
+  TICK_trace.now = TICK_stamp();
+  for(i=0; i<sizeof(TICK_trace); i++)
+    ((__xdata uint8_t*)&TICK_report)[i] = ((__xdata uint8_t*)&TICK_trace)[i];
+  if(USB_SetupLen > sizeof(TICK_report)) USB_SetupLen = sizeof(TICK_report);
+  USB_pData = (__xdata uint8_t*)&TICK_report;
+  return USB_EP0_copyData();
+}
+
+#endif
@@ -0,0 +1,218 @@
+// ===================================================================================
+// USB Descriptors
+// ===================================================================================
+
+#include "usb_descr.h"
+
+// ===================================================================================
+// Device Descriptor
+// ===================================================================================
+__code USB_DEV_DESCR DevDescr = {
+  .bLength            = sizeof(DevDescr),       // size of the descriptor in bytes: 18
+  .bDescriptorType    = USB_DESCR_TYP_DEVICE,   // device descriptor: 0x01
+  .bcdUSB             = 0x0200,                 // USB specification: USB 2.0 (WCID)
+  .bDeviceClass       = 0xEF,                   // miscellaneous device class
+  .bDeviceSubClass    = 0x02,                   // common class
+  .bDeviceProtocol    = 0x01,                   // interface association descriptors
+  .bMaxPacketSize0    = EP0_SIZE,               // maximum packet size for Endpoint 0
+  .idVendor           = USB_VENDOR_ID,          // VID
+  .idProduct          = USB_PRODUCT_ID,         // PID
+  .bcdDevice          = USB_DEVICE_VERSION,     // device version
+  .iManufacturer      = 1,                      // index of Manufacturer String Descr
+  .iProduct           = 2,                      // index of Product String Descriptor
+  .iSerialNumber      = 3,                      // index of Serial Number String Descr
+  .bNumConfigurations = 1                       // number of possible configurations
+};
+
+// ===================================================================================
+// Configuration Descriptor
+// ===================================================================================
+__code USB_CFG_DESCR_COMP CfgDescr = {
+
+  // Configuration Descriptor
+  .config = {
+    .bLength            = sizeof(USB_CFG_DESCR),  // size of the descriptor in bytes
+    .bDescriptorType    = USB_DESCR_TYP_CONFIG,   // configuration descriptor: 0x02
+    .wTotalLength       = sizeof(CfgDescr),       // total length in bytes
+    .bNumInterfaces     = 3,                      // number of interfaces: 3
+    .bConfigurationValue= 1,                      // value to select this configuration
+    .iConfiguration     = 0,                      // no configuration string descriptor
+    .bmAttributes       = 0x80,                   // attributes = bus powered, no wakeup
+    .MaxPower           = USB_MAX_POWER_mA / 2    // in 2mA units
+  },
+
+  // Interface Association Descriptor
+  .association = {
+    .bLength            = sizeof(USB_IAD_DESCR),  // size of the descriptor in bytes
+    .bDescriptorType    = USB_DESCR_TYP_IAD,      // interf association descr: 0x0B
+    .bFirstInterface    = 0,                      // first interface
+    .bInterfaceCount    = 2,                      // interfaces of the CDC function
+    .bFunctionClass     = USB_DEV_CLASS_COMM,     // function class: CDC (0x02)
+    .bFunctionSubClass  = 2,                      // 2: Abstract Control Model (ACM)
+    .bFunctionProtocol  = 1,                      // 1: AT command protocol
+    .iFunction          = 4                       // index of String Descriptor
+  },
+
+  // Interface Descriptor: Interface 0 (CDC)
+  .interface0 = {
+    .bLength            = sizeof(USB_ITF_DESCR),  // size of the descriptor in bytes: 9
+    .bDescriptorType    = USB_DESCR_TYP_INTERF,   // interface descriptor: 0x04
+    .bInterfaceNumber   = 0,                      // number of this interface: 0
+    .bAlternateSetting  = 0,                      // value used to select alternative setting
+    .bNumEndpoints      = 1,                      // number of endpoints used: 1
+    .bInterfaceClass    = USB_DEV_CLASS_COMM,     // interface class: CDC (0x02)
+    .bInterfaceSubClass = 2,                      // 2: Abstract Control Model (ACM)
+    .bInterfaceProtocol = 1,                      // 1: AT command protocol
+    .iInterface         = 4                       // index of String Descriptor
+  },
+
+  // Functional Descriptors for Interface 0
+  .functional = {
+    0x05,0x24,0x00,0x10,0x01,                     // header functional descriptor
+    0x05,0x24,0x01,0x00,0x00,                     // call management functional descriptor
+    0x04,0x24,0x02,0x02,                          // direct line management functional descriptor
+    0x05,0x24,0x06,0x00,0x01                      // union functional descriptor: CDC IF0, Data IF1
+  },
+
+  // Endpoint Descriptor: Endpoint 1 (CDC Upload, Interrupt)
+  .ep1IN = {
+    .bLength            = sizeof(USB_ENDP_DESCR), // size of the descriptor in bytes: 7
+    .bDescriptorType    = USB_DESCR_TYP_ENDP,     // endpoint descriptor: 0x05
+    .bEndpointAddress   = USB_ENDP_ADDR_EP1_IN,   // endpoint: 1, direction: IN (0x81)
+    .bmAttributes       = USB_ENDP_TYPE_INTER,    // transfer type: interrupt (0x03)
+    .wMaxPacketSize     = EP1_SIZE,               // max packet size
+    .bInterval          = 1                       // polling intervall in ms
+  },
+
+  // Interface Descriptor: Interface 1 (Data)
+  .interface1 = {
+    .bLength            = sizeof(USB_ITF_DESCR),  // size of the descriptor in bytes: 9
+    .bDescriptorType    = USB_DESCR_TYP_INTERF,   // interface descriptor: 0x04
+    .bInterfaceNumber   = 1,                      // number of this interface: 1
+    .bAlternateSetting  = 0,                      // value used to select alternative setting
+    .bNumEndpoints      = 2,                      // number of endpoints used: 2
+    .bInterfaceClass    = USB_DEV_CLASS_DATA,     // interface class: data (0x0a)
+    .bInterfaceSubClass = 0,                      // interface sub class
+    .bInterfaceProtocol = 0,                      // interface protocol
+    .iInterface         = 4                       // index of String Descriptor
+  },
+
+  // Endpoint Descriptor: Endpoint 2 (OUT)
+  .ep2OUT = {
+    .bLength            = sizeof(USB_ENDP_DESCR), // size of the descriptor in bytes: 7
+    .bDescriptorType    = USB_DESCR_TYP_ENDP,     // endpoint descriptor: 0x05
+    .bEndpointAddress   = USB_ENDP_ADDR_EP2_OUT,  // endpoint: 2, direction: OUT (0x02)
+    .bmAttributes       = USB_ENDP_TYPE_BULK,     // transfer type: bulk (0x02)
+    .wMaxPacketSize     = EP2_SIZE,               // max packet size
+    .bInterval          = 0                       // polling intervall (ignored for bulk)
+  },
+
+  // Endpoint Descriptor: Endpoint 2 (IN)
+  .ep2IN = {
+    .bLength            = sizeof(USB_ENDP_DESCR), // size of the descriptor in bytes: 7
+    .bDescriptorType    = USB_DESCR_TYP_ENDP,     // endpoint descriptor: 0x05
+    .bEndpointAddress   = USB_ENDP_ADDR_EP2_IN,   // endpoint: 2, direction: IN (0x82)
+    .bmAttributes       = USB_ENDP_TYPE_BULK,     // transfer type: bulk (0x02)
+    .wMaxPacketSize     = EP2_SIZE,               // max packet size
+    .bInterval          = 0                       // polling intervall (ignored for bulk)
+  },
+
+  // Interface Descriptor: Interface 2 (Vendor, pixel data)
+  .interface2 = {
+    .bLength            = sizeof(USB_ITF_DESCR),  // size of the descriptor in bytes: 9
+    .bDescriptorType    = USB_DESCR_TYP_INTERF,   // interface descriptor: 0x04
+    .bInterfaceNumber   = 2,                      // number of this interface: 2
+    .bAlternateSetting  = 0,                      // value used to select alternative setting
+    .bNumEndpoints      = 1,                      // number of endpoints used: 1
+    .bInterfaceClass    = USB_DEV_CLASS_VENDOR,   // vendor specific class: 0xFF
+    .bInterfaceSubClass = 0,                      // no subclass
+    .bInterfaceProtocol = 0,                      // no protocoll
+    .iInterface         = 5                       // index of String Descriptor
+  },
+
+  // Endpoint Descriptor: Endpoint 3 (OUT, Bulk)
+  .ep3OUT = {
+    .bLength            = sizeof(USB_ENDP_DESCR), // size of the descriptor in bytes: 7
+    .bDescriptorType    = USB_DESCR_TYP_ENDP,     // endpoint descriptor: 0x05
+    .bEndpointAddress   = USB_ENDP_ADDR_EP3_OUT,  // endpoint: 3, direction: OUT (0x03)
+    .bmAttributes       = USB_ENDP_TYPE_BULK,     // transfer type: bulk (0x02)
+    .wMaxPacketSize     = EP3_SIZE,               // max packet size
+    .bInterval          = 0                       // polling intervall (ignored for bulk)
+  }
+};
+
+// ===================================================================================
+// String Descriptors
+// ===================================================================================
+
+// String descriptor length (GCC does not allow sizeof() of an array inside its own
+// initializer, therefore the host simulation sets the length on startup)
+#ifdef SIMULATOR
+  #define USB_STR_LEN(descr)  0
+#else
+  #define USB_STR_LEN(descr)  sizeof(descr)
+#endif
+
+// Language Descriptor (Index 0)
+__code uint16_t LangDescr[] = {
+  ((uint16_t)USB_DESCR_TYP_STRING << 8) | USB_STR_LEN(LangDescr), 0x0409 };  // US English
+
+// Manufacturer String Descriptor (Index 1)
+__code uint16_t ManufDescr[] = {
+  ((uint16_t)USB_DESCR_TYP_STRING << 8) | USB_STR_LEN(ManufDescr), MANUFACTURER_STR };
+
+// Product String Descriptor (Index 2)
+__code uint16_t ProdDescr[] = {
+  ((uint16_t)USB_DESCR_TYP_STRING << 8) | USB_STR_LEN(ProdDescr), PRODUCT_STR };
+
+// Serial String Descriptor (Index 3)
+__code uint16_t SerDescr[] = {
+  ((uint16_t)USB_DESCR_TYP_STRING << 8) | USB_STR_LEN(SerDescr), SERIAL_STR };
+
+// Interface String Descriptor (Index 4)
+__code uint16_t InterfDescr[] = {
+  ((uint16_t)USB_DESCR_TYP_STRING << 8) | USB_STR_LEN(InterfDescr), INTERFACE_STR };
+
+// Vendor Interface String Descriptor (Index 5)
+__code uint16_t VendorDescr[] = {
+  ((uint16_t)USB_DESCR_TYP_STRING << 8) | USB_STR_LEN(VendorDescr), VENDOR_STR };
+
+// ===================================================================================
+// Windows Compatible ID (WCID) descriptors for automated driver installation
+// ===================================================================================
+
+#ifdef WCID_VENDOR_CODE
+// Microsoft WCID feature descriptor (index 0x0004), WinUSB for the vendor interface
+// (the CDC function gets the usbser driver of Windows by its class)
+__code uint8_t WCID_FEATURE_DESCR[] = {
+    0x28, 0x00, 0x00, 0x00,                         // length = 40 bytes
+    0x00, 0x01,                                     // version 1.0 (in BCD)
+    0x04, 0x00,                                     // compatibility descriptor index 0x0004
+    0x01,                                           // number of sections
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,       // reserved (7 bytes)
+    0x02,                                           // interface number 2
+    0x01,                                           // reserved
+    'W', 'I', 'N', 'U', 'S', 'B', 0x00, 0x00,       // compatibility ID: WinUSB
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // subcompatibility ID (unused)
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00              // reserved 6 bytes
+};
+
+// Microsoft OS string descriptor for WCID driver (index 0xEE)
+__code uint16_t MicrosoftDescr[] = {
+  ((uint16_t)USB_DESCR_TYP_STRING << 8) | USB_STR_LEN(MicrosoftDescr),
+  'M','S','F','T','1','0','0', WCID_VENDOR_CODE};
+#endif
+
+#ifdef SIMULATOR
+__attribute__((constructor)) static void USB_STR_init(void) {
+  LangDescr[0]      |= sizeof(LangDescr);
+  ManufDescr[0]     |= sizeof(ManufDescr);
+  ProdDescr[0]      |= sizeof(ProdDescr);
+  SerDescr[0]       |= sizeof(SerDescr);
+  InterfDescr[0]    |= sizeof(InterfDescr);
+  VendorDescr[0]    |= sizeof(VendorDescr);
+  #ifdef WCID_VENDOR_CODE
+  MicrosoftDescr[0] |= sizeof(MicrosoftDescr);
+  #endif
+}
+#endif
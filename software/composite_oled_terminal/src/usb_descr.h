@@ -0,0 +1,95 @@
+// ===================================================================================
+// USB Descriptors and Definitions
+// ===================================================================================
+//
+// Definition of USB descriptors and endpoint sizes and addresses. Composite device
+// with two functions: CDC terminal (interfaces 0 and 1, EP1 and EP2) and vendor
+// bulk interface for pixel data (interface 2, EP3 OUT, WinUSB via WCID).
+//
+// The following must be defined in config.h:
+// USB_VENDOR_ID            - Vendor ID (16-bit word)
+// USB_PRODUCT_ID           - Product ID (16-bit word)
+// USB_DEVICE_VERSION       - Device version (16-bit BCD)
+// USB_MAX_POWER_mA         - Device max power in mA
+// All string descriptors.
+//
+// In the makefile the following microcontroller settings must be made:
+// XRAM_LOC   = 0x0110  (266 bytes of endpoint buffers)
+// XRAM_SIZE  = 0x02F0
+
+#pragma once
+#include <stdint.h>
+#include "usb.h"
+#include "config.h"
+
+// ===================================================================================
+// USB Endpoint Definitions
+// ===================================================================================
+#define EP0_SIZE        64
+#define EP1_SIZE        8
+#define EP2_SIZE        64
+#define EP3_SIZE        64
+
+#define EP0_BUF_SIZE    EP_BUF_SIZE(EP0_SIZE)
+#define EP1_BUF_SIZE    EP_BUF_SIZE(EP1_SIZE)
+#define EP2_BUF_SIZE    EP_BUF_SIZE(EP2_SIZE) + 64
+#define EP3_BUF_SIZE    EP_BUF_SIZE(EP3_SIZE)
+#define EP_BUF_SIZE(x)  (x+2<64 ? x+2 : 64)
+
+#define EP0_ADDR        0
+#define EP1_ADDR        (EP0_ADDR + EP0_BUF_SIZE)
+#define EP2_ADDR        (EP1_ADDR + EP1_BUF_SIZE)
+#define EP3_ADDR        (EP2_ADDR + EP2_BUF_SIZE)
+
+__xdata __at (EP0_ADDR) uint8_t EP0_buffer[EP0_BUF_SIZE];     
+__xdata __at (EP1_ADDR) uint8_t EP1_buffer[EP1_BUF_SIZE];
+__xdata __at (EP2_ADDR) uint8_t EP2_buffer[EP2_BUF_SIZE];
+__xdata __at (EP3_ADDR) uint8_t EP3_buffer[EP3_BUF_SIZE];
+
+// ===================================================================================
+// Device and Configuration Descriptors
+// ===================================================================================
+typedef struct _USB_CFG_DESCR_COMP {
+  USB_CFG_DESCR config;
+  USB_IAD_DESCR association;
+  USB_ITF_DESCR interface0;
+  uint8_t functional[19];
+  USB_ENDP_DESCR ep1IN;
+  USB_ITF_DESCR interface1;
+  USB_ENDP_DESCR ep2OUT;
+  USB_ENDP_DESCR ep2IN;
+  USB_ITF_DESCR interface2;
+  USB_ENDP_DESCR ep3OUT;
+} USB_CFG_DESCR_COMP, *PUSB_CFG_DESCR_COMP;
+typedef USB_CFG_DESCR_COMP __xdata *PXUSB_CFG_DESCR_COMP;
+
+extern __code USB_DEV_DESCR DevDescr;
+extern __code USB_CFG_DESCR_COMP CfgDescr;
+
+// ===================================================================================
+// String Descriptors
+// ===================================================================================
+extern __code uint16_t LangDescr[];
+extern __code uint16_t ManufDescr[];
+extern __code uint16_t ProdDescr[];
+extern __code uint16_t SerDescr[];
+extern __code uint16_t InterfDescr[];
+extern __code uint16_t VendorDescr[];
+
+#define USB_STR_DESCR_i0    (uint8_t*)LangDescr
+#define USB_STR_DESCR_i1    (uint8_t*)ManufDescr
+#define USB_STR_DESCR_i2    (uint8_t*)ProdDescr
+#define USB_STR_DESCR_i3    (uint8_t*)SerDescr
+#define USB_STR_DESCR_i4    (uint8_t*)InterfDescr
+#define USB_STR_DESCR_i5    (uint8_t*)VendorDescr
+#define USB_STR_DESCR_ix    (uint8_t*)SerDescr
+
+// ===================================================================================
+// Windows Compatible ID (WCID) descriptors for automated driver installation
+// ===================================================================================
+
+#ifdef WCID_VENDOR_CODE
+extern __code uint8_t WCID_FEATURE_DESCR[];
+extern __code uint16_t MicrosoftDescr[];
+#define USB_STR_DESCR_ixee  (uint8_t*)MicrosoftDescr
+#endif
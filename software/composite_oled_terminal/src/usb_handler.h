@@ -0,0 +1,64 @@
+// ===================================================================================
+// USB Handler for CH551, CH552 and CH554                                     * v1.5 *
+// ===================================================================================
+
+#pragma once
+#include <stdint.h>
+#include "ch554.h"
+#include "usb_descr.h"
+
+// ===================================================================================
+// Variables
+// ===================================================================================
+#define USB_SetupBuf     ((PUSB_SETUP_REQ)EP0_buffer)
+extern volatile uint8_t  USB_SetupReq, USB_SetupTyp;
+extern volatile uint16_t USB_SetupLen;
+extern volatile __bit    USB_ENUM_OK;
+extern __code uint8_t*   USB_pDescr;
+extern __xdata uint8_t*  USB_pData;
+
+// ===================================================================================
+// Custom External USB Handler Functions
+// ===================================================================================
+uint8_t CDC_control(void);
+void CDC_EP_init(void);
+void CDC_EP0_IN(void);
+void CDC_EP0_OUT(void);
+void CDC_EP2_IN(void);
+void CDC_EP2_OUT(void);
+uint8_t VEN_control(void);
+void VEN_setup(void);
+void VEN_EP0_IN(void);
+void VEN_EP0_OUT(void);
+void VEN_EP3_OUT(void);
+void POWER_suspend(void);
+
+// ===================================================================================
+// USB Handler Defines
+// ===================================================================================
+// Custom USB handler functions
+#define USB_INIT_endpoints        VEN_setup       // init CDC and vendor endpoints
+#define USB_CLASS_SETUP_handler   CDC_control     // handle class setup requests
+#define USB_CLASS_OUT_handler     CDC_EP0_OUT     // handle class out transfers
+#define USB_CLASS_IN_handler      CDC_EP0_IN      // handle class in transfers
+#define USB_VENDOR_SETUP_handler  VEN_control     // handle vendor setup requests
+#define USB_VENDOR_IN_handler     VEN_EP0_IN      // handle vendor in transfers
+#define USB_VENDOR_OUT_handler    VEN_EP0_OUT     // handle vendor out transfers
+#define USB_SUSPEND_handler       POWER_suspend   // OLED off, power-down
+
+// Endpoint callback functions
+#define EP0_SETUP_callback        USB_EP0_SETUP
+#define EP0_IN_callback           USB_EP0_IN
+#define EP0_OUT_callback          USB_EP0_OUT
+#define EP2_IN_callback           CDC_EP2_IN
+#define EP2_OUT_callback          CDC_EP2_OUT
+#define EP3_OUT_callback          VEN_EP3_OUT
+
+// ===================================================================================
+// Functions
+// ===================================================================================
+void USB_init(void);
+void USB_interrupt(void);
+void USB_EP0_copyDescr(uint8_t len);
+uint8_t USB_EP0_copyData(void);
+uint8_t USB_EP0_storeData(void);
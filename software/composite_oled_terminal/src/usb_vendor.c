@@ -0,0 +1,189 @@
+// ===================================================================================
+// USB VENDOR-Specific Control and Data Transfer Functions for CH551, CH552 and CH554
+// ===================================================================================
+
+#include "usb_vendor.h"
+#include "perf.h"
+#include "tick.h"
+#include "devcfg.h"
+
+// ===================================================================================
+// Variables and Defines
+// ===================================================================================
+
+volatile __xdata uint8_t VEN_EP3_readByteCount = 0; // number of data bytes in IN buffer
+volatile __xdata uint8_t VEN_EP3_readPointer   = 0; // data pointer for fetching
+
+volatile __bit VEN_BOOT_flag    = 0;                // bootloader flag
+volatile __bit VEN_I2C_flag     = 0;                // I2C active flag
+volatile __bit VEN_BUZZER_flag  = 0;                // buzzer state flag
+
+// ===================================================================================
+// Bulk Data Transfer Functions
+// ===================================================================================
+
+// Read single byte from IN buffer
+uint8_t VEN_read(void) {
+  uint8_t b;
+  while(!VEN_available());                                  // wait for data
+  b = EP3_buffer[VEN_EP3_readPointer++];                    // get data byte
+  if(--VEN_EP3_readByteCount == 0) {                        // dec number of bytes in buffer
+    UEP3_CTRL = UEP3_CTRL & ~MASK_UEP_R_RES | UEP_R_RES_ACK;// request new data if empty
+    PERF_nakStop();                                         // end of endpoint stall
+    TICK_drained();
+  }
+  return b;
+}
+
+// ===================================================================================
+// Vendor-Specific Setup and Reset Functions
+// ===================================================================================
+
+// Setup endpoints of both functions: CDC (EP1, EP2) and vendor (EP3)
+void VEN_setup(void) {
+  CDC_EP_init();                            // CDC endpoints (sets UEP2_3_MOD)
+  UEP3_DMA    = EP3_ADDR;                   // EP3 data transfer address
+  UEP3_CTRL   = bUEP_AUTO_TOG               // EP3 Auto flip sync flag
+              | UEP_T_RES_NAK               // EP3 IN transaction returns NAK
+              | UEP_R_RES_ACK;              // EP3 OUT transaction returns ACK
+  UEP2_3_MOD |= bUEP3_RX_EN;                // EP3 receive only
+  VEN_EP3_readByteCount = 0;                // reset received bytes counter
+}
+
+// ===================================================================================
+// Vendor-Specific USB Control Transfers
+// ===================================================================================
+
+// Vendor-Specific USB SETUP Requests
+uint8_t VEN_control(void) {
+  uint8_t len;
+
+  switch(USB_SetupReq) {
+
+    case VEN_REQ_BOOTLOADER:                // enter bootloader
+      VEN_BOOT_flag = 1;
+      return 0;
+
+    case VEN_REQ_BUZZER_ON:                 // turn on buzzer
+      VEN_BUZZER_flag = 1;
+      return 0;
+
+    case VEN_REQ_BUZZER_OFF:                // turn off buzzer
+      VEN_BUZZER_flag = 0;
+      return 0;
+
+    case VEN_REQ_I2C_START:                 // set start condition on I2C bus
+      VEN_I2C_flag = 1;
+      return 0;
+
+    case VEN_REQ_I2C_STOP:                  // set stop condition on I2C bus
+      VEN_I2C_flag = 0;
+      return 0;
+
+    #ifdef PERF_COUNTERS
+    case VEN_REQ_GET_PERF:                  // read performance counters
+      return PERF_copy();
+    #endif
+
+    #ifdef TICK_TIMESTAMPS
+    case VEN_REQ_GET_TRACE:                 // read transaction timestamps
+      return TICK_copy();
+    #endif
+
+    case VEN_REQ_GET_CONFIG:                // read device configuration
+      return CFG_copy();
+
+    case VEN_REQ_SET_CONFIG:                // write device configuration (OUT)
+      return CFG_receive();
+
+    case VEN_REQ_GET_FEATURES:              // read device feature bits
+      return CFG_copyFeatures();
+
+    #ifdef WCID_VENDOR_CODE
+    case WCID_VENDOR_CODE:
+      if(USB_SetupBuf->wIndexL == 0x04) {
+        USB_pDescr = WCID_FEATURE_DESCR;
+        len = WCID_FEATURE_DESCR[0];
+        if(USB_SetupLen > len) USB_SetupLen = len;
+        len = USB_SetupLen >= EP0_SIZE ? EP0_SIZE : USB_SetupLen;
+        USB_EP0_copyDescr(len);
+        return len;
+      }
+      return 0;
+    #endif
+
+    default:
+      return 0xff;
+  }
+}
+
+// Endpoint 0 Vendor-Specific USB IN Transfers
+void VEN_EP0_IN(void) {
+  uint8_t len;
+  len = USB_SetupLen >= EP0_SIZE ? EP0_SIZE : USB_SetupLen;
+
+  switch(USB_SetupReq) {
+
+    #ifdef WCID_VENDOR_CODE
+    case WCID_VENDOR_CODE:
+      USB_EP0_copyDescr(len);                             
+      break;
+    #endif
+
+    #ifdef PERF_COUNTERS
+    case VEN_REQ_GET_PERF:
+    #endif
+    #ifdef TICK_TIMESTAMPS
+    case VEN_REQ_GET_TRACE:
+    #endif
+    case VEN_REQ_GET_CONFIG:
+    case VEN_REQ_GET_FEATURES:
+      len = USB_EP0_copyData();
+      break;
+
+    default:
+      UEP0_CTRL = bUEP_R_TOG | UEP_T_RES_NAK | UEP_R_RES_ACK;
+      return;
+  }
+
+  USB_SetupLen -= len;
+  UEP0_T_LEN    = len;
+  UEP0_CTRL    ^= bUEP_T_TOG;
+}
+
+// Endpoint 0 Vendor-Specific USB OUT Transfers
+void VEN_EP0_OUT(void) {
+  if(USB_SetupReq == VEN_REQ_SET_CONFIG) {
+    if(USB_EP0_storeData()) {               // more packets to come?
+      UEP0_CTRL ^= bUEP_R_TOG;
+      return;
+    }
+    if(CFG_received() == 0xff) {            // invalid record: stall status stage
+      UEP0_CTRL = bUEP_R_TOG | bUEP_T_TOG | UEP_R_RES_STALL | UEP_T_RES_STALL;
+      return;
+    }
+  }
+  UEP0_CTRL = bUEP_T_TOG | UEP_T_RES_ACK | UEP_R_RES_ACK;
+}
+
+// ===================================================================================
+// Vendor-Specific BULK Transfers
+// ===================================================================================
+
+// Endpoint 3 OUT handler (bulk data transfer from host)
+// Data outside an I2C transaction (late packets of a stream aborted by the timeout
+// of the main loop) is discarded, its first byte would be taken as slave address.
+void VEN_EP3_OUT(void) {
+  if(U_TOG_OK) {                            // discard unsynchronized packets
+    if(!VEN_I2C_flag) return;               // no transaction open: discard data
+    VEN_EP3_readByteCount = USB_RX_LEN;     // set number of received data bytes
+    VEN_EP3_readPointer = 0;                // reset read pointer for fetching
+    if(VEN_EP3_readByteCount) {
+      UEP3_CTRL = (UEP3_CTRL & ~MASK_UEP_R_RES) | UEP_R_RES_NAK; // respond NAK after a packet. Let main code change response after handling.
+      PERF_add(bytes, VEN_EP3_readByteCount);
+      PERF_inc(naks);
+      PERF_nakStart();
+      TICK_packet(VEN_EP3_readByteCount);
+    }
+  }
+}
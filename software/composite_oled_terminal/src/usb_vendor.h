@@ -0,0 +1,37 @@
+// ===================================================================================
+// USB VENDOR-Specific Control and Data Transfer Functions for CH551, CH552 and CH554
+// ===================================================================================
+//
+// Vendor interface of the composite device: bulk OUT endpoint 3 for the I2C stream
+// of the host (pixel data) and the vendor control requests of the vendor bridge
+// that concern the I2C stream, the buzzer, the bootloader and the diagnostics.
+
+#pragma once
+#include <stdint.h>
+#include "ch554.h"
+#include "usb.h"
+#include "usb_descr.h"
+#include "usb_handler.h"
+
+// Vendor class control requests (numbers of the vendor bridge)
+#define VEN_REQ_BOOTLOADER  1                       // enter bootloader
+#define VEN_REQ_BUZZER_ON   2                       // turn on buzzer
+#define VEN_REQ_BUZZER_OFF  3                       // turn off buzzer
+#define VEN_REQ_I2C_START   4                       // set start condition on I2C bus
+#define VEN_REQ_I2C_STOP    5                       // set stop condition on I2C bus
+#define VEN_REQ_GET_PERF    6                       // read performance counters (IN)
+#define VEN_REQ_GET_TRACE   7                       // read transaction timestamps (IN)
+#define VEN_REQ_GET_CONFIG  8                       // read device configuration (IN)
+#define VEN_REQ_SET_CONFIG  9                       // write device configuration (OUT)
+#define VEN_REQ_GET_FEATURES 16                     // read device feature bits (IN)
+
+// Bulk data transfer functions
+#define VEN_available()   (VEN_EP3_readByteCount)   // number of received bytes
+uint8_t VEN_read(void);                             // read byte from BULK IN buffer
+
+// Variables
+extern volatile __bit VEN_BOOT_flag;                // bootloader flag
+extern volatile __bit VEN_I2C_flag;                 // I2C active flag
+extern volatile __bit VEN_BUZZER_flag;              // buzzer state flag
+
+extern volatile __xdata uint8_t VEN_EP3_readByteCount;
@@ -12,6 +12,8 @@
 # ------------
 # This simple demo shows the basic functionality of the USB HID to I2C bridge. An
 # image is shown on the OLED and then scrolled.
+# The reports start with report ID 1, which needs the firmware compiled from the
+# current sources (not the precompiled hid_i2c_bridge.bin of the first release).
 #
 # Dependencies:
 # -------------
@@ -29,6 +31,7 @@ PRODUCT_ID  = 0x05DF    # PID
 PACKET_SIZE = 64        # HID packet size
 INTERFACE   = 0         # HID interface number
 HID_EP_OUT  = 1         # endpoint for data transfer
+REPORT_ID   = 1         # report ID of the data (output report)
 
 
 # ===================================================================================
@@ -82,12 +85,12 @@ class Bridge():
 
     def senddata(self, data):
         while len(data) > 0:
-            self.dev.write(HID_EP_OUT, [OLED_ADDR, OLED_DAT_MODE] + data[:(PACKET_SIZE-2)])
-            data = data[(PACKET_SIZE-2):]
+            self.dev.write(HID_EP_OUT, [REPORT_ID, OLED_ADDR, OLED_DAT_MODE] + data[:(PACKET_SIZE-3)])
+            data = data[(PACKET_SIZE-3):]
 
     def sendcommand(self, cmd):
-        if len(cmd) <= PACKET_SIZE-2:
-            self.dev.write(HID_EP_OUT, [OLED_ADDR, OLED_CMD_MODE] + cmd)
+        if len(cmd) <= PACKET_SIZE-3:
+            self.dev.write(HID_EP_OUT, [REPORT_ID, OLED_ADDR, OLED_CMD_MODE] + cmd)
         else:
             raise Exception('Command string too long')
 
@@ -120,7 +123,7 @@ OLED_INIT_CMD = [
 ]
 
 # ===================================================================================
-# OLED Picture (Bitmap Converter: http://www.majer.ch/lcd/adf_bitmap.php)
+# OLED Picture (Bitmap Converter: host_library/oled-convert.py -n PIC1 picture.png)
 # ===================================================================================
 
 PIC1 = [
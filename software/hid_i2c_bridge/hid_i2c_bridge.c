@@ -12,7 +12,9 @@
 // ------------
 // This code implements a simple USB HID to I2C bridge. Data coming in via USB will be
 // directly send via I2C to the slave device. Each HID packet must begin with the
-// I2C address of the slave device.
+// I2C address of the slave device. Queries and settings (performance counters,
+// timestamps, device configuration, buzzer, I2C clock, OLED contrast) use feature
+// reports on EP0, so the interrupt pipe stays dedicated to the pixel data.
 //
 // References:
 // -----------
@@ -35,7 +37,7 @@
 // Compilation Instructions:
 // -------------------------
 // - Chip:  CH551, CH552 or CH554
-// - Clock: 16 MHz internal
+// - Clock: 16 MHz internal (or 24 MHz with 5V supply: 'make flash FREQ_SYS=24000000')
 // - Adjust the firmware parameters in src/config.h if necessary.
 // - Make sure SDCC toolchain and Python3 with PyUSB is installed.
 // - Press BOOT button on the board and keep it pressed while connecting it via USB
@@ -56,9 +58,17 @@
 
 // Libraries
 #include "src/system.h"                   // system functions
+#include "src/gpio.h"                     // for GPIO (buzzer)
 #include "src/delay.h"                    // for delays
 #include "src/i2c.h"                      // for I²C
 #include "src/usb_hid_data.h"             // for USB HID data
+#include "src/perf.h"                     // for performance counters
+#include "src/tick.h"                     // for millisecond tick and timestamps
+#include "src/devcfg.h"                   // for persistent device configuration
+#include "src/frames.h"                   // for frame store (splash, suspend)
+#include "src/tiles.h"                    // for tile table (tile based drawing)
+#include "src/task.h"                     // for cooperative tasks and timeouts
+#include "src/power.h"                    // for USB suspend and power-down
 
 // Prototypes for used interrupts
 void USB_interrupt(void);
@@ -66,27 +76,85 @@ void USB_ISR(void) __interrupt(INT_NO_USB) {
   USB_interrupt();
 }
 
+void TMR2_ISR(void) __interrupt(INT_NO_TMR2) {
+  TICK_interrupt();
+}
+
+// ===================================================================================
+// Tasks of the Main Loop
+// ===================================================================================
+
+// Task numbers (performance counter taskId)
+#define TASK_CONFIG     0
+#define TASK_STREAM     1
+#define TASK_FRAME      2
+#define TASK_TILE       3
+#define TASK_POWER      4
+#define TASK_CONTROL    5
+
+// Pass a received data packet to the I2C bus (one complete transaction)
+void streamTask(void) {
+  uint8_t len = HID_available();          // get number of bytes in packet
+  if(!len) return;                        // no data packet received
+  I2C_start();                            // start I2C transmission
+  while(len--) I2C_write(HID_read());     // pass all bytes in packet to I2C
+  I2C_stop();                             // stop I2C transmission
+}
+
+__xdata uint8_t contrast = 0x7F;          // OLED contrast (SSD1306 reset value)
+
+// Apply the controls of the feature report: buzzer, I2C clock and OLED contrast
+// (the contrast command is only sent if the value has changed)
+void controlTask(void) {
+  if(!HID_CONTROL_flag) return;           // new controls received?
+  HID_controls = HID_controlBuffer;
+  if(HID_controls.buzzer) PWM_start(PIN_BUZZER);
+  else {
+    PWM_stop(PIN_BUZZER);
+    PIN_high(PIN_BUZZER);
+  }
+  I2C_slow = HID_controls.speed == CFG_SPEED_SLOW;
+  if(HID_controls.contrast != contrast) {
+    contrast = HID_controls.contrast;
+    I2C_start();                          // set contrast of the OLED
+    I2C_write(CFG_record.addr);
+    I2C_write(0x00);                      // command mode
+    I2C_write(0x81);                      // contrast command
+    I2C_write(contrast);
+    I2C_stop();
+  }
+  HID_CONTROL_flag = 0;                   // ready for the next record
+}
+
 // ===================================================================================
 // Main Function
 // ===================================================================================
 
 void main(void) {
-  // Variables
-  uint8_t len;
-
   // Setup
   CLK_config();                           // configure system clock
   DLY_ms(5);                              // wait for clock to stabilize
-  HID_init();                             // init USB HID
+  PERF_init();                            // init performance counters
+  TICK_init();                            // start millisecond tick
+  CFG_init();                             // load device configuration
   I2C_init();                             // init I2C
+  CFG_initOLED();                         // init OLED according to power-up mode
+  HID_init();                             // init USB HID
+  PWM_set_freq(2000);                     // set buzzer tone frequency
+  PWM_write(PIN_BUZZER, 127);             // set buzzer duty cycle 50%
+  #ifdef WATCHDOG
+  WDT_start();                            // start watchdog timer
+  #endif
 
   // Loop
   while(1) {
-    if(HID_available()) {                 // received data packet?
-      len = HID_available();              // get number of bytes in packet
-      I2C_start();                        // start I2C transmission
-      while(len--) I2C_write(HID_read()); // pass all bytes in packet to I2C
-      I2C_stop();                         // stop I2C transmission
-    }
+    WDT_reset();                          // feed watchdog
+    PERF_loop();                          // measure main loop latency
+    TASK_run(TASK_CONFIG, CFG_update);    // store received device configuration
+    TASK_run(TASK_STREAM, streamTask);    // pass HID data to I2C
+    TASK_run(TASK_FRAME,  FRAME_update);  // store frame chunk, show frame
+    TASK_run(TASK_TILE,   TILE_update);   // store tiles, draw tile run
+    TASK_run(TASK_POWER,  POWER_update);  // OLED off and power-down on suspend
+    TASK_run(TASK_CONTROL, controlTask);  // buzzer, I2C clock, contrast
   }
 }
@@ -22,3 +22,26 @@
 #define PRODUCT_STR         'I','2','C','-','B','r','i','d','g','e'
 #define SERIAL_STR          'C','H','5','5','x','H','I','D'
 #define INTERFACE_STR       'H','I','D',' ','D','a','t','a'
+
+// Performance counters (bytes, I2C transactions, USB packets, NAK time, main loop
+// latency, longest task), readable via USB. Comment out this define to remove them.
+#define PERF_COUNTERS
+
+// Timestamps of the last I2C transaction for latency tracing, readable via USB.
+// Comment out this define to remove them (the millisecond tick of timer2 stays, the
+// tasks of the main loop use it for timeouts).
+#define TICK_TIMESTAMPS
+
+// The watchdog resets the device if the main loop stalls for about one second (the
+// OLED is then initialized again according to the power-up mode of the device
+// configuration). Comment out this define to disable the watchdog.
+#define WATCHDOG
+
+// Default device configuration, used as long as no configuration has been written
+// to the DataFlash via USB (see src/devcfg.h). Power-up mode: CFG_MODE_INIT sends
+// the init sequence to the OLED, CFG_MODE_CLEAR clears its display RAM (0: the host
+// initializes the OLED, as before).
+#define CFG_DEFAULT_ADDR    0x78      // OLED write address (0x3C << 1)
+#define CFG_DEFAULT_MODE    0         // power-up mode (CFG_MODE_INIT | CFG_MODE_CLEAR)
+#define CFG_DEFAULT_SPLASH  CFG_SPLASH_NONE
+#define CFG_DEFAULT_INIT    0xA8,0x3F, 0x8D,0x14, 0x20,0x00, 0xC8,0xA1, 0xDA,0x12, 0xAF
@@ -0,0 +1,119 @@
+// ===================================================================================
+// Persistent Device Configuration for CH551, CH552 and CH554                 * v1.0 *
+// ===================================================================================
+
+#include "devcfg.h"
+#include "i2c.h"
+#include "frames.h"
+#include "usb_handler.h"
+
+// ===================================================================================
+// Variables
+// ===================================================================================
+__xdata CFG_RECORD_TYPE CFG_record;                // active configuration
+__xdata CFG_RECORD_TYPE CFG_buffer;                // record received via USB
+volatile __bit CFG_pending = 0;                    // received record not yet stored
+__xdata uint8_t CFG_features;                      // feature bits for USB requests
+
+__code uint8_t CFG_DEFAULT_SEQ[] = {CFG_DEFAULT_INIT};
+
+// ===================================================================================
+// Record Functions
+// ===================================================================================
+
+// Sum of all bytes of a record (0 for a valid record)
+uint8_t CFG_sum(__xdata uint8_t* rec) {
+  uint8_t i;
+  uint8_t sum = 0;
+  for(i=0; i<sizeof(CFG_RECORD_TYPE); i++) sum += rec[i];
+  return sum;
+}
+
+// Check if record is valid
+__bit CFG_valid(__xdata CFG_RECORD_TYPE* rec) {
+  return (rec->magic == CFG_MAGIC) && (rec->length <= CFG_INIT_SIZE)
+      && !CFG_sum((__xdata uint8_t*)rec);
+}
+
+// Load record from DataFlash, use defaults if invalid
+void CFG_init(void) {
+  uint8_t i;
+  for(i=0; i<sizeof(CFG_record); i++)
+    ((__xdata uint8_t*)&CFG_record)[i] = FLASH_read(i);
+  if(!CFG_valid(&CFG_record)) {
+    for(i=0; i<sizeof(CFG_record); i++) ((__xdata uint8_t*)&CFG_record)[i] = 0;
+    CFG_record.magic  = CFG_MAGIC;
+    CFG_record.addr   = CFG_DEFAULT_ADDR;
+    CFG_record.speed  = CFG_SPEED_FAST;
+    CFG_record.mode   = CFG_DEFAULT_MODE;
+    CFG_record.splash = CFG_DEFAULT_SPLASH;
+    CFG_record.length = sizeof(CFG_DEFAULT_SEQ);
+    for(i=0; i<sizeof(CFG_DEFAULT_SEQ); i++) CFG_record.init[i] = CFG_DEFAULT_SEQ[i];
+    CFG_record.checksum = -CFG_sum((__xdata uint8_t*)&CFG_record);
+  }
+  I2C_slow = CFG_record.speed == CFG_SPEED_SLOW;
+}
+
+// Store received record in DataFlash (main loop)
+void CFG_update(void) {
+  uint8_t i;
+  if(!CFG_pending) return;
+  for(i=0; i<sizeof(CFG_record); i++) {
+    ((__xdata uint8_t*)&CFG_record)[i] = ((__xdata uint8_t*)&CFG_buffer)[i];
+    FLASH_update(i, ((__xdata uint8_t*)&CFG_buffer)[i]);
+  }
+  I2C_slow = CFG_record.speed == CFG_SPEED_SLOW;
+  CFG_pending = 0;
+}
+
+// ===================================================================================
+// USB Request Functions
+// ===================================================================================
+
+// Copy record to EP0 buffer for control IN request, return number of bytes
+// (a received record that is not yet stored is returned as well)
+uint8_t CFG_copy(void) {
+  if(USB_SetupLen > sizeof(CFG_record)) USB_SetupLen = sizeof(CFG_record);
+  USB_pData = CFG_pending ? (__xdata uint8_t*)&CFG_buffer : (__xdata uint8_t*)&CFG_record;
+  return USB_EP0_copyData();
+}
+
+// Copy feature bits to EP0 buffer for control IN request, return number of bytes
+uint8_t CFG_copyFeatures(void) {
+  if(USB_SetupLen > sizeof(CFG_features)) USB_SetupLen = sizeof(CFG_features);
+  CFG_features = CFG_FEATURES;
+  USB_pData = &CFG_features;
+  return USB_EP0_copyData();
+}
+
+// Prepare receiving a record via control OUT request (complete record only)
+uint8_t CFG_receive(void) {
+  if(CFG_pending || USB_SetupLen != sizeof(CFG_buffer)) return 0xff;
+  USB_pData = (__xdata uint8_t*)&CFG_buffer;
+  return 0;
+}
+
+// Record completely received: check and mark for storing
+uint8_t CFG_received(void) {
+  if(!CFG_valid(&CFG_buffer)) return 0xff;
+  CFG_pending = 1;
+  return 0;
+}
+
+// ===================================================================================
+// OLED Power-Up
+// ===================================================================================
+
+// Init OLED with the stored sequence, show splash frame or clear display RAM
+void CFG_initOLED(void) {
+  uint8_t i;
+  if(CFG_record.mode & CFG_MODE_INIT) {
+    I2C_start();
+    I2C_write(CFG_record.addr);                   // OLED write address
+    I2C_write(0x00);                              // command mode
+    for(i=0; i<CFG_record.length; i++) I2C_write(CFG_record.init[i]);
+    I2C_stop();
+  }
+  if(CFG_record.splash == CFG_SPLASH_FRAME) FRAME_show(FRAME_SPLASH);
+  else if(CFG_record.mode & CFG_MODE_CLEAR) FRAME_show(FRAME_BLANK);
+}
@@ -0,0 +1,90 @@
+// ===================================================================================
+// Data Flash Functions for CH551, CH552 and CH554                            * v1.1 *
+// ===================================================================================
+
+#include "flash.h"
+
+// ===================================================================================
+// Read/Write DataFlash (bytes are located at even addresses)
+// ===================================================================================
+
+// Read byte from DataFlash
+uint8_t FLASH_read(uint8_t addr) {
+  #ifdef SIMULATOR
+  return SIM_flashRead(addr);
+  #else
+  ROM_ADDR_H = DATA_FLASH_ADDR >> 8;
+  ROM_ADDR_L = addr << 1;
+  ROM_CTRL   = ROM_CMD_READ;
+  return ROM_DATA_L;
+  #endif
+}
+
+// Write byte to DataFlash, returns 0 on success
+uint8_t FLASH_write(uint8_t addr, uint8_t data) {
+  #ifdef SIMULATOR
+  return SIM_flashWrite(addr, data);
+  #else
+  uint8_t status = 1;
+  SAFE_MOD    = 0x55;
+  SAFE_MOD    = 0xAA;                       // enter safe mode
+  GLOBAL_CFG |= bDATA_WE;                   // enable DataFlash write
+  SAFE_MOD    = 0x00;                       // terminate safe mode
+  ROM_ADDR_H  = DATA_FLASH_ADDR >> 8;
+  ROM_ADDR_L  = addr << 1;
+  ROM_DATA_L  = data;
+  if(ROM_STATUS & bROM_ADDR_OK) {           // valid address?
+    ROM_CTRL  = ROM_CMD_WRITE;              // write byte (CPU halts meanwhile)
+    status    = ROM_STATUS & bROM_CMD_ERR;  // command accepted?
+  }
+  SAFE_MOD    = 0x55;
+  SAFE_MOD    = 0xAA;                       // enter safe mode
+  GLOBAL_CFG &= ~bDATA_WE;                  // write protect DataFlash
+  SAFE_MOD    = 0x00;                       // terminate safe mode
+  return status;
+  #endif
+}
+
+// Write byte to DataFlash if different, returns 0 on success
+uint8_t FLASH_update(uint8_t addr, uint8_t data) {
+  if(FLASH_read(addr) == data) return 0;
+  return FLASH_write(addr, data);
+}
+
+// ===================================================================================
+// Read/Write Code Flash
+// ===================================================================================
+
+// Read byte from code flash
+uint8_t FLASH_readCode(uint16_t addr) {
+  #ifdef SIMULATOR
+  return SIM_codeRead(addr);
+  #else
+  return *(__code uint8_t*)addr;
+  #endif
+}
+
+// Write word to code flash (even address, low byte first), returns 0 on success
+uint8_t FLASH_writeCode(uint16_t addr, uint16_t data) {
+  #ifdef SIMULATOR
+  return SIM_codeWrite(addr, data);
+  #else
+  uint8_t status = 1;
+  if(addr >= BOOT_LOAD_ADDR) return status; // protect bootloader
+  SAFE_MOD    = 0x55;
+  SAFE_MOD    = 0xAA;                       // enter safe mode
+  GLOBAL_CFG |= bCODE_WE;                   // enable code flash write
+  SAFE_MOD    = 0x00;                       // terminate safe mode
+  ROM_ADDR    = addr;
+  ROM_DATA    = data;
+  if(ROM_STATUS & bROM_ADDR_OK) {           // valid address?
+    ROM_CTRL  = ROM_CMD_WRITE;              // write word (CPU halts meanwhile)
+    status    = ROM_STATUS & bROM_CMD_ERR;  // command accepted?
+  }
+  SAFE_MOD    = 0x55;
+  SAFE_MOD    = 0xAA;                       // enter safe mode
+  GLOBAL_CFG &= ~bCODE_WE;                  // write protect code flash
+  SAFE_MOD    = 0x00;                       // terminate safe mode
+  return status;
+  #endif
+}
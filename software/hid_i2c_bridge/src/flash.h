@@ -0,0 +1,35 @@
+// ===================================================================================
+// Data Flash Functions for CH551, CH552 and CH554                            * v1.1 *
+// ===================================================================================
+//
+// The CH55x has 128 bytes of DataFlash, which keep their content while the power is
+// off. Each byte can be written directly without erasing (about 10k write cycles),
+// FLASH_update() only writes bytes that differ. Unused parts of the code flash can
+// be written in 16-bit words (even addresses below BOOT_LOAD_ADDR) to store constant
+// data like display frames. The bootloader erases them when a new firmware is
+// uploaded.
+//
+// Functions available:
+// --------------------
+// FLASH_read(addr)         read byte from DataFlash (addr: 0 - 127)
+// FLASH_write(addr, data)  write byte to DataFlash, returns 0 on success
+// FLASH_update(addr, data) write byte to DataFlash if different, returns 0 on success
+// FLASH_readCode(addr)     read byte from code flash
+// FLASH_writeCode(addr, w) write word to code flash (even addr), returns 0 on success
+//
+// Write operations halt the CPU for some microseconds, they should be done in the
+// main loop and not in interrupts.
+//
+// 2022 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+#include <stdint.h>
+#include "ch554.h"
+
+#define FLASH_SIZE  128                     // size of DataFlash in bytes
+
+uint8_t FLASH_read(uint8_t addr);
+uint8_t FLASH_write(uint8_t addr, uint8_t data);
+uint8_t FLASH_update(uint8_t addr, uint8_t data);
+uint8_t FLASH_readCode(uint16_t addr);
+uint8_t FLASH_writeCode(uint16_t addr, uint16_t data);
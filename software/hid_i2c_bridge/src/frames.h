@@ -0,0 +1,61 @@
+// ===================================================================================
+// Frame Store in Code Flash for CH551, CH552 and CH554                       * v1.1 *
+// ===================================================================================
+//
+// The end of the code flash below the bootloader (FRAME_ADDR, the makefile limits
+// the firmware to the space in front of it) holds FRAME_COUNT pre-encoded frames in
+// the byte order of the SSD1306 display RAM (8 pages of 128 bytes). The bridge shows
+// them by itself: the splash frame at power-up (boot splash CFG_SPLASH_FRAME of the
+// device configuration) and the suspend frame when the host suspends the bus or is
+// disconnected (power-up mode CFG_MODE_SUSPEND), so that the display is neither
+// blank nor noisy while the host restarts. A frame is shown from display RAM line 0
+// on, 128x32 panels show its upper half.
+//
+// The host writes the frames in chunks of FRAME_CHUNK bytes with the vendor request
+// FRAME_REQ_WRITE (wValue: frame, wIndex: byte offset, control OUT) and shows a frame
+// with FRAME_REQ_SHOW (wValue: frame or FRAME_BLANK). A chunk is stored in the code
+// flash by FRAME_update() in the main loop, the next chunk is stalled until then.
+// Uploading a new firmware with the bootloader erases the frames.
+//
+// Functions available:
+// --------------------
+// FRAME_update()           store received chunk and show requested frame (main loop)
+// FRAME_show(frame)        send frame to the OLED (FRAME_BLANK: clear display RAM)
+// FRAME_locate(page, col)  set OLED write position (page 0 - 7, column 0 - 127)
+// FRAME_home()             set OLED back to full screen and write position to home
+// FRAME_suspend()          show suspend frame if enabled (USB suspend handler)
+// FRAME_control()          handle vendor setup requests, returns length or 0xff
+// FRAME_EP0_OUT()          handle vendor control OUT data
+//
+// 2022 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+#include <stdint.h>
+#include "flash.h"
+
+// ===================================================================================
+// Frame Store
+// ===================================================================================
+#define FRAME_ADDR        0x3000                  // start address in code flash
+#define FRAME_SIZE        1024                    // bytes per frame (128x64 pixels)
+#define FRAME_COUNT       2                       // number of frames
+#define FRAME_CHUNK       64                      // bytes per write request
+
+#define FRAME_SPLASH      0                       // frame shown at power-up
+#define FRAME_SUSPEND     1                       // frame shown on USB suspend
+#define FRAME_BLANK       0xFF                    // clear display RAM
+#define FRAME_NONE        0xFE                    // internal: nothing to show
+
+#define FRAME_REQ_WRITE   10                      // vendor request: write chunk (OUT)
+#define FRAME_REQ_SHOW    11                      // vendor request: show frame
+
+// ===================================================================================
+// Functions
+// ===================================================================================
+void FRAME_update(void);
+void FRAME_show(uint8_t frame);
+void FRAME_locate(uint8_t page, uint8_t column);
+void FRAME_home(void);
+void FRAME_suspend(void);
+uint8_t FRAME_control(void);
+void FRAME_EP0_OUT(void);
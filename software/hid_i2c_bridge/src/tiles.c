@@ -0,0 +1,112 @@
+// ===================================================================================
+// Tile Table in Code Flash for CH551, CH552 and CH554                        * v1.0 *
+// ===================================================================================
+
+#include "tiles.h"
+#include "frames.h"
+#include "devcfg.h"
+#include "i2c.h"
+#include "usb_handler.h"
+
+// ===================================================================================
+// Variables
+// ===================================================================================
+__xdata uint8_t TILE_buffer[TILE_CHUNK];           // tiles or tile indices via USB
+__xdata uint8_t TILE_length;                       // number of bytes in buffer
+__xdata uint8_t TILE_first;                        // first tile to be stored
+__xdata uint8_t TILE_page;                         // page of the run
+__xdata uint8_t TILE_column;                       // column of the run
+__bit TILE_draw;                                   // buffer holds tile indices
+volatile __bit TILE_pending = 0;                   // received data not yet handled
+
+// ===================================================================================
+// Tile Functions
+// ===================================================================================
+
+// Store received tiles in code flash, words that did not change are skipped
+void TILE_store(void) {
+  uint8_t i;
+  uint16_t addr = TILE_ADDR + TILE_first * TILE_SIZE;
+  for(i=0; i<TILE_length; i+=2, addr+=2) {
+    if(FLASH_readCode(addr) != TILE_buffer[i] || FLASH_readCode(addr+1) != TILE_buffer[i+1])
+      FLASH_writeCode(addr, TILE_buffer[i] | (uint16_t)TILE_buffer[i+1] << 8);
+  }
+}
+
+// Draw received run of tile indices
+void TILE_run(void) {
+  uint8_t i, j;
+  uint8_t page = TILE_page;
+  uint8_t column = TILE_column;
+  uint16_t addr;
+  for(i=0; i<TILE_length && page<8; i++) {
+    if(!i || !column) {                           // start of a row
+      FRAME_locate(page, column);
+      I2C_start();
+      I2C_write(CFG_record.addr);
+      I2C_write(0x40);                            // data mode
+    }
+    addr = TILE_ADDR + TILE_buffer[i] * TILE_SIZE;
+    for(j=TILE_SIZE; j; j--, column++) {
+      if(column < 128) I2C_write(FLASH_readCode(addr++));
+    }
+    if(column >= 128) {                           // continue on the next page
+      I2C_stop();
+      page++;
+      column = 0;
+    }
+  }
+  if(column) I2C_stop();
+  FRAME_home();
+}
+
+// Store received tiles or draw received run (main loop)
+void TILE_update(void) {
+  if(TILE_pending) {
+    if(TILE_draw) TILE_run();
+    else          TILE_store();
+    TILE_pending = 0;
+  }
+}
+
+// ===================================================================================
+// USB Request Functions
+// ===================================================================================
+
+// Handle vendor setup requests of the tile table
+uint8_t TILE_control(void) {
+  uint8_t low  = USB_SetupBuf->wValueL;
+  uint8_t high = USB_SetupBuf->wValueH;
+  if(TILE_pending || !USB_SetupLen || USB_SetupLen > TILE_CHUNK) return 0xff;
+  TILE_length = USB_SetupLen;
+  switch(USB_SetupReq) {
+    case TILE_REQ_LOAD:                           // store tiles
+      if(high || TILE_length % TILE_SIZE
+         || low + (TILE_length / TILE_SIZE) > TILE_COUNT) return 0xff;
+      TILE_first = low;
+      TILE_draw  = 0;
+      break;
+
+    case TILE_REQ_DRAW:                           // draw run of tiles
+      if(low > 7 || high > 127) return 0xff;
+      TILE_page   = low;
+      TILE_column = high;
+      TILE_draw   = 1;
+      break;
+
+    default:
+      return 0xff;
+  }
+  USB_pData = TILE_buffer;
+  return 0;
+}
+
+// Handle vendor control OUT data (tiles or tile indices)
+void TILE_EP0_OUT(void) {
+  if(USB_EP0_storeData()) {                       // more packets to come?
+    UEP0_CTRL ^= bUEP_R_TOG;
+    return;
+  }
+  TILE_pending = 1;                               // handle data in main loop
+  UEP0_CTRL = bUEP_T_TOG | UEP_T_RES_ACK | UEP_R_RES_ACK;
+}
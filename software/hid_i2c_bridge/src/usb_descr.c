@@ -3,6 +3,10 @@
 // ===================================================================================
 
 #include "usb_descr.h"
+#include "usb_hid_data.h"
+#include "perf.h"
+#include "tick.h"
+#include "devcfg.h"
 
 // ===================================================================================
 // Device Descriptor
@@ -24,6 +28,54 @@ __code USB_DEV_DESCR DevDescr = {
   .bNumConfigurations = 1                       // number of possible configurations
 };
 
+// ===================================================================================
+// HID Report Descriptor
+// ===================================================================================
+// One report ID per report with the size of its record (plus the ID byte in front):
+// data 63 bytes (input/output), counters, timestamps, config, controls and feature
+// bits (feature)
+__code uint8_t ReportDescr[] ={
+  0x06, 0x00, 0xFF,   // Usage Page = 0xFF00 (Vendor Defined Page 1)
+  0x09, 0x01,         // Usage (Vendor Usage 1)
+  0xA1, 0x01,         // Collection (Application)
+  0x15, 0x00,         //   Logical minimum value 0
+  0x25, 0xFF,         //   Logical maximum value 255
+  0x75, 0x08,         //   Report Size: 8-bit field size
+  0x85, HID_REPORT_DATA,                    // Report ID: data
+  0x95, EP1_SIZE - 1, //   Report Count: Make 63 fields
+  0x09, 0x01,         //   Usage (Vendor Usage 1)
+  0x81, 0x02,         //   Input (Data,Var,Abs,No Wrap,Linear)
+  0x09, 0x01,         //   Usage (Vendor Usage 1)
+  0x91, 0x02,         //   Output (Data,Var,Abs,No Wrap,Linear)
+  #ifdef PERF_COUNTERS
+  0x85, HID_REPORT_PERF,                    // Report ID: performance counters
+  0x95, sizeof(PERF_COUNTERS_TYPE),         //   Report Count: size of the counters
+  0x09, 0x01,         //   Usage (Vendor Usage 1)
+  0xB1, 0x02,         //   Feature (Data,Var,Abs,No Wrap,Linear)
+  #endif
+  #ifdef TICK_TIMESTAMPS
+  0x85, HID_REPORT_TRACE,                   // Report ID: transaction timestamps
+  0x95, sizeof(TICK_TRACE_TYPE),            //   Report Count: size of the timestamps
+  0x09, 0x01,         //   Usage (Vendor Usage 1)
+  0xB1, 0x02,         //   Feature (Data,Var,Abs,No Wrap,Linear)
+  #endif
+  0x85, HID_REPORT_CONFIG,                  // Report ID: device configuration
+  0x95, sizeof(CFG_RECORD_TYPE),            //   Report Count: size of the record
+  0x09, 0x01,         //   Usage (Vendor Usage 1)
+  0xB1, 0x02,         //   Feature (Data,Var,Abs,No Wrap,Linear)
+  0x85, HID_REPORT_CONTROL,                 // Report ID: controls
+  0x95, sizeof(HID_CONTROL_TYPE),           //   Report Count: size of the controls
+  0x09, 0x01,         //   Usage (Vendor Usage 1)
+  0xB1, 0x02,         //   Feature (Data,Var,Abs,No Wrap,Linear)
+  0x85, HID_REPORT_FEATURES,                // Report ID: device feature bits
+  0x95, 0x01,         //   Report Count: one byte (CFG_FEATURES)
+  0x09, 0x01,         //   Usage (Vendor Usage 1)
+  0xB1, 0x02,         //   Feature (Data,Var,Abs,No Wrap,Linear)
+  0xC0                // End Collection
+};
+
+__code uint8_t ReportDescrLen = sizeof(ReportDescr);
+
 // ===================================================================================
 // Configuration Descriptor
 // ===================================================================================
@@ -86,46 +138,44 @@ __code USB_CFG_DESCR_HID CfgDescr = {
   }
 };
 
-// ===================================================================================
-// HID Report Descriptor
-// ===================================================================================
-__code uint8_t ReportDescr[] ={
-  0x06, 0x00, 0xFF,   // Usage Page = 0xFF00 (Vendor Defined Page 1)
-  0x09, 0x01,         // Usage (Vendor Usage 1)
-  0xA1, 0x01,         // Collection (Application)
-  0x15, 0x00,         //   Logical minimum value 0
-  0x25, 0xFF,         //   Logical maximum value 255
-  0x75, 0x08,         //   Report Size: 8-bit field size
-  0x95, 0x40,         //   Report Count: Make 64 fields
-  0x09, 0x01,         //   Usage (Vendor Usage 1)
-  0x81, 0x02,         //   Input (Data,Var,Abs,No Wrap,Linear)
-  0x09, 0x01,         //   Usage (Vendor Usage 1)
-  0x91, 0x02,         //   Output (Data,Var,Abs,No Wrap,Linear)
-  0xC0                // End Collection
-};
-
-__code uint8_t ReportDescrLen = sizeof(ReportDescr);
-
 // ===================================================================================
 // String Descriptors
 // ===================================================================================
 
+// String descriptor length (GCC does not allow sizeof() of an array inside its own
+// initializer, therefore the host simulation sets the length on startup)
+#ifdef SIMULATOR
+  #define USB_STR_LEN(descr)  0
+#else
+  #define USB_STR_LEN(descr)  sizeof(descr)
+#endif
+
 // Language Descriptor (Index 0)
 __code uint16_t LangDescr[] = {
-  ((uint16_t)USB_DESCR_TYP_STRING << 8) | sizeof(LangDescr), 0x0409 };  // US English
+  ((uint16_t)USB_DESCR_TYP_STRING << 8) | USB_STR_LEN(LangDescr), 0x0409 };  // US English
 
 // Manufacturer String Descriptor (Index 1)
 __code uint16_t ManufDescr[] = {
-  ((uint16_t)USB_DESCR_TYP_STRING << 8) | sizeof(ManufDescr), MANUFACTURER_STR };
+  ((uint16_t)USB_DESCR_TYP_STRING << 8) | USB_STR_LEN(ManufDescr), MANUFACTURER_STR };
 
 // Product String Descriptor (Index 2)
 __code uint16_t ProdDescr[] = {
-  ((uint16_t)USB_DESCR_TYP_STRING << 8) | sizeof(ProdDescr), PRODUCT_STR };
+  ((uint16_t)USB_DESCR_TYP_STRING << 8) | USB_STR_LEN(ProdDescr), PRODUCT_STR };
 
 // Serial String Descriptor (Index 3)
 __code uint16_t SerDescr[] = {
-  ((uint16_t)USB_DESCR_TYP_STRING << 8) | sizeof(SerDescr), SERIAL_STR };
+  ((uint16_t)USB_DESCR_TYP_STRING << 8) | USB_STR_LEN(SerDescr), SERIAL_STR };
 
 // Interface String Descriptor (Index 4)
 __code uint16_t InterfDescr[] = {
-  ((uint16_t)USB_DESCR_TYP_STRING << 8) | sizeof(InterfDescr), INTERFACE_STR };
+  ((uint16_t)USB_DESCR_TYP_STRING << 8) | USB_STR_LEN(InterfDescr), INTERFACE_STR };
+
+#ifdef SIMULATOR
+__attribute__((constructor)) static void USB_STR_init(void) {
+  LangDescr[0]      |= sizeof(LangDescr);
+  ManufDescr[0]     |= sizeof(ManufDescr);
+  ProdDescr[0]      |= sizeof(ProdDescr);
+  SerDescr[0]       |= sizeof(SerDescr);
+  InterfDescr[0]    |= sizeof(InterfDescr);
+}
+#endif
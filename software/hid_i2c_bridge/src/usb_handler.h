@@ -15,19 +15,32 @@ extern volatile uint8_t  USB_SetupReq, USB_SetupTyp;
 extern volatile uint16_t USB_SetupLen;
 extern volatile __bit    USB_ENUM_OK;
 extern __code uint8_t*   USB_pDescr;
+extern __xdata uint8_t*  USB_pData;
 
 // ===================================================================================
 // Custom External USB Handler Functions
 // ===================================================================================
 void HID_EP_init(void);
+uint8_t HID_control(void);
+void HID_EP0_IN(void);
+void HID_EP0_OUT(void);
 void HID_EP1_IN(void);
 void HID_EP1_OUT(void);
+uint8_t HID_VEN_control(void);
+void HID_VEN_EP0_OUT(void);
+void FRAME_suspend(void);
 
 // ===================================================================================
 // USB Handler Defines
 // ===================================================================================
 // Custom USB handler functions
 #define USB_INIT_endpoints      HID_EP_init     // custom USB EP init handler
+#define USB_CLASS_SETUP_handler HID_control     // handle class setup requests
+#define USB_CLASS_IN_handler    HID_EP0_IN      // handle class in transfers
+#define USB_CLASS_OUT_handler   HID_EP0_OUT     // handle class out transfers
+#define USB_VENDOR_SETUP_handler HID_VEN_control // handle vendor setup requests
+#define USB_VENDOR_OUT_handler  HID_VEN_EP0_OUT // handle vendor out transfers
+#define USB_SUSPEND_handler     FRAME_suspend   // suspend frame, power-down
 
 // Endpoint callback functions
 #define EP0_SETUP_callback      USB_EP0_SETUP
@@ -42,3 +55,5 @@ void HID_EP1_OUT(void);
 void USB_init(void);
 void USB_interrupt(void);
 void USB_EP0_copyDescr(uint8_t len);
+uint8_t USB_EP0_copyData(void);
+uint8_t USB_EP0_storeData(void);
@@ -1,90 +1,249 @@
-// ===================================================================================
-// USB HID Data Functions for CH551, CH552 and CH554                          * v1.1 *
-// ===================================================================================
-
-#include "usb_hid_data.h"
-
-// ===================================================================================
-// Variables and Defines
-// ===================================================================================
-volatile __xdata uint8_t HID_readByteCount;     // number of data bytes in RX buffer
-volatile __bit HID_writeBusyFlag;               // TX buffer is being transmitted flag
-
-#if HID_DATA_FUNCTIONS > 0
-volatile __xdata uint8_t HID_readPointer;       // data pointer for fetching
-volatile __xdata uint8_t HID_writePointer = 0;  // data pointer for writing
-#endif
-
-// ===================================================================================
-// Front End Functions
-// ===================================================================================
-#if HID_DATA_FUNCTIONS > 0
-// Flush the TX buffer (upload to host)
-void HID_flush(void) {
-  if(!HID_writeBusyFlag && HID_writePointer) {  // not busy and buffer not empty?
-    HID_writeBusyFlag = 1;                      // busy for now
-    UEP1_T_LEN = EP1_SIZE;                      // full buffer needs to be transmitted
-    UEP1_CTRL  = (UEP1_CTRL & ~MASK_UEP_T_RES)
-               | UEP_T_RES_ACK;                 // upload data to host
-  }
-}
-
-// Write single byte to TX buffer
-void HID_write(uint8_t c) {
-  while(HID_writeBusyFlag);                     // wait for ready to write
-  EP1_buffer[64 + HID_writePointer++] = c;      // write byte to buffer
-  if(HID_writePointer == EP1_SIZE) HID_flush(); // flush if buffer full
-}
-
-// Read single byte from RX buffer
-uint8_t HID_read(void) {
-  uint8_t data;
-  while(!HID_readByteCount);                    // wait for data
-  data = EP1_buffer[HID_readPointer++];         // get character
-  if(--HID_readByteCount == 0)                  // dec number of bytes in buffer
-    UEP1_CTRL = (UEP1_CTRL & ~MASK_UEP_R_RES)
-              | UEP_R_RES_ACK;                  // request new data if empty
-  return data;
-}
-#endif
-
-// ===================================================================================
-// HID-Specific USB Handler Functions
-// ===================================================================================
-
-// Setup/reset HID endpoints
-void HID_EP_init(void) {
-  UEP1_DMA    = (uint16_t)EP1_buffer;           // EP1 data transfer address
-  UEP1_CTRL   = bUEP_AUTO_TOG                   // EP1 Auto flip sync flag
-              | UEP_T_RES_NAK                   // EP1 IN transaction returns NAK
-              | UEP_R_RES_ACK;                  // EP1 OUT transaction returns ACK
-  UEP4_1_MOD  = bUEP1_TX_EN                     // EP1 TX enable
-              | bUEP1_RX_EN;                    // EP1 RX_enable
-  UEP1_T_LEN  = 0;                              // EP1 nothing to send
-  HID_readByteCount = 0;                        // reset received bytes counter
-  HID_writeBusyFlag = 0;                        // reset write busy flag
-}
-
-// Endpoint 1 IN handler (HID report transfer to host)
-void HID_EP1_IN(void) {
-  UEP1_CTRL = (UEP1_CTRL & ~MASK_UEP_T_RES) | UEP_T_RES_NAK;  // default NAK
-  HID_writeBusyFlag = 0;                        // clear busy flag
-
-  #if HID_DATA_FUNCTIONS > 0
-  HID_writePointer = 0;                         // reset write pointer
-  #endif
-}
-
-// Endpoint 1 OUT handler (HID report transfer from host)
-void HID_EP1_OUT(void) {
-  if(U_TOG_OK) {                                // discard unsynchronized packets
-    HID_readByteCount = USB_RX_LEN;             // set number of received data bytes
-    if(HID_readByteCount) {                     // received some bytes=
-      UEP1_CTRL = (UEP1_CTRL & ~MASK_UEP_R_RES) | UEP_R_RES_NAK;  // NAK for now
-
-      #if HID_DATA_FUNCTIONS > 0
-      HID_readPointer = 0;                      // reset read pointer for fetching
-      #endif
-    }
-  }
-}
+// ===================================================================================
+// USB HID Data Functions for CH551, CH552 and CH554                          * v1.2 *
+// ===================================================================================
+
+#include "usb_hid_data.h"
+#include "perf.h"
+#include "tick.h"
+#include "devcfg.h"
+#include "frames.h"
+#include "tiles.h"
+#include "i2c.h"
+
+// ===================================================================================
+// Variables and Defines
+// ===================================================================================
+volatile __xdata uint8_t HID_readByteCount;     // number of data bytes in RX buffer
+volatile __bit HID_writeBusyFlag;               // TX buffer is being transmitted flag
+
+#if HID_DATA_FUNCTIONS > 0
+volatile __xdata uint8_t HID_readPointer;       // data pointer for fetching
+volatile __xdata uint8_t HID_writePointer = 0;  // data pointer for writing
+#endif
+
+// Controls (feature report 5), applied by the main loop
+__xdata HID_CONTROL_TYPE HID_controls = {0, CFG_SPEED_FAST, 0x7F};
+__xdata HID_CONTROL_TYPE HID_controlBuffer;     // record of the SET_REPORT request
+volatile __bit HID_CONTROL_flag = 0;            // written record not yet applied
+__xdata uint8_t HID_report;                     // ID of the running feature request
+__bit HID_reportFirst;                          // next OUT packet starts with the ID
+
+// HID class requests
+#define HID_GET_REPORT          0x01            // host reads a report via EP0
+#define HID_SET_REPORT          0x09            // host writes a report via EP0
+#define HID_REPORT_FEATURE      0x03            // report type (wValueH): feature report
+
+// ===================================================================================
+// Front End Functions
+// ===================================================================================
+#if HID_DATA_FUNCTIONS > 0
+// Flush the TX buffer (upload to host)
+void HID_flush(void) {
+  if(!HID_writeBusyFlag && HID_writePointer) {  // not busy and buffer not empty?
+    HID_writeBusyFlag = 1;                      // busy for now
+    UEP1_T_LEN = EP1_SIZE;                      // full buffer needs to be transmitted
+    UEP1_CTRL  = (UEP1_CTRL & ~MASK_UEP_T_RES)
+               | UEP_T_RES_ACK;                 // upload data to host
+  }
+}
+
+// Write single byte to TX buffer
+void HID_write(uint8_t c) {
+  while(HID_writeBusyFlag);                     // wait for ready to write
+  if(!HID_writePointer)                         // input report starts with its ID
+    EP1_buffer[64 + HID_writePointer++] = HID_REPORT_DATA;
+  EP1_buffer[64 + HID_writePointer++] = c;      // write byte to buffer
+  if(HID_writePointer == EP1_SIZE) HID_flush(); // flush if buffer full
+}
+
+// Read single byte from RX buffer
+uint8_t HID_read(void) {
+  uint8_t data;
+  while(!HID_readByteCount);                    // wait for data
+  data = EP1_buffer[HID_readPointer++];         // get character
+  if(--HID_readByteCount == 0) {                // dec number of bytes in buffer
+    UEP1_CTRL = (UEP1_CTRL & ~MASK_UEP_R_RES)
+              | UEP_R_RES_ACK;                  // request new data if empty
+    PERF_nakStop();                             // end of endpoint stall
+    TICK_drained();
+  }
+  return data;
+}
+#endif
+
+// ===================================================================================
+// HID-Specific USB Handler Functions
+// ===================================================================================
+
+// Setup/reset HID endpoints
+void HID_EP_init(void) {
+  UEP1_DMA    = (uint16_t)EP1_buffer;           // EP1 data transfer address
+  UEP1_CTRL   = bUEP_AUTO_TOG                   // EP1 Auto flip sync flag
+              | UEP_T_RES_NAK                   // EP1 IN transaction returns NAK
+              | UEP_R_RES_ACK;                  // EP1 OUT transaction returns ACK
+  UEP4_1_MOD  = bUEP1_TX_EN                     // EP1 TX enable
+              | bUEP1_RX_EN;                    // EP1 RX_enable
+  UEP1_T_LEN  = 0;                              // EP1 nothing to send
+  HID_readByteCount = 0;                        // reset received bytes counter
+  HID_writeBusyFlag = 0;                        // reset write busy flag
+}
+
+// Copy controls to EP0 buffer (the ones of a written record that is not yet applied,
+// the I2C clock may have been set by the device configuration as well)
+uint8_t HID_copyControls(void) {
+  if(USB_SetupLen > sizeof(HID_controls)) USB_SetupLen = sizeof(HID_controls);
+  HID_controls.speed = I2C_slow ? CFG_SPEED_SLOW : CFG_SPEED_FAST;
+  USB_pData = HID_CONTROL_flag ? (__xdata uint8_t*)&HID_controlBuffer
+                               : (__xdata uint8_t*)&HID_controls;
+  return USB_EP0_copyData();
+}
+
+// Prepare receiving controls (complete record only, previous one applied)
+uint8_t HID_receiveControls(void) {
+  if(HID_CONTROL_flag || USB_SetupLen != sizeof(HID_controlBuffer)) return 0xff;
+  USB_pData = (__xdata uint8_t*)&HID_controlBuffer;
+  return 0;
+}
+
+// Put the report ID in front of the first packet of a record copied to EP0 (the
+// length of the request includes the ID, the last byte goes to the next packet)
+uint8_t HID_prefixReport(uint8_t len) {
+  uint8_t i;
+  if(len == EP0_SIZE) {
+    len--;
+    USB_pData--;
+  }
+  for(i=len; i; i--) EP0_buffer[i] = EP0_buffer[i - 1];
+  EP0_buffer[0] = HID_report;
+  USB_SetupLen++;
+  return len + 1;
+}
+
+// Handle CLASS SETUP requests
+// The low byte of wValue is the report ID of the feature report, the record follows
+// the ID in the data stage.
+uint8_t HID_control(void) {
+  uint8_t len;
+  if(USB_SetupBuf->wValueH != HID_REPORT_FEATURE || !USB_SetupLen) return 0xff;
+  HID_report = USB_SetupBuf->wValueL;
+  USB_SetupLen--;                               // length of the record
+  if(USB_SetupReq == HID_GET_REPORT) {
+    switch(HID_report) {
+      #ifdef PERF_COUNTERS
+      case HID_REPORT_PERF:    len = PERF_copy();        break; // performance counters
+      #endif
+      #ifdef TICK_TIMESTAMPS
+      case HID_REPORT_TRACE:   len = TICK_copy();        break; // transaction timestamps
+      #endif
+      case HID_REPORT_CONFIG:  len = CFG_copy();         break; // device configuration
+      case HID_REPORT_CONTROL: len = HID_copyControls(); break; // controls
+      case HID_REPORT_FEATURES: len = CFG_copyFeatures(); break; // feature bits
+      default: return 0xff;                     // report not supported
+    }
+    return HID_prefixReport(len);
+  }
+  if(USB_SetupReq == HID_SET_REPORT) {
+    HID_reportFirst = 1;
+    switch(HID_report) {
+      case HID_REPORT_CONFIG:  return CFG_receive();          // device configuration
+      case HID_REPORT_CONTROL: return HID_receiveControls();  // controls
+      default: break;
+    }
+  }
+  return 0xff;                                  // command not supported
+}
+
+// Endpoint 0 CLASS IN handler (further packets of the feature report)
+void HID_EP0_IN(void) {
+  uint8_t len;
+  if(USB_SetupReq == HID_GET_REPORT) {
+    len = USB_EP0_copyData();                   // copy next packet to EP0
+    USB_SetupLen -= len;
+    UEP0_T_LEN    = len;
+    UEP0_CTRL    ^= bUEP_T_TOG;                 // switch between DATA0 and DATA1
+  }
+  else UEP0_CTRL = bUEP_R_TOG | UEP_T_RES_NAK | UEP_R_RES_ACK;
+}
+
+// Endpoint 0 CLASS OUT handler (packets of the configuration and control reports)
+void HID_EP0_OUT(void) {
+  uint8_t i, result;
+  if(USB_SetupReq == HID_SET_REPORT) {
+    if(HID_reportFirst) {                       // first packet: report ID, then record
+      HID_reportFirst = 0;
+      if(!USB_RX_LEN || EP0_buffer[0] != HID_report) HID_report = 0;
+      for(i=1; i<USB_RX_LEN && USB_SetupLen; i++, USB_SetupLen--)
+        *USB_pData++ = EP0_buffer[i];
+    }
+    else USB_EP0_storeData();
+    if(USB_SetupLen) {                          // more packets to come?
+      UEP0_CTRL ^= bUEP_R_TOG;
+      return;
+    }
+    if(HID_report == HID_REPORT_CONTROL) {      // (EP0 buffer holds data, not setup)
+      HID_CONTROL_flag = 1;                     // apply in main loop
+      result = 0;
+    }
+    else if(HID_report == HID_REPORT_CONFIG) result = CFG_received();
+    else result = 0xff;                         // report ID of the data is wrong
+    if(result == 0xff) {                        // invalid record: stall status stage
+      UEP0_CTRL = bUEP_R_TOG | bUEP_T_TOG | UEP_R_RES_STALL | UEP_T_RES_STALL;
+      return;
+    }
+  }
+  UEP0_CTRL = bUEP_T_TOG | UEP_T_RES_ACK | UEP_R_RES_ACK;
+}
+
+// Handle VENDOR SETUP requests (frame store and tile table of the bridge)
+uint8_t HID_VEN_control(void) {
+  switch(USB_SetupReq) {
+    case TILE_REQ_LOAD:
+    case TILE_REQ_DRAW:
+      return TILE_control();
+    default:
+      return FRAME_control();
+  }
+}
+
+// Endpoint 0 VENDOR OUT handler
+void HID_VEN_EP0_OUT(void) {
+  switch(USB_SetupReq) {
+    case TILE_REQ_LOAD:
+    case TILE_REQ_DRAW:
+      TILE_EP0_OUT();
+      break;
+    default:
+      FRAME_EP0_OUT();
+      break;
+  }
+}
+
+// Endpoint 1 IN handler (HID report transfer to host)
+void HID_EP1_IN(void) {
+  UEP1_CTRL = (UEP1_CTRL & ~MASK_UEP_T_RES) | UEP_T_RES_NAK;  // default NAK
+  HID_writeBusyFlag = 0;                        // clear busy flag
+
+  #if HID_DATA_FUNCTIONS > 0
+  HID_writePointer = 0;                         // reset write pointer
+  #endif
+}
+
+// Endpoint 1 OUT handler (HID report transfer from host)
+// The data follows the report ID, reports with another ID are discarded.
+void HID_EP1_OUT(void) {
+  if(U_TOG_OK) {                                // discard unsynchronized packets
+    if(USB_RX_LEN > 1 && EP1_buffer[0] == HID_REPORT_DATA) {
+      HID_readByteCount = USB_RX_LEN - 1;       // set number of received data bytes
+      UEP1_CTRL = (UEP1_CTRL & ~MASK_UEP_R_RES) | UEP_R_RES_NAK;  // NAK for now
+
+      #if HID_DATA_FUNCTIONS > 0
+      HID_readPointer = 1;                      // data starts after the report ID
+      #endif
+
+      PERF_add(bytes, HID_readByteCount);
+      PERF_inc(naks);
+      PERF_nakStart();
+      TICK_packet(HID_readByteCount);
+    }
+  }
+}
@@ -1,47 +1,76 @@
-// ===================================================================================
-// USB HID Data Functions for CH551, CH552 and CH554                          * v1.1 *
-// ===================================================================================
-//
-// Functions available:
-// --------------------
-// HID_init()               init USB HID data
-// HID_available()          get number of bytes in the RX buffer
-// HID_ready()              check if TX buffer is ready to be written
-// HID_read()               read single byte from RX buffer (*)
-// HID_write(c)             write single byte to TX buffer, flush if full (*)
-// HID_flush()              flush TX buffer (*)
-//
-// (*) only available if HID_DATA_FUNCTIONS is set to 1 (see below in parameters)
-//
-// 2022 by Stefan Wagner:   https://github.com/wagiminator
-
-#pragma once
-#include <stdint.h>
-#include "ch554.h"
-#include "usb.h"
-#include "usb_descr.h"
-#include "usb_handler.h"
-
-// ===================================================================================
-// HID Parameters
-// ===================================================================================
-#define HID_DATA_FUNCTIONS    1                     // 1: enable additional functions
-
-// ===================================================================================
-// HID Variables
-// ===================================================================================
-extern volatile __xdata uint8_t HID_readByteCount;  // number of data bytes in RX buffer
-extern volatile __bit HID_writeBusyFlag;            // TX buffer is being transmitted flag
-
-// ===================================================================================
-// HID Functions
-// ===================================================================================
-#define HID_init          USB_init                  // setup USB HID data
-#define HID_available()   (HID_readByteCount)       // ready to be read
-#define HID_ready()       (!HID_writeBusyFlag)      // ready to be written
-
-#if HID_DATA_FUNCTIONS > 0
-void HID_flush(void);                               // flush TX buffer
-uint8_t HID_read(void);                             // read single byte from RX buffer
-void HID_write(uint8_t c);                          // write single byte to TX buffer
-#endif
+// ===================================================================================
+// USB HID Data Functions for CH551, CH552 and CH554                          * v1.2 *
+// ===================================================================================
+//
+// Functions available:
+// --------------------
+// HID_init()               init USB HID data
+// HID_available()          get number of bytes in the RX buffer
+// HID_ready()              check if TX buffer is ready to be written
+// HID_read()               read single byte from RX buffer (*)
+// HID_write(c)             write single byte to TX buffer, flush if full (*)
+// HID_flush()              flush TX buffer (*)
+//
+// (*) only available if HID_DATA_FUNCTIONS is set to 1 (see below in parameters)
+//
+// Every report starts with its report ID (see ReportDescr in usb_descr.c): the
+// pixel data is output report 1 on the interrupt pipe (63 bytes, one I2C
+// transaction), feature reports (GET_REPORT/SET_REPORT on EP0) keep queries and
+// settings away from the data: 2: performance counters (GET), 3: transaction
+// timestamps (GET), 4: device configuration (GET/SET), 5: controls (GET/SET, see
+// HID_CONTROL_TYPE), 6: feature bits (GET, see CFG_FEATURES). A written control
+// record is applied by the main loop (HID_CONTROL_flag), further records are
+// stalled until then.
+//
+// 2022 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+#include <stdint.h>
+#include "ch554.h"
+#include "usb.h"
+#include "usb_descr.h"
+#include "usb_handler.h"
+
+// ===================================================================================
+// HID Parameters
+// ===================================================================================
+#define HID_DATA_FUNCTIONS    1                     // 1: enable additional functions
+
+// ===================================================================================
+// HID Report IDs
+// ===================================================================================
+#define HID_REPORT_DATA       0x01                  // output: pixel data and commands
+#define HID_REPORT_PERF       0x02                  // feature: performance counters
+#define HID_REPORT_TRACE      0x03                  // feature: transaction timestamps
+#define HID_REPORT_CONFIG     0x04                  // feature: device configuration
+#define HID_REPORT_CONTROL    0x05                  // feature: controls
+#define HID_REPORT_FEATURES   0x06                  // feature: device feature bits
+
+typedef struct {
+  uint8_t buzzer;                                   // buzzer on (1) or off (0)
+  uint8_t speed;                                    // I2C clock (CFG_SPEED_...)
+  uint8_t contrast;                                 // OLED contrast (command 0x81)
+} HID_CONTROL_TYPE;
+
+extern __xdata HID_CONTROL_TYPE HID_controls;       // current controls
+extern __xdata HID_CONTROL_TYPE HID_controlBuffer;  // written controls
+extern volatile __bit HID_CONTROL_flag;             // written record not yet applied
+
+// ===================================================================================
+// HID Variables
+// ===================================================================================
+extern volatile __xdata uint8_t HID_readByteCount;  // number of data bytes in RX buffer
+extern volatile __bit HID_writeBusyFlag;            // TX buffer is being transmitted flag
+
+// ===================================================================================
+// HID Functions
+// ===================================================================================
+#define HID_init          USB_init                  // setup USB HID data
+#define HID_available()   (HID_readByteCount)       // ready to be read
+#define HID_ready()       (!HID_writeBusyFlag)      // ready to be written
+
+#if HID_DATA_FUNCTIONS > 0
+void HID_flush(void);                               // flush TX buffer
+uint8_t HID_read(void);                             // read single byte from RX buffer
+void HID_write(uint8_t c);                          // write single byte to TX buffer
+#endif
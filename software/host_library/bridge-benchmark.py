@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   USB OLED Bridge Benchmark for CH551, CH552, CH554
+# Version:   v1.0
+# Year:      2022
+# Author:    Stefan Wagner
+# Github:    https://github.com/wagiminator
+# License:   http://creativecommons.org/licenses/by-sa/3.0/
+# ===================================================================================
+#
+# Description:
+# ------------
+# Measures throughput and latency of the CDC, HID and vendor class I2C bridges:
+# - full-frame rate (1024 bytes of pixel data per frame on 128x64 panels)
+# - latency of a small command (display offset)
+# - bytes/s and transactions/s for different payload sizes
+# By default the emulated device is used, so the benchmark also runs without
+# hardware (e.g. for regression tracking). With '-b sim' the real firmware is
+# executed as host simulation and '--verify' checks the display RAM of the
+# simulated OLED after every frame. Results can be written as CSV and JSON.
+#
+# Usage examples:
+# ---------------
+# python3 bridge-benchmark.py
+# python3 bridge-benchmark.py -t vendor -b device --json result.json
+# python3 bridge-benchmark.py -s 2,16,64,256,1026 -n 50 --csv result.csv
+# python3 bridge-benchmark.py -b sim --verify
+# python3 bridge-benchmark.py -g 72x40
+#
+# Dependencies:
+# -------------
+# - pyserial / pyusb (only for real devices)
+
+import sys
+import csv
+import json
+import argparse
+from oled_bridge import open_bridge, TRANSPORTS, BACKENDS, GEOMETRIES, OLED_ADDR, OLED_DAT_MODE
+
+# Benchmark defaults
+DEFAULT_SIZES   = [2, 8, 16, 32, 64, 128, 256, 1026]  # I2C transaction sizes in bytes
+DEFAULT_FRAMES  = 20                                  # frames per full-frame test
+DEFAULT_REPEAT  = 20                                  # repetitions per payload size
+
+FIELDS = ['transport', 'backend', 'test', 'payload', 'count', 'seconds',
+          'fps', 'bytes_per_s', 'transactions_per_s',
+          'latency_mean_ms', 'latency_p50_ms', 'latency_max_ms']
+
+# ===================================================================================
+# Main Function
+# ===================================================================================
+
+def _main():
+    parser = argparse.ArgumentParser(description = 'USB OLED bridge benchmark')
+    parser.add_argument('-t', '--transport', default = ','.join(TRANSPORTS),
+                        help = 'comma separated list of transports (cdc,hid,vendor)')
+    parser.add_argument('-b', '--backend', default = 'emulator', choices = BACKENDS,
+                        help = 'run against emulated device or real hardware')
+    parser.add_argument('-g', '--geometry', default = '128x64', choices = list(GEOMETRIES),
+                        help = 'panel geometry (size of the full frame)')
+    parser.add_argument('-s', '--sizes', default = ','.join(map(str, DEFAULT_SIZES)),
+                        help = 'comma separated list of payload sizes in bytes')
+    parser.add_argument('-n', '--frames', type = int, default = DEFAULT_FRAMES,
+                        help = 'number of frames / repetitions per test')
+    parser.add_argument('--verify', action = 'store_true',
+                        help = 'check display RAM after each frame (emulator, sim)')
+    parser.add_argument('--csv', help = 'write results to CSV file')
+    parser.add_argument('--json', help = 'write results to JSON file')
+    args = parser.parse_args()
+
+    results = []
+    try:
+        for transport in args.transport.split(','):
+            print('Benchmarking', transport, 'bridge (' + args.backend + ') ...')
+            oled = open_bridge(transport, args.backend, args.geometry)
+            try:
+                if args.verify:
+                    verify(oled, args.frames)
+                rows = benchmark(oled, args.backend, args.frames,
+                                 [int(s) for s in args.sizes.split(',')])
+            finally:
+                oled.close()
+            for row in rows:
+                print(format_row(row))
+            results += rows
+    except Exception as ex:
+        sys.stderr.write('ERROR: ' + str(ex) + '!\n')
+        sys.exit(1)
+
+    if args.csv:
+        with open(args.csv, 'w', newline = '') as f:
+            writer = csv.DictWriter(f, fieldnames = FIELDS)
+            writer.writeheader()
+            writer.writerows(results)
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump(results, f, indent = 2)
+
+    print('DONE.')
+    sys.exit(0)
+
+
+# ===================================================================================
+# Benchmark Functions
+# ===================================================================================
+
+def benchmark(oled, backend, frames, sizes):
+    rows = []
+    size = oled.geometry.frame
+    rows.append(measure(oled, backend, 'frame', size + 2, frames,
+                        lambda i: oled.sendframe(testframe(i, size))))
+    rows.append(measure(oled, backend, 'command', 4, frames,
+                        lambda i: oled.scroll(i)))
+    for size in sizes:
+        if oled.max_stream is not None and size > oled.max_stream:
+            continue
+        payload = [OLED_ADDR, OLED_DAT_MODE] + [0xA5] * max(0, size - 2)
+        rows.append(measure(oled, backend, 'stream', size, frames,
+                            lambda i: oled.sendstream(payload[:size])))
+    return rows
+
+def measure(oled, backend, test, payload, count, action):
+    latencies = []
+    start = oled.clock()
+    for i in range(count):
+        t = oled.clock()
+        action(i)
+        latencies.append(oled.clock() - t)
+    oled.flush()
+    seconds = oled.clock() - start
+    transactions = count
+    if test == 'frame' and oled.max_stream is not None:
+        transactions *= -(-(payload - 2) // (oled.max_stream - 2))
+    latencies.sort()
+    return {
+        'transport':          oled.transport,
+        'backend':            backend,
+        'test':               test,
+        'payload':            payload,
+        'count':              count,
+        'seconds':            round(seconds, 6),
+        'fps':                round(count / seconds, 3) if test == 'frame' else None,
+        'bytes_per_s':        round(count * payload / seconds, 1),
+        'transactions_per_s': round(transactions / seconds, 1),
+        'latency_mean_ms':    round(1000 * sum(latencies) / count, 3),
+        'latency_p50_ms':     round(1000 * latencies[count // 2], 3),
+        'latency_max_ms':     round(1000 * latencies[-1], 3)
+    }
+
+def verify(oled, frames):
+    if oled.geometry.pageonly:
+        raise Exception('Verify does not support the SH1106 (132-column) geometry, '
+                        'the display RAM of the models has 128 columns')
+    if not hasattr(oled, 'framebuffer'):
+        raise Exception('Backend cannot read back the display RAM')
+    for i in range(frames):
+        frame = testframe(i, oled.geometry.frame)
+        oled.sendframe(frame)
+        if oled.geometry.crop(oled.framebuffer()) != bytes(frame):
+            raise Exception('Display RAM does not match frame ' + str(i))
+    print('  verify   %d frames OK' % frames)
+
+def testframe(i, size):
+    return [(0x55 if (i + x) & 1 else 0xAA) for x in range(size)]
+
+def format_row(row):
+    text = '  %-8s %6d bytes: %9.1f B/s %8.1f tx/s  latency %7.3f ms' % (
+        row['test'], row['payload'], row['bytes_per_s'],
+        row['transactions_per_s'], row['latency_mean_ms'])
+    if row['fps'] is not None:
+        text += '  %6.2f fps' % row['fps']
+    return text
+
+
+# ===================================================================================
+
+if __name__ == "__main__":
+    _main()
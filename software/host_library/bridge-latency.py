@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   USB OLED Bridge Latency Tracing for CH551, CH552, CH554
+# Version:   v1.0
+# Year:      2022
+# Author:    Stefan Wagner
+# Github:    https://github.com/wagiminator
+# License:   http://creativecommons.org/licenses/by-sa/3.0/
+# ===================================================================================
+#
+# Description:
+# ------------
+# Sends full frames to the I2C bridge and combines the host timestamps with the
+# timestamps of the firmware (src/tick.h) to a per-frame latency breakdown:
+# - host queue:       call of sendstream() until the first data packet arrives
+# - USB transfer:     first until last data packet, while the device was ready
+# - device buffering: first until last data packet, while the device was busy
+#                     (endpoint NAK, packets wait for the I2C bus)
+# - I2C clocking:     last data packet until the I2C stop condition
+# The parts add up to the end-to-end latency of each I2C transaction. The device
+# clock is mapped to the host clock with the timestamp of the request that reads
+# the device timestamps, so the host queue has an uncertainty of half the round
+# trip time of that request (column 'sync'). For the HID bridge, the breakdown of
+# all transactions (64-byte reports) of a frame is summed up.
+#
+# Usage examples:
+# ---------------
+# python3 bridge-latency.py -b sim
+# python3 bridge-latency.py -t vendor -n 50 --csv latency.csv
+#
+# Dependencies:
+# -------------
+# - pyserial / pyusb (only for real devices)
+
+import sys
+import csv
+import argparse
+from oled_bridge import open_bridge, TRANSPORTS, OLED_FRAME
+
+# Tracing defaults
+DEFAULT_FRAMES  = 20                    # number of frames per transport
+POLL_TIMEOUT    = 1.0                   # max time to wait for a transaction in s
+
+PARTS  = ['host_queue', 'usb_transfer', 'device_buffering', 'i2c_clocking', 'total']
+FIELDS = ['transport', 'frame', 'transactions'] + [p + '_ms' for p in PARTS] + ['sync_ms']
+
+# ===================================================================================
+# Main Function
+# ===================================================================================
+
+def _main():
+    parser = argparse.ArgumentParser(description = 'USB OLED bridge latency tracing')
+    parser.add_argument('-t', '--transport', default = ','.join(TRANSPORTS),
+                        help = 'comma separated list of transports (cdc,hid,vendor)')
+    parser.add_argument('-b', '--backend', default = 'device', choices = ['device', 'sim'],
+                        help = 'real hardware or simulated firmware')
+    parser.add_argument('-n', '--frames', type = int, default = DEFAULT_FRAMES,
+                        help = 'number of frames')
+    parser.add_argument('--csv', help = 'write results to CSV file')
+    args = parser.parse_args()
+
+    results = []
+    try:
+        for transport in args.transport.split(','):
+            print('Tracing', transport, 'bridge (' + args.backend + ') ...')
+            oled = open_bridge(transport, args.backend)
+            try:
+                rows = trace(oled, args.frames)
+            finally:
+                oled.close()
+            print(format_summary(rows))
+            results += rows
+    except Exception as ex:
+        sys.stderr.write('ERROR: ' + str(ex) + '!\n')
+        sys.exit(1)
+
+    if args.csv:
+        with open(args.csv, 'w', newline = '') as f:
+            writer = csv.DictWriter(f, fieldnames = FIELDS)
+            writer.writeheader()
+            writer.writerows(results)
+
+    print('DONE.')
+    sys.exit(0)
+
+
+# ===================================================================================
+# Tracing Functions
+# ===================================================================================
+
+def trace(oled, frames):
+    rows  = []
+    count = oled.timestamps()['count']
+    for i in range(frames):
+        data  = [(x * 7 + i) & 0xFF for x in range(OLED_FRAME)]
+        parts = dict.fromkeys(PARTS, 0.0)
+        sync  = 0.0
+        streams = oled.datastreams(data)
+        for stream in streams:
+            submit = oled.clock()
+            oled.sendstream(stream)
+            ts, host_now, rtt = wait(oled, count)
+            count = ts['count']
+            for part, value in breakdown(ts, submit, host_now).items():
+                parts[part] += value
+            sync = max(sync, rtt / 2)
+        row = {'transport': oled.transport, 'frame': i, 'transactions': len(streams),
+               'sync_ms': round(1000 * sync, 3)}
+        for part in PARTS:
+            row[part + '_ms'] = round(1000 * parts[part], 3)
+        rows.append(row)
+    return rows
+
+# Read device timestamps until the next transaction is completed
+def wait(oled, count):
+    start = oled.clock()
+    while True:
+        t0 = oled.clock()
+        ts = oled.timestamps()
+        t1 = oled.clock()
+        if ts['count'] != count:
+            return ts, (t0 + t1) / 2, t1 - t0
+        if t1 - start > POLL_TIMEOUT:
+            raise Exception('Transaction not completed')
+
+# Split transaction into the latency parts (in s, host clock)
+def breakdown(ts, submit, host_now):
+    clock = ts['clock']
+    age   = lambda stamp: ((ts['now'] - stamp) & 0xFFFFFFFF) / clock
+    span  = lambda a, b: ((ts[b] - ts[a]) & 0xFFFFFFFF) / clock
+    first = host_now - age(ts['rx_first'])
+    stall = ts['stall'] / clock
+    return {
+        'host_queue':       first - submit,
+        'usb_transfer':     span('rx_first', 'rx_last') - stall,
+        'device_buffering': stall,
+        'i2c_clocking':     span('rx_last', 'i2c_stop'),
+        'total':            host_now - age(ts['i2c_stop']) - submit
+    }
+
+def format_summary(rows):
+    lines = ['  %-18s %10s %10s %10s' % ('part', 'mean ms', 'p50 ms', 'max ms')]
+    for part in PARTS:
+        values = sorted(row[part + '_ms'] for row in rows)
+        lines.append('  %-18s %10.3f %10.3f %10.3f' % (part, sum(values) / len(values),
+                     values[len(values) // 2], values[-1]))
+    return '\n'.join(lines)
+
+
+# ===================================================================================
+
+if __name__ == "__main__":
+    _main()
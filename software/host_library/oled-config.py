@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   USB OLED Device Configuration for CH551, CH552, CH554
+# Version:   v1.0
+# Year:      2022
+# Author:    Stefan Wagner
+# Github:    https://github.com/wagiminator
+# License:   http://creativecommons.org/licenses/by-sa/3.0/
+# ===================================================================================
+#
+# Description:
+# ------------
+# Shows and changes the device configuration stored in the DataFlash of the I2C
+# bridge (src/devcfg.h): I2C address and speed of the OLED, its init sequence, the
+# power-up mode and the boot splash. Options that are not given keep their current
+# value. The new configuration is used from the next power-up on. The OLED terminal
+# firmware has the same USB IDs as the CDC bridge and is configured with '-t cdc'.
+#
+# Usage examples:
+# ---------------
+# python3 oled-config.py -t vendor
+# python3 oled-config.py -t hid --mode init,clear --init default
+# python3 oled-config.py -t cdc --speed slow --splash none
+# python3 oled-config.py -t vendor --mode init --init 128x32
+#
+# Dependencies:
+# -------------
+# - pyusb
+
+import sys
+import argparse
+from oled_bridge import open_bridge, TRANSPORTS, OLED_INIT_CMD, OLED_INIT_CMD_32
+from oled_bridge import CFG_SPEED_FAST, CFG_SPEED_SLOW, CFG_MODE_INIT, CFG_MODE_CLEAR
+from oled_bridge import CFG_MODE_SUSPEND, CFG_SPLASH_NONE, CFG_SPLASH_TEXT, CFG_SPLASH_FRAME
+
+SPEEDS  = {'fast': CFG_SPEED_FAST, 'slow': CFG_SPEED_SLOW}
+MODES   = {'init': CFG_MODE_INIT, 'clear': CFG_MODE_CLEAR, 'suspend': CFG_MODE_SUSPEND}
+SPLASHS = {'none': CFG_SPLASH_NONE, 'text': CFG_SPLASH_TEXT, 'frame': CFG_SPLASH_FRAME}
+INITS   = {'default': OLED_INIT_CMD, '128x32': OLED_INIT_CMD_32}
+STORE_TIME = 0.2                        # time to store the configuration in s
+
+# ===================================================================================
+# Main Function
+# ===================================================================================
+
+def _main():
+    parser = argparse.ArgumentParser(description = 'USB OLED device configuration')
+    parser.add_argument('-t', '--transport', default = 'vendor', choices = list(TRANSPORTS),
+                        help = 'transport of the bridge')
+    parser.add_argument('-b', '--backend', default = 'device', choices = ['device', 'sim'],
+                        help = 'real hardware or simulated firmware')
+    parser.add_argument('--addr', type = lambda x: int(x, 0),
+                        help = 'I2C write address of the OLED (e.g. 0x78)')
+    parser.add_argument('--speed', choices = list(SPEEDS),
+                        help = 'I2C clock (fast ~500kHz, slow ~100kHz)')
+    parser.add_argument('--mode', help = 'power-up mode: comma separated list of '
+                        + ','.join(MODES) + ' or none')
+    parser.add_argument('--splash', choices = list(SPLASHS),
+                        help = 'boot splash (text: start message of the terminal, '
+                        + 'frame: splash frame of the bridges, see oled-frames.py)')
+    parser.add_argument('--init', help = 'init sequence: comma separated command bytes, '
+                        + 'default or 128x32 (the ones of the host library)')
+    args = parser.parse_args()
+
+    try:
+        oled = open_bridge(args.transport, args.backend, setup = False)
+        try:
+            config = oled.readconfig()
+            changed = update(config, args)
+            if changed:
+                oled.writeconfig(config)
+                oled.sleep(STORE_TIME)              # device writes the DataFlash
+                if oled.readconfig() != config:
+                    raise Exception('Configuration was not stored')
+        finally:
+            oled.close()
+    except Exception as ex:
+        sys.stderr.write('ERROR: ' + str(ex) + '!\n')
+        sys.exit(1)
+
+    print(format_config(config))
+    print('Written, used from the next power-up on.' if changed else 'DONE.')
+    sys.exit(0)
+
+
+# ===================================================================================
+# Configuration Functions
+# ===================================================================================
+
+# Apply the command line options, returns True if the configuration was changed
+def update(config, args):
+    old = dict(config)
+    if args.addr is not None:
+        config['addr'] = args.addr & 0xFE
+    if args.speed:
+        config['speed'] = SPEEDS[args.speed]
+    if args.mode:
+        config['mode'] = 0
+        for mode in args.mode.split(','):
+            if mode != 'none':
+                config['mode'] |= MODES[mode]
+    if args.splash:
+        config['splash'] = SPLASHS[args.splash]
+    if args.init:
+        if args.init in INITS:
+            config['init'] = list(INITS[args.init])
+        else:
+            config['init'] = [int(x, 16) & 0xFF for x in args.init.split(',')]
+    return config != old
+
+def format_config(config):
+    name  = lambda table, value: next((k for k, v in table.items() if v == value), str(value))
+    modes = [k for k, v in MODES.items() if config['mode'] & v] or ['none']
+    return '\n'.join([
+        '  address:  0x%02X' % config['addr'],
+        '  speed:    ' + name(SPEEDS, config['speed']),
+        '  mode:     ' + ','.join(modes),
+        '  splash:   ' + name(SPLASHS, config['splash']),
+        '  init:     ' + ','.join('%02X' % b for b in config['init'])
+    ])
+
+
+# ===================================================================================
+
+if __name__ == "__main__":
+    _main()
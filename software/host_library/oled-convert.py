@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   USB OLED Bitmap Converter for CH551, CH552, CH554
+# Version:   v1.0
+# Year:      2022
+# Author:    Stefan Wagner
+# Github:    https://github.com/wagiminator
+# License:   http://creativecommons.org/licenses/by-sa/3.0/
+# ===================================================================================
+#
+# Description:
+# ------------
+# Converts images (PNG, PBM, GIF, BMP, ... everything Pillow reads) into the byte
+# order of the SSD1306 display RAM, without any online converter: as Python list
+# (like PIC1 of the bridge demos), as C __code array for the firmware or as raw file
+# (e.g. for oled-frames.py). The image is scaled to the given size, by default with
+# a plain threshold, optionally dithered (see oled_image.py). Results are cached
+# (key: file content and options), so repeated asset builds are instant.
+#
+# Usage examples:
+# ---------------
+# python3 oled-convert.py logo.png -n PIC1
+# python3 oled-convert.py -f c -d floyd -o pictures.h logo.png photo.jpg
+# python3 oled-convert.py -f raw -s 128x64 -o splash.bin splash.pbm
+#
+# Dependencies:
+# -------------
+# - numpy, pillow
+
+import os
+import re
+import sys
+import argparse
+from oled_image import convertimage, formatpython, formatc, DITHERS, CONVERT_CACHE
+
+FORMATS = ['py', 'c', 'raw']
+
+# ===================================================================================
+# Main Function
+# ===================================================================================
+
+def _main():
+    parser = argparse.ArgumentParser(description = 'USB OLED bitmap converter')
+    parser.add_argument('files', nargs = '+', help = 'image files')
+    parser.add_argument('-f', '--format', default = 'py', choices = FORMATS,
+                        help = 'Python list, C array or raw bytes')
+    parser.add_argument('-o', '--output', help = 'output file (default: stdout)')
+    parser.add_argument('-n', '--name', help = 'name of the array (default: file name, '
+                        + 'numbered for several files)')
+    parser.add_argument('-s', '--size', default = '128x64',
+                        help = 'size in pixels (height a multiple of 8)')
+    parser.add_argument('-d', '--dither', default = 'threshold', choices = DITHERS,
+                        help = 'dither method')
+    parser.add_argument('--level', type = int, default = 128,
+                        help = 'threshold level 0 - 255 (brightness)')
+    parser.add_argument('--invert', action = 'store_true', help = 'invert the image')
+    parser.add_argument('--stretch', action = 'store_true',
+                        help = 'stretch to the size instead of keeping the aspect ratio')
+    parser.add_argument('--cache', default = CONVERT_CACHE, help = 'cache directory')
+    parser.add_argument('--no-cache', action = 'store_true', help = 'do not use the cache')
+    args = parser.parse_args()
+
+    try:
+        width, height = [int(x) for x in args.size.lower().split('x')]
+        if height % 8:
+            raise Exception('Height must be a multiple of 8')
+        if args.format == 'raw' and not args.output:
+            raise Exception('Raw format needs an output file')
+        output = b'' if args.format == 'raw' else ''
+        for i, filename in enumerate(args.files):
+            data = convertimage(filename, width, height, args.dither, args.level,
+                                args.invert, not args.stretch,
+                                None if args.no_cache else args.cache)
+            if args.format == 'raw':
+                output += data
+                continue
+            comment = '%dx%d pixels, %s (%s)' % (width, height,
+                                                 os.path.basename(filename), args.dither)
+            name = arrayname(args.name, filename, i, len(args.files))
+            text = (formatpython if args.format == 'py' else formatc)(name, data, comment)
+            output += ('\n' if i else '') + text
+        if not args.output:
+            sys.stdout.write(output)
+            return
+        with open(args.output, 'wb' if args.format == 'raw' else 'w') as f:
+            f.write(output)
+    except Exception as ex:
+        sys.stderr.write('ERROR: ' + str(ex) + '!\n')
+        sys.exit(1)
+
+    sys.stderr.write('DONE.\n')
+    sys.exit(0)
+
+
+# ===================================================================================
+# Helper Functions
+# ===================================================================================
+
+# Name of the array: given name (numbered for several files) or from the file name
+def arrayname(name, filename, index, count):
+    if name:
+        return name + str(index + 1) if count > 1 else name
+    name = re.sub(r'\W', '_', os.path.splitext(os.path.basename(filename))[0]).upper()
+    return name if re.match(r'[A-Z_]', name) else 'PIC_' + name
+
+
+# ===================================================================================
+
+if __name__ == "__main__":
+    _main()
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   USB OLED Frame Store for CH551, CH552, CH554
+# Version:   v1.0
+# Year:      2022
+# Author:    Stefan Wagner
+# Github:    https://github.com/wagiminator
+# License:   http://creativecommons.org/licenses/by-sa/3.0/
+# ===================================================================================
+#
+# Description:
+# ------------
+# Writes the splash frame and the suspend frame to the frame store in the code flash
+# of the I2C bridge (src/frames.h) and enables them in the device configuration: the
+# splash frame is shown at power-up, the suspend frame when the host suspends the
+# bus or is disconnected. Frames are either raw files with 1024 bytes in the byte
+# order of the SSD1306 display RAM or 128x64 pixels binary PBM images (P4, set
+# pixels are lit). The frames have to be written again after a firmware upload.
+#
+# Usage examples:
+# ---------------
+# python3 oled-frames.py -t vendor --splash logo.pbm --suspend offline.pbm
+# python3 oled-frames.py -t hid --show 1
+# python3 oled-frames.py -t cdc --disable
+#
+# Dependencies:
+# -------------
+# - pyusb
+
+import sys
+import argparse
+from oled_bridge import open_bridge, TRANSPORTS, OLED_WIDTH, OLED_HEIGHT, OLED_FRAME
+from oled_bridge import FRAME_COUNT, FRAME_SPLASH, FRAME_SUSPEND, FRAME_BLANK
+from oled_bridge import CFG_MODE_SUSPEND, CFG_SPLASH_NONE, CFG_SPLASH_FRAME
+
+STORE_TIME = 0.2                        # time to store the last chunk in s
+
+# ===================================================================================
+# Main Function
+# ===================================================================================
+
+def _main():
+    parser = argparse.ArgumentParser(description = 'USB OLED frame store')
+    parser.add_argument('-t', '--transport', default = 'vendor', choices = list(TRANSPORTS),
+                        help = 'transport of the bridge')
+    parser.add_argument('-b', '--backend', default = 'device', choices = ['device', 'sim'],
+                        help = 'real hardware or simulated firmware')
+    parser.add_argument('--splash', help = 'splash frame file (raw or PBM)')
+    parser.add_argument('--suspend', help = 'suspend frame file (raw or PBM)')
+    parser.add_argument('--show', help = 'show frame (0: splash, 1: suspend, blank)')
+    parser.add_argument('--disable', action = 'store_true',
+                        help = 'do not show the frames at power-up and on suspend')
+    args = parser.parse_args()
+
+    try:
+        oled = open_bridge(args.transport, args.backend)
+        try:
+            config = oled.readconfig()
+            if args.splash:
+                oled.writeframe(FRAME_SPLASH, loadframe(args.splash))
+                config['splash'] = CFG_SPLASH_FRAME
+                print('Splash frame written.')
+            if args.suspend:
+                oled.writeframe(FRAME_SUSPEND, loadframe(args.suspend))
+                config['mode'] |= CFG_MODE_SUSPEND
+                print('Suspend frame written.')
+            if args.disable:
+                config['mode'] &= ~CFG_MODE_SUSPEND
+                if config['splash'] == CFG_SPLASH_FRAME:
+                    config['splash'] = CFG_SPLASH_NONE
+            if args.splash or args.suspend or args.disable:
+                oled.writeconfig(config)
+                oled.sleep(STORE_TIME)              # device writes the flash
+            if args.show:
+                frame = FRAME_BLANK if args.show == 'blank' else int(args.show)
+                if frame != FRAME_BLANK and not 0 <= frame < FRAME_COUNT:
+                    raise Exception('Invalid frame number')
+                oled.showframe(frame)
+        finally:
+            oled.close()
+    except Exception as ex:
+        sys.stderr.write('ERROR: ' + str(ex) + '!\n')
+        sys.exit(1)
+
+    print('DONE.')
+    sys.exit(0)
+
+
+# ===================================================================================
+# Frame Files
+# ===================================================================================
+
+# Load raw frame or PBM image (P4) and return it in display RAM byte order
+def loadframe(filename):
+    with open(filename, 'rb') as f:
+        data = f.read()
+    if not data.startswith(b'P4'):
+        if len(data) != OLED_FRAME:
+            raise Exception('Raw frame must have %d bytes' % OLED_FRAME)
+        return data
+    fields = []
+    pos = 2
+    while len(fields) < 2:                          # width and height, skip comments
+        while data[pos:pos+1].isspace():
+            pos += 1
+        if data[pos:pos+1] == b'#':
+            pos = data.index(b'\n', pos)
+            continue
+        start = pos
+        while not data[pos:pos+1].isspace():
+            pos += 1
+        fields.append(int(data[start:pos]))
+    if fields != [OLED_WIDTH, OLED_HEIGHT]:
+        raise Exception('Image must have %dx%d pixels' % (OLED_WIDTH, OLED_HEIGHT))
+    bits  = data[pos+1:]
+    row   = OLED_WIDTH // 8
+    frame = bytearray(OLED_FRAME)
+    for y in range(OLED_HEIGHT):
+        for x in range(OLED_WIDTH):
+            if bits[y * row + x // 8] >> (7 - x % 8) & 1:
+                frame[(y // 8) * OLED_WIDTH + x] |= 1 << (y % 8)
+    return bytes(frame)
+
+
+# ===================================================================================
+
+if __name__ == "__main__":
+    _main()
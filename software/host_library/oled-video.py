@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   USB OLED Video Player for CH551, CH552, CH554
+# Version:   v1.0
+# Year:      2022
+# Author:    Stefan Wagner
+# Github:    https://github.com/wagiminator
+# License:   http://creativecommons.org/licenses/by-sa/3.0/
+# ===================================================================================
+#
+# Description:
+# ------------
+# Plays animated GIFs and image sequences on the OLED via any of the I2C bridges.
+# The frames are decoded, scaled to the panel and dithered (Floyd-Steinberg, ordered
+# 8x8 Bayer, blue noise or plain threshold) on the host before playback starts
+# (see oled_image.py), so the playback loop only sends data: each frame in the
+# encoding that is the fastest for the bridge (full frame, window or spans around
+# the changes, see oled_encoder.py), paced by the frame durations of the file or by
+# --fps. Frames are skipped if the bridge cannot keep up. At the end the achieved
+# frame rate, the encodings used and the CPU time of the host are printed.
+#
+# Usage examples:
+# ---------------
+# python3 oled-video.py -t vendor animation.gif
+# python3 oled-video.py -t hid -d ordered --fps 30 --loop 0 frames/*.png
+# python3 oled-video.py -b emulator -d bluenoise -g 128x32 animation.gif
+#
+# Dependencies:
+# -------------
+# - numpy, pillow
+# - pyserial / pyusb (only for real devices)
+
+import sys
+import time
+import argparse
+from oled_bridge import open_bridge, TRANSPORTS, BACKENDS, GEOMETRIES
+from oled_image import loadframes, dither, packpages, VideoStream, DITHERS
+
+# ===================================================================================
+# Main Function
+# ===================================================================================
+
+def _main():
+    parser = argparse.ArgumentParser(description = 'USB OLED video player')
+    parser.add_argument('files', nargs = '+', help = 'GIF or image files (in this order)')
+    parser.add_argument('-t', '--transport', default = 'vendor', choices = list(TRANSPORTS),
+                        help = 'transport of the bridge')
+    parser.add_argument('-b', '--backend', default = 'device', choices = BACKENDS,
+                        help = 'real hardware, emulated device or simulated firmware')
+    parser.add_argument('-g', '--geometry', default = '128x64', choices = list(GEOMETRIES),
+                        help = 'panel geometry (size of the frames)')
+    parser.add_argument('-d', '--dither', default = 'floyd', choices = DITHERS,
+                        help = 'dither method')
+    parser.add_argument('--level', type = int, default = 128,
+                        help = 'threshold level 0 - 255 (brightness)')
+    parser.add_argument('--invert', action = 'store_true', help = 'invert the frames')
+    parser.add_argument('--stretch', action = 'store_true',
+                        help = 'stretch to the panel instead of keeping the aspect ratio')
+    parser.add_argument('--fps', type = float,
+                        help = 'frame rate (default: frame durations of the file)')
+    parser.add_argument('--loop', type = int, default = 1,
+                        help = 'number of times to play (0: endless)')
+    args = parser.parse_args()
+
+    try:
+        geometry = GEOMETRIES[args.geometry]
+        print('Decoding and dithering ...')
+        cpu    = time.process_time()
+        frames = prepare(args, geometry.width, geometry.height)
+        print('  %d frames in %.2f s' % (len(frames), time.process_time() - cpu))
+        oled   = open_bridge(args.transport, args.backend, args.geometry)
+        stream = VideoStream(oled)
+        try:
+            print('Playing (Ctrl+C to stop) ...')
+            play(stream, frames, args.loop)
+        finally:
+            stream.close()
+            oled.close()
+    except KeyboardInterrupt:
+        pass
+    except Exception as ex:
+        sys.stderr.write('ERROR: ' + str(ex) + '!\n')
+        sys.exit(1)
+
+    print('DONE.')
+    sys.exit(0)
+
+
+# ===================================================================================
+# Player Functions
+# ===================================================================================
+
+# Frames in display RAM byte order with their durations
+def prepare(args, width, height):
+    frames = []
+    for gray, duration in loadframes(args.files, width, height, not args.stretch):
+        if args.invert:
+            gray = 255 - gray
+        frame = packpages(dither(gray, args.dither, args.level))
+        frames.append((frame, 1 / args.fps if args.fps else duration))
+    if not frames:
+        raise Exception('No frames found')
+    return frames
+
+def play(stream, frames, loop):
+    clock = stream.bridge.clock
+    start = clock()
+    cpu   = time.process_time()
+    count = 0
+    try:
+        while not loop or count < loop:
+            for frame, duration in frames:
+                stream.show(frame, duration)
+            count += 1
+    finally:
+        seconds = clock() - start
+        cpu     = time.process_time() - cpu
+        shown   = stream.frames
+        print('  %d frames shown, %d skipped' % (shown, stream.skipped))
+        print('  encodings: ' + ', '.join('%s %d' % item for item in
+                                          stream.encoder.stats.items() if item[1]))
+        if seconds > 0:
+            print('  %.2f fps, host CPU %.1f%%' % (shown / seconds, 100 * cpu / seconds))
+
+
+# ===================================================================================
+
+if __name__ == "__main__":
+    _main()
@@ -0,0 +1,236 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   USB OLED Protocol Analyzer for CH551, CH552, CH554
+# Version:   v1.0
+# Year:      2022
+# Author:    Stefan Wagner
+# Github:    https://github.com/wagiminator
+# License:   http://creativecommons.org/licenses/by-sa/3.0/
+# ===================================================================================
+#
+# Description:
+# ------------
+# Decodes the I2C traffic to the SSD1306 and shows where the bus bytes go: address
+# and control bytes, addressing commands (column, page, window, memory mode), other
+# commands and pixel data. The display RAM is rebuilt on the way (SSD1306 model of
+# oled_emulator.py), so that data bytes which write the value a RAM cell already
+# holds are counted as redundant. The bus time is computed for a given SCL clock
+# (9 clocks per byte, one each for START and STOP).
+#
+# Input is a recording of oled_record.py or the transaction log of the firmware
+# simulation (SIM_I2C_LOG, see software/simulator), e.g. of the terminal firmware.
+# A frame ends when a pixel data write wraps the address pointer back to the start
+# of the window (horizontal or vertical addressing mode) or, for recordings, when
+# the bus is idle for longer than --gap.
+#
+# Usage examples:
+# ---------------
+# OLED_RECORD=video.rec python3 oled-video.py -b sim animation.gif
+# python3 oled_analyze.py video.rec
+# SIM_I2C_LOG=term.log python3 oled_sim.py "Hello World!"
+# python3 oled_analyze.py --scl 100000 term.log
+
+import sys
+import json
+import argparse
+from oled_bridge import OLED_ADDR, OLED_WIDTH, OLED_PAGES
+from oled_emulator import SSD1306
+from oled_record import readrecording, REC_MAGIC, REC_STREAM
+
+ANALYZE_SCL = 400000        # default I2C clock in Hz
+ANALYZE_GAP = 0.005         # idle time in s that ends a frame (recordings)
+
+# SSD1306 commands (names as in oled_term.c of the terminal firmware)
+SSD1306_NAMES = {
+    0x20: 'MEMORYMODE', 0x21: 'COLUMNS', 0x22: 'PAGES', 0x26: 'SCROLL_RIGHT',
+    0x27: 'SCROLL_LEFT', 0x29: 'SCROLL_VRIGHT', 0x2A: 'SCROLL_VLEFT',
+    0x2E: 'SCROLL_OFF', 0x2F: 'SCROLL_ON', 0x81: 'CONTRAST', 0x8D: 'CHARGEPUMP',
+    0xA0: 'XFLIP_OFF', 0xA1: 'XFLIP', 0xA3: 'SCROLL_AREA', 0xA4: 'RESUME_RAM',
+    0xA5: 'ENTIRE_ON', 0xA6: 'INVERT_OFF', 0xA7: 'INVERT', 0xA8: 'MULTIPLEX',
+    0xAE: 'DISPLAY_OFF', 0xAF: 'DISPLAY_ON', 0xC0: 'YFLIP_OFF', 0xC8: 'YFLIP',
+    0xD3: 'OFFSET', 0xD5: 'CLOCKDIV', 0xD9: 'PRECHARGE', 0xDA: 'COMPINS',
+    0xDB: 'VCOMDETECT'
+}
+SSD1306_ADDRESSING = {'COLUMN_LOW', 'COLUMN_HIGH', 'MEMORYMODE', 'COLUMNS', 'PAGES',
+                      'PAGE'}
+
+def commandname(c):
+    if c <= 0x0F:        return 'COLUMN_LOW'
+    if c <= 0x1F:        return 'COLUMN_HIGH'
+    if 0x40 <= c <= 0x7F: return 'STARTLINE'
+    if 0xB0 <= c <= 0xB7: return 'PAGE'
+    return SSD1306_NAMES.get(c, 'UNKNOWN_%02X' % c)
+
+
+# ===================================================================================
+# Input Files
+# ===================================================================================
+
+# Transactions of a recording or simulation log: list of (time in s or None, stream)
+def readtransactions(filename):
+    with open(filename, 'rb') as f:
+        data = f.read()
+    if data.startswith(REC_MAGIC):
+        return [(time, args[0]) for time, kind, args in readrecording(filename)['records']
+                if kind == REC_STREAM]
+    transactions = []                   # SIM_I2C_LOG: length (16 bits) and bytes
+    pos = 0
+    while pos + 2 <= len(data):
+        length = data[pos] | data[pos + 1] << 8
+        transactions.append((None, data[pos + 2:pos + 2 + length]))
+        pos += 2 + length
+    if pos != len(data):
+        raise Exception('Simulation log is truncated')
+    return transactions
+
+
+# ===================================================================================
+# Analyzer
+# ===================================================================================
+
+# SSD1306 model that counts the bytes it receives
+class _AnalyzedSSD1306(SSD1306):
+    def __init__(self, address):
+        super().__init__(address)
+        self.counts   = {'address': 0, 'control': 0, 'addressing': 0, 'commands': 0,
+                         'data': 0, 'redundant': 0}
+        self.names    = {}              # command name: [count, bytes]
+        self.pages    = [[0, 0] for _ in range(OLED_PAGES)]   # data, redundant per page
+        self.wrapped  = False           # address pointer back at the window start
+
+    def transaction(self, stream):
+        if not super().transaction(stream):
+            return False
+        self.counts['address'] += 1
+        i = 1                           # count the control bytes (see transaction())
+        while i < len(stream):
+            self.counts['control'] += 1
+            if not stream[i] & 0x80:
+                break
+            i += 2
+        return True
+
+    def _write(self, b):
+        cell = self.page * OLED_WIDTH + self.col
+        self.counts['data'] += 1
+        self.pages[self.page][0] += 1
+        if self.gddram[cell] == b:
+            self.counts['redundant'] += 1
+            self.pages[self.page][1] += 1
+        super()._write(b)
+        if self.mode < 2 and (self.page, self.col) == (self.page_lo, self.col_lo):
+            self.wrapped = True
+
+    def _command(self, b):
+        pending = self.cmd + [b]
+        super()._command(b)
+        if self.cmd:
+            return                      # argument bytes still missing
+        name = commandname(pending[0])
+        self.counts['addressing' if name in SSD1306_ADDRESSING else 'commands'] += \
+            len(pending)
+        entry = self.names.setdefault(name, [0, 0])
+        entry[0] += 1
+        entry[1] += len(pending)
+
+# Analyze transactions (list of (time or None, stream)), returns dict of results
+def analyze(transactions, scl = ANALYZE_SCL, gap = ANALYZE_GAP, address = OLED_ADDR):
+    oled   = _AnalyzedSSD1306(address)
+    frames = []                         # bus bytes and bus time per frame
+    frame  = [0, 0.0]
+    total  = [0, 0.0]
+    other  = 0                          # transactions to other addresses
+    last   = None
+    for time, stream in transactions:
+        if time is not None and last is not None and time - last > gap and frame[0]:
+            frames.append(frame)
+            frame = [0, 0.0]
+        last = time
+        if not oled.transaction(list(stream)):
+            other += 1
+        bustime   = (2 + 9 * len(stream)) / scl
+        frame[0] += len(stream)
+        frame[1] += bustime
+        total[0] += len(stream)
+        total[1] += bustime
+        if oled.wrapped:
+            frames.append(frame)
+            frame, oled.wrapped = [0, 0.0], False
+    if frame[0]:
+        frames.append(frame)
+    counts  = oled.counts
+    command = counts['addressing'] + counts['commands']
+    return {
+        'transactions': len(transactions), 'other_address': other, 'bytes': total[0],
+        'bus_time': total[1], 'scl': scl, 'counts': counts,
+        'command_data_ratio': command / counts['data'] if counts['data'] else None,
+        'commands': {name: {'count': c, 'bytes': b} for name, (c, b) in
+                     sorted(oled.names.items(), key = lambda x: -x[1][1])},
+        'pages': [{'data': d, 'redundant': r} for d, r in oled.pages],
+        'frames': len(frames),
+        'frame_bytes': sum(f[0] for f in frames) / len(frames) if frames else 0,
+        'frame_time': sum(f[1] for f in frames) / len(frames) if frames else 0,
+        'frame_time_max': max(f[1] for f in frames) if frames else 0,
+        'gddram': bytes(oled.gddram)
+    }
+
+
+# ===================================================================================
+# Main Function
+# ===================================================================================
+
+def _main():
+    parser = argparse.ArgumentParser(description = 'USB OLED protocol analyzer')
+    parser.add_argument('file', help = 'recording (oled_record.py) or SIM_I2C_LOG file')
+    parser.add_argument('--scl', type = int, default = ANALYZE_SCL,
+                        help = 'I2C clock in Hz for the bus time')
+    parser.add_argument('--gap', type = float, default = ANALYZE_GAP * 1000,
+                        help = 'idle time in ms that ends a frame (recordings)')
+    parser.add_argument('--json', help = 'write the results to a JSON file')
+    args = parser.parse_args()
+
+    try:
+        result = analyze(readtransactions(args.file), args.scl, args.gap / 1000)
+        report(args.file, result)
+        if args.json:
+            with open(args.json, 'w') as f:
+                json.dump(dict(result, gddram = result['gddram'].hex()), f, indent = 2)
+    except Exception as ex:
+        sys.stderr.write('ERROR: ' + str(ex) + '!\n')
+        sys.exit(1)
+
+    print('DONE.')
+    sys.exit(0)
+
+def report(filename, result):
+    counts = result['counts']
+    total  = result['bytes'] or 1
+    print('%s: %d transactions, %d bytes, %.2f ms bus time at %d kHz' %
+          (filename, result['transactions'], result['bytes'], result['bus_time'] * 1000,
+           result['scl'] // 1000))
+    if result['other_address']:
+        print('  %d transactions to other addresses' % result['other_address'])
+    print('Bytes on the bus:')
+    for key, text in (('address', 'address bytes'), ('control', 'control bytes'),
+                      ('addressing', 'addressing commands'), ('commands', 'other commands'),
+                      ('data', 'pixel data')):
+        print('  %-22s %8d  %5.1f%%' % (text, counts[key], 100 * counts[key] / total))
+    if counts['data']:
+        print('  %-22s %8d  %5.1f%% of the pixel data' % ('redundant pixel data',
+              counts['redundant'], 100 * counts['redundant'] / counts['data']))
+        print('  command/data ratio     %8.3f' % result['command_data_ratio'])
+    print('Commands:')
+    for name, entry in result['commands'].items():
+        print('  %-22s %8d  %8d bytes' % (name, entry['count'], entry['bytes']))
+    print('Pixel data per page (redundant):')
+    print('  ' + '  '.join('%d: %d (%d)' % (page, p['data'], p['redundant'])
+                           for page, p in enumerate(result['pages'])))
+    print('Frames: %d, %.0f bytes and %.2f ms bus time per frame (max %.2f ms)' %
+          (result['frames'], result['frame_bytes'], result['frame_time'] * 1000,
+           result['frame_time_max'] * 1000))
+
+
+# ===================================================================================
+
+if __name__ == "__main__":
+    _main()
@@ -0,0 +1,1125 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   USB OLED Host Library for CH551, CH552, CH554
+# Version:   v1.0
+# Year:      2022
+# Author:    Stefan Wagner
+# Github:    https://github.com/wagiminator
+# License:   http://creativecommons.org/licenses/by-sa/3.0/
+# ===================================================================================
+#
+# Description:
+# ------------
+# Common host-side implementation of the three I2C bridge firmwares (CDC, HID and
+# vendor class). All bridges share the same interface, so that tools can drive any
+# of them (or the emulated device in oled_emulator.py, or the simulated firmware in
+# oled_sim.py) without knowing which transport is actually used. On Linux, the HID
+# bridge can also be driven via its hidraw device node (backend 'hidraw'), which
+# needs neither pyusb nor the detach of the kernel driver.
+#
+# Usage example:
+# --------------
+# from oled_bridge import open_bridge
+# oled = open_bridge('vendor')
+# oled.senddata([0x55] * 1024)
+# oled.close()
+#
+# Dependencies:
+# -------------
+# - pyserial (CDC bridge)
+# - pyusb    (HID and vendor class bridge, not for the hidraw backend)
+
+import os
+import time
+import struct
+import select
+
+# ===================================================================================
+# Device Settings
+# ===================================================================================
+
+# USB device settings
+VENDOR_ID       = 0x16C0    # VID (shared www.voti.nl)
+CDC_PRODUCT_ID  = 0x27DD    # PID CDC bridge
+HID_PRODUCT_ID  = 0x05DF    # PID HID bridge
+VEN_PRODUCT_ID  = 0x05DC    # PID vendor class bridge
+
+# HID bridge settings
+HID_PACKET_SIZE = 64        # HID packet size
+HID_REPORT_SIZE = HID_PACKET_SIZE - 1   # bytes per output report (after the report ID)
+HID_INTERFACE   = 0         # HID interface number
+HID_EP_OUT      = 0x01      # endpoint for data transfer
+HID_REPORT_DATA = 0x01      # report IDs (see src/usb_hid_data.h of the firmware)
+HID_REPORT_PERF = 0x02
+HID_REPORT_TRACE = 0x03
+HID_REPORT_CONFIG = 0x04
+HID_REPORT_CONTROL = 0x05
+HID_REPORT_FEATURES = 0x06
+
+# hidraw backend settings (Linux, HID bridge without pyusb, see HidrawBridge)
+HIDRAW_QUEUE    = 32        # output reports queued for the writer thread
+HIDRAW_TIMEOUT  = 1.0       # max time in s to wait until the device accepts a report
+HIDIOCSFEATURE  = 0x06      # ioctl numbers of linux/hidraw.h ('H', read/write, length)
+HIDIOCGFEATURE  = 0x07
+
+def hidraw_ioctl(nr, length):
+    return 3 << 30 | length << 16 | ord('H') << 8 | nr
+
+# Vendor class bridge settings
+BULK_EP_OUT     = 0x01      # (bEndpointAddress) for bulk writing to device
+BULK_EP_IN      = 0x81      # (bEndpointAddress) for bulk reading from device
+BULK_TIMEOUT    = 100       # bulk transfer timeout in ms
+VEN_CLASS       = 0xFF      # (bInterfaceClass) of the vendor interface
+COMPOSITE_CLASS = 0xEF      # (bDeviceClass) of the composite terminal (CDC + vendor)
+
+# USB port path of a pyusb device ('bus-port.port...', like the location of pyserial)
+def usbpath(dev):
+    return '%d-%s' % (dev.bus, '.'.join(str(p) for p in (dev.port_numbers or [])))
+
+# USB vendor class control requests (bRequest)
+VEN_REQ_BOOTLOADER  = 1     # enter bootloader
+VEN_REQ_BUZZER_ON   = 2     # turn on buzzer
+VEN_REQ_BUZZER_OFF  = 3     # turn off buzzer
+VEN_REQ_I2C_START   = 4     # set start condition on I2C bus
+VEN_REQ_I2C_STOP    = 5     # set stop condition on I2C bus
+VEN_REQ_GET_PERF    = 6     # read performance counters
+VEN_REQ_GET_TRACE   = 7     # read transaction timestamps
+VEN_REQ_GET_CONFIG  = 8     # read device configuration
+VEN_REQ_SET_CONFIG  = 9     # write device configuration
+VEN_REQ_WRITE_FRAME = 10    # write frame store chunk (all bridges)
+VEN_REQ_SHOW_FRAME  = 11    # show frame of frame store (all bridges)
+VEN_REQ_LOAD_TILES  = 12    # store tiles in tile table (all bridges)
+VEN_REQ_DRAW_TILES  = 13    # draw run of tile indices (all bridges)
+VEN_REQ_GRAY_MODE   = 14    # set grayscale slot length (0: off)
+VEN_REQ_GET_GRAY    = 15    # read grayscale counters
+VEN_REQ_GET_FEATURES = 16   # read device feature bits
+
+VEN_REQ_WRITE = 0x40        # (bRequestType): vendor host to device
+VEN_REQ_READ  = 0xC0        # (bRequestType): vendor device to host
+
+# Performance counters (see src/perf.h of the firmware)
+CDC_REQ_GET_PERF    = 0x7F  # CDC class request (bRequestType 0xA0)
+HID_REQ_GET_REPORT  = 0x01  # HID class request (bRequestType 0xA1), wValue 0x03<ID>
+PERF_FIELDS  = ['clock', 'bytes', 'transactions', 'packets_out', 'packets_in',
+                'naks', 'nak_ticks', 'loop_max_ticks', 'task_max_ticks', 'task_max_id',
+                'suspends', 'resume_ticks', 'timeouts', 'bus_clears', 'watchdog']
+PERF_FORMAT  = '<7IHIB4HB'
+PERF_TASK_SCALE = 3         # task times in timer2 ticks (F_CPU / 4), 3 per clock tick
+PERF_SIZE    = struct.calcsize(PERF_FORMAT)
+
+def parsecounters(data):
+    if len(data) < PERF_SIZE:
+        raise Exception('Performance counters not available')
+    counters = dict(zip(PERF_FIELDS, struct.unpack(PERF_FORMAT, bytes(data[:PERF_SIZE]))))
+    counters['nak_ms']      = counters['nak_ticks'] * 1000 / counters['clock']
+    counters['loop_max_ms'] = counters['loop_max_ticks'] * 1000 / counters['clock']
+    counters['task_max_ms'] = (counters['task_max_ticks'] * 1000
+                               / (counters['clock'] * PERF_TASK_SCALE))
+    counters['resume_ms']   = counters['resume_ticks'] * 1000 / counters['clock']
+    return counters
+
+# Transaction timestamps (see src/tick.h of the firmware)
+CDC_REQ_GET_TRACE   = 0x7E  # CDC class request (bRequestType 0xA0)
+TRACE_FIELDS = ['clock', 'now', 'rx_first', 'rx_last', 'stall', 'i2c_start',
+                'i2c_stop', 'bytes', 'count']
+TRACE_FORMAT = '<7I2H'
+TRACE_SIZE   = struct.calcsize(TRACE_FORMAT)
+
+def parsetimestamps(data):
+    if len(data) < TRACE_SIZE:
+        raise Exception('Timestamps not available')
+    return dict(zip(TRACE_FIELDS, struct.unpack(TRACE_FORMAT, bytes(data[:TRACE_SIZE]))))
+
+# Device configuration (see src/devcfg.h of the firmware)
+CDC_REQ_GET_CONFIG  = 0x7C  # CDC class request (bRequestType 0xA0)
+CDC_REQ_SET_CONFIG  = 0x7D  # CDC class request (bRequestType 0x20)
+HID_REQ_SET_REPORT  = 0x09  # HID class request (bRequestType 0x21), wValue 0x03<ID>
+CFG_MAGIC       = 0xC5      # valid record
+CFG_SIZE        = 128       # record size (DataFlash of the CH55x)
+CFG_FORMAT      = '<7B'     # magic, checksum, addr, speed, mode, splash, length
+CFG_INIT_SIZE   = CFG_SIZE - struct.calcsize(CFG_FORMAT)
+CFG_SPEED_FAST  = 0         # I2C clock ~500kHz
+CFG_SPEED_SLOW  = 1         # I2C clock ~100kHz
+CFG_MODE_INIT   = 0x01      # device sends the init sequence at power-up
+CFG_MODE_CLEAR  = 0x02      # device clears the display RAM at power-up
+CFG_MODE_SUSPEND = 0x04     # device shows the suspend frame on USB suspend
+CFG_SPLASH_NONE = 0         # no boot splash
+CFG_SPLASH_TEXT = 1         # start message (terminal)
+CFG_SPLASH_FRAME = 2        # splash frame (bridges)
+
+def parseconfig(data):
+    data = bytes(data)
+    if len(data) < CFG_SIZE or data[0] != CFG_MAGIC or sum(data[:CFG_SIZE]) & 0xFF:
+        raise Exception('Device configuration not valid')
+    magic, checksum, addr, speed, mode, splash, length = struct.unpack(CFG_FORMAT, data[:7])
+    return {'addr': addr, 'speed': speed, 'mode': mode, 'splash': splash,
+            'init': list(data[7:7+length])}
+
+def packconfig(config):
+    init = list(config['init'])
+    if len(init) > CFG_INIT_SIZE:
+        raise Exception('Init sequence too long')
+    data = bytearray(struct.pack(CFG_FORMAT, CFG_MAGIC, 0, config['addr'], config['speed'],
+                                 config['mode'], config['splash'], len(init)))
+    data += bytes(init) + bytes(CFG_INIT_SIZE - len(init))
+    data[1] = -sum(data) & 0xFF
+    return bytes(data)
+
+# Device feature bits (CFG_FEATURES, see src/devcfg.h of the firmware)
+CDC_REQ_GET_FEATURES = 0x7B # CDC class request (bRequestType 0xA0)
+FEATURE_FRAMES  = 0x01      # frame store (writeframe(), showframe())
+FEATURE_TILES   = 0x02      # tile table (loadtiles(), drawtiles())
+FEATURE_GRAY    = 0x04      # grayscale mode (setgray())
+FEATURE_SIZE    = 1
+
+# Controls of the HID bridge (feature report 5, see src/usb_hid_data.h of the firmware)
+CONTROL_FIELDS = ['buzzer', 'speed', 'contrast']
+CONTROL_FORMAT = '<3B'
+CONTROL_SIZE   = struct.calcsize(CONTROL_FORMAT)
+
+def parsecontrol(data):
+    if len(data) < CONTROL_SIZE:
+        raise Exception('Controls not available')
+    return dict(zip(CONTROL_FIELDS, struct.unpack(CONTROL_FORMAT, bytes(data[:CONTROL_SIZE]))))
+
+def packcontrol(control):
+    return struct.pack(CONTROL_FORMAT, control['buzzer'], control['speed'],
+                       control['contrast'])
+
+# Record of a feature report of the HID bridge (data after the report ID)
+def featurerecord(report, data):
+    data = bytes(data)
+    if not data or data[0] != report:
+        raise Exception('Feature report %d not available' % report)
+    return data[1:]
+
+# Frame store in the code flash (see src/frames.h of the firmware)
+FRAME_COUNT     = 2         # number of frames
+FRAME_CHUNK     = 64        # bytes per write request
+FRAME_SPLASH    = 0         # frame shown at power-up (CFG_SPLASH_FRAME)
+FRAME_SUSPEND   = 1         # frame shown on USB suspend (CFG_MODE_SUSPEND)
+FRAME_BLANK     = 0xFF      # clear display RAM
+
+# Tile table in the code flash (see src/tiles.h of the firmware)
+TILE_COUNT      = 256       # number of tiles
+TILE_SIZE       = 8         # bytes per tile (8x8 pixels, one byte per column)
+TILE_CHUNK      = 64        # max bytes per request
+
+# Grayscale mode of the vendor bridge (see src/gray.h of the firmware)
+GRAY_FIELDS     = ['frames', 'deadlines', 'dropped']
+GRAY_FORMAT     = '<3I'
+GRAY_SIZE       = struct.calcsize(GRAY_FORMAT)
+GRAY_PERIOD     = 4         # default slot length in ms (USB frames)
+GRAY_LEVELS     = 4         # brightness levels (two bitplanes)
+
+def parsegray(data):
+    if len(data) < GRAY_SIZE:
+        raise Exception('Grayscale counters not available')
+    return dict(zip(GRAY_FIELDS, struct.unpack(GRAY_FORMAT, bytes(data[:GRAY_SIZE]))))
+
+# Requests handled by the main loop are stalled until the previous one is done
+QUEUED_RETRIES  = 50        # number of attempts
+QUEUED_DELAY    = 0.002     # delay between the attempts in s
+
+# ===================================================================================
+# OLED Constants
+# ===================================================================================
+
+OLED_ADDR     = 0x78        # OLED write address
+OLED_CMD_MODE = 0x00        # set command mode
+OLED_DAT_MODE = 0x40        # set data mode
+
+OLED_WIDTH    = 128         # OLED width in pixels
+OLED_HEIGHT   = 64          # OLED height in pixels
+OLED_PAGES    = OLED_HEIGHT // 8
+OLED_FRAME    = OLED_WIDTH * OLED_PAGES
+
+# OLED initialisation sequence
+OLED_INIT_CMD = [
+  0xA8, 0x3F,               # set multiplex ratio
+  0x8D, 0x14,               # set DC-DC enable
+  0x20, 0x00,               # set horizontal memory addressing mode
+  0xC8, 0xA1,               # flip screen
+  0xDA, 0x12,               # set com pins
+  0xAF                      # display on
+]
+
+# OLED initialisation sequence of 128x32 panels (half of the display RAM visible)
+OLED_INIT_CMD_32 = [
+  0xA8, 0x1F,               # set multiplex ratio
+  0x8D, 0x14,               # set DC-DC enable
+  0x20, 0x00,               # set horizontal memory addressing mode
+  0xC8, 0xA1,               # flip screen
+  0xDA, 0x02,               # set com pins
+  0xAF                      # display on
+]
+
+# SH1106 initialisation sequence (no addressing modes, own DC-DC command)
+OLED_INIT_CMD_SH1106 = [
+  0xA8, 0x3F,               # set multiplex ratio
+  0xAD, 0x8B,               # set DC-DC enable
+  0xC8, 0xA1,               # flip screen
+  0xDA, 0x12,               # set com pins
+  0xAF                      # display on
+]
+
+# ===================================================================================
+# Panel Geometry
+# ===================================================================================
+
+# Visible part of the display RAM. The commands that set the address window are
+# built once, so that sending a frame needs no geometry calculations.
+class Geometry():
+    def __init__(self, width, height, xoffset = 0, pageonly = False, init = OLED_INIT_CMD):
+        self.width    = width
+        self.height   = height
+        self.pages    = height // 8
+        self.frame    = width * self.pages        # bytes per frame
+        self.xoffset  = xoffset                   # first visible column
+        self.pageonly = pageonly                  # page addressing only (SH1106)
+        self.init     = init
+        if pageonly:                              # position of each page
+            self.window = [[0xB0 | page, xoffset & 0x0F, 0x10 | xoffset >> 4]
+                           for page in range(self.pages)]
+        elif (width, height, xoffset) == (OLED_WIDTH, OLED_HEIGHT, 0):
+            self.window = None                    # full display RAM (init sequence)
+        else:
+            self.window = [0x21, xoffset, xoffset + width - 1, 0x22, 0, self.pages - 1]
+
+    # Visible part of a display RAM image (SSD1306 layout, 128 columns)
+    def crop(self, gddram):
+        return b''.join(gddram[page * OLED_WIDTH + self.xoffset:
+                               page * OLED_WIDTH + self.xoffset + self.width]
+                        for page in range(self.pages))
+
+# OLED initialisation sequence of other SSD1306 panels
+def oledinit(height, compins = 0x12):
+    init = list(OLED_INIT_CMD)
+    init[1], init[9] = height - 1, compins
+    return init
+
+GEOMETRIES = {
+    '128x64': Geometry(128, 64),
+    '128x32': Geometry(128, 32, init = OLED_INIT_CMD_32),
+    '72x40':  Geometry( 72, 40, 28, init = oledinit(40)),
+    '64x48':  Geometry( 64, 48, 32, init = oledinit(48)),
+    'sh1106': Geometry(128, 64,  2, pageonly = True, init = OLED_INIT_CMD_SH1106)
+}
+
+# ===================================================================================
+# Bridge Base Class
+# ===================================================================================
+
+class Bridge():
+    transport  = None       # name of the transport ('cdc', 'hid', 'vendor')
+    max_stream = None       # max number of bytes per I2C transaction (None: no limit)
+    geometry   = GEOMETRIES['128x64']               # panel (see open_bridge())
+
+    # Time base used for all measurements (virtual for the emulated device)
+    def clock(self):
+        return time.perf_counter()
+
+    def sleep(self, seconds):
+        time.sleep(seconds)
+
+    # Send one complete I2C transaction (address byte first)
+    def sendstream(self, stream):
+        raise NotImplementedError
+
+    # I2C transactions needed to send pixel data
+    def datastreams(self, data):
+        data = list(data)
+        if self.max_stream is None:
+            return [[OLED_ADDR, OLED_DAT_MODE] + data]
+        chunk = self.max_stream - 2
+        return [[OLED_ADDR, OLED_DAT_MODE] + data[i:i+chunk]
+                for i in range(0, len(data), chunk)]
+
+    def senddata(self, data):
+        for stream in self.datastreams(data):
+            self.sendstream(stream)
+
+    # Wait until all transactions are sent (backends that queue them)
+    def flush(self):
+        pass
+
+    def sendcommand(self, cmd):
+        if self.max_stream is not None and len(cmd) > self.max_stream - 2:
+            raise Exception('Command string too long')
+        self.sendstream([OLED_ADDR, OLED_CMD_MODE] + list(cmd))
+
+    # Init the OLED, unless the device already does it at power-up
+    def setup(self, init = None):
+        if init is None:
+            init = self.geometry.init
+        try:
+            config = self.readconfig()
+            if (config['mode'] & CFG_MODE_INIT and config['addr'] == OLED_ADDR
+                    and config['init'] == init):
+                return
+        except Exception:
+            pass
+        self.sendcommand(init)
+
+    # Send a complete frame of the panel (geometry.frame bytes, pages top down)
+    def sendframe(self, data):
+        geometry = self.geometry
+        data = list(data)
+        if len(data) != geometry.frame:
+            raise Exception('Frame must have %d bytes' % geometry.frame)
+        if geometry.pageonly:
+            for page, window in enumerate(geometry.window):
+                self.sendcommand(window)
+                self.senddata(data[page * geometry.width:(page + 1) * geometry.width])
+            return
+        if geometry.window:
+            self.sendcommand(geometry.window)
+        self.senddata(data)
+
+    # Send pixel data into a rectangle of the panel: pages and columns as (first, last)
+    # in panel coordinates, data page by page. The address window stays at the
+    # rectangle until restorewindow().
+    def sendwindow(self, pages, columns, data):
+        geometry = self.geometry
+        data   = list(data)
+        width  = columns[1] - columns[0] + 1
+        column = geometry.xoffset + columns[0]
+        if geometry.pageonly:
+            for i, page in enumerate(range(pages[0], pages[1] + 1)):
+                self.sendcommand([0xB0 | page, column & 0x0F, 0x10 | column >> 4])
+                self.senddata(data[i * width:(i + 1) * width])
+            return
+        self.sendcommand([0x21, column, column + width - 1, 0x22, pages[0], pages[1]])
+        self.senddata(data)
+
+    # Set the address window back to the full frame of the panel
+    def restorewindow(self):
+        if not self.geometry.pageonly:
+            self.sendcommand(self.geometry.window or
+                             [0x21, 0, OLED_WIDTH - 1, 0x22, 0, OLED_PAGES - 1])
+
+    def clearscreen(self):
+        self.sendframe([0] * self.geometry.frame)
+
+    def scroll(self, scroll):
+        self.sendcommand([0xD3, scroll & 63])
+
+    def beep(self):
+        pass
+
+    # Performance counters of the firmware (dict, see PERF_FIELDS)
+    def counters(self):
+        raise NotImplementedError
+
+    # Timestamps of the last completed I2C transaction (dict, see TRACE_FIELDS)
+    def timestamps(self):
+        raise NotImplementedError
+
+    # Device configuration stored in the DataFlash (dict, see parseconfig())
+    def readconfig(self):
+        raise NotImplementedError
+
+    # Write device configuration, it is used from the next power-up on
+    def writeconfig(self, config):
+        raise NotImplementedError
+
+    # Feature bits (FEATURE_...) of the firmware that can be used via the bridge, 0 if
+    # the device does not report them (older firmware, emulated device)
+    def features(self):
+        try:
+            return self._features()[0]
+        except Exception:
+            return 0
+
+    def _features(self):
+        raise NotImplementedError
+
+    # Controls of the running device (dict: buzzer, speed, contrast; HID bridge)
+    def readcontrol(self):
+        raise NotImplementedError
+
+    # Change controls (keyword arguments as in readcontrol()), applied by the main
+    # loop of the device, requests are retried until the previous one is applied
+    def writecontrol(self, **changes):
+        control = self.readcontrol()
+        control.update(changes)
+        for retry in range(QUEUED_RETRIES):
+            try:
+                self._writecontrol(packcontrol(control))
+                return
+            except Exception:
+                if retry == QUEUED_RETRIES - 1:
+                    raise
+                self.sleep(QUEUED_DELAY)
+
+    # Vendor control request to the device (host to device)
+    def sendcontrol(self, ctrl, value = 0, index = 0, data = None):
+        raise NotImplementedError
+
+    # Vendor control request that is handled by the main loop of the device
+    def sendqueued(self, ctrl, value = 0, index = 0, data = None):
+        for retry in range(QUEUED_RETRIES):
+            try:
+                self.sendcontrol(ctrl, value, index, data)
+                return
+            except Exception:
+                if retry == QUEUED_RETRIES - 1:
+                    raise
+                self.sleep(QUEUED_DELAY)
+
+    # Store frame (display RAM byte order) in the frame store of the device
+    def writeframe(self, frame, data):
+        data = bytes(data)
+        if len(data) != OLED_FRAME or not 0 <= frame < FRAME_COUNT:
+            raise Exception('Invalid frame')
+        for offset in range(0, OLED_FRAME, FRAME_CHUNK):
+            self.sendqueued(VEN_REQ_WRITE_FRAME, frame, offset,
+                            data[offset:offset+FRAME_CHUNK])
+
+    # Show frame of the frame store (or FRAME_BLANK)
+    def showframe(self, frame):
+        self.sendcontrol(VEN_REQ_SHOW_FRAME, frame)
+
+    # Store tiles (8 bytes each) in the tile table of the device, starting at first
+    def loadtiles(self, first, tiles):
+        data = b''.join(bytes(tile) for tile in tiles)
+        if len(data) != len(tiles) * TILE_SIZE or not 0 <= first <= TILE_COUNT - len(tiles):
+            raise Exception('Invalid tiles')
+        for offset in range(0, len(data), TILE_CHUNK):
+            self.sendqueued(VEN_REQ_LOAD_TILES, first + offset // TILE_SIZE, 0,
+                            data[offset:offset+TILE_CHUNK])
+
+    # Draw tiles from left to right at page and column (0 - 127), the run continues
+    # at column 0 of the next page
+    def drawtiles(self, page, column, indices):
+        indices = bytes(indices)
+        for offset in range(0, len(indices), TILE_CHUNK):
+            chunk = indices[offset:offset+TILE_CHUNK]
+            self.sendqueued(VEN_REQ_DRAW_TILES, page | column << 8, 0, chunk)
+            for _ in chunk:
+                column += TILE_SIZE
+                if column >= OLED_WIDTH:
+                    page, column = page + 1, 0
+
+    # Grayscale mode (see GrayFramebuffer): slot length in ms, 0 switches it off
+    def setgray(self, period):
+        raise Exception('Grayscale mode needs the vendor bridge')
+
+    # Counters of the grayscale mode (dict, see GRAY_FIELDS)
+    def graystatus(self):
+        raise Exception('Grayscale mode needs the vendor bridge')
+
+    def close(self):
+        pass
+
+
+# ===================================================================================
+# CDC Bridge Class
+# ===================================================================================
+
+class CDCBridge(Bridge):
+    transport = 'cdc'
+
+    def __init__(self, port = None, setup = True):
+        from serial import Serial
+        from serial.tools.list_ports import comports
+        self.ser = Serial(baudrate = 57600, timeout = 1, write_timeout = 1)
+        self.location = None            # USB port path (control requests)
+        vid = '%04X' % VENDOR_ID
+        pid = '%04X' % CDC_PRODUCT_ID
+        for p in comports():
+            if (port is None and vid in p.hwid and pid in p.hwid) or p.device == port:
+                port, self.location = p.device, p.location
+                break
+        if port is None:
+            raise Exception('Device not found')
+        self.ser.port = port
+        try:
+            self.ser.open()
+        except:
+            raise Exception('Could not open serial port')
+        if setup:
+            self.setup()
+
+    def sendstream(self, stream):
+        self.ser.rts = True
+        self.ser.write(bytes(stream))
+        self.ser.flush()
+        self.ser.rts = False
+        time.sleep(0.001)
+
+    # Control requests to the device (the interface stays with the CDC driver)
+    def _device(self):
+        import usb.core
+        if not hasattr(self, 'dev'):
+            for dev in usb.core.find(find_all = True, idVendor = VENDOR_ID,
+                                     idProduct = CDC_PRODUCT_ID):
+                if not self.location or self.location.split(':')[0] == usbpath(dev):
+                    self.dev = dev
+                    break
+            else:
+                raise Exception('Device not found')
+        return self.dev
+
+    def _request(self, request, length):
+        return self._device().ctrl_transfer(0xA0, request, 0, 0, length)
+
+    def counters(self):
+        return parsecounters(self._request(CDC_REQ_GET_PERF, PERF_SIZE))
+
+    def timestamps(self):
+        return parsetimestamps(self._request(CDC_REQ_GET_TRACE, TRACE_SIZE))
+
+    def readconfig(self):
+        return parseconfig(self._request(CDC_REQ_GET_CONFIG, CFG_SIZE))
+
+    def writeconfig(self, config):
+        self._device().ctrl_transfer(0x20, CDC_REQ_SET_CONFIG, 0, 0, packconfig(config))
+
+    def _features(self):
+        return self._request(CDC_REQ_GET_FEATURES, FEATURE_SIZE)
+
+    def sendcontrol(self, ctrl, value = 0, index = 0, data = None):
+        self._device().ctrl_transfer(VEN_REQ_WRITE, ctrl, value, index, data)
+
+    def close(self):
+        self.ser.close()
+
+
+# ===================================================================================
+# HID Bridge Class
+# ===================================================================================
+
+class HIDBridge(Bridge):
+    transport  = 'hid'
+    max_stream = HID_REPORT_SIZE
+
+    def __init__(self, setup = True, dev = None):
+        import usb.core
+        self.dev = dev or usb.core.find(idVendor = VENDOR_ID, idProduct = HID_PRODUCT_ID)
+        if self.dev is None:
+            raise Exception('Device not found')
+        if self.dev.is_kernel_driver_active(HID_INTERFACE):
+            self.dev.detach_kernel_driver(HID_INTERFACE)
+        if setup:
+            self.setup()
+
+    def sendstream(self, stream):
+        self.dev.write(HID_EP_OUT, bytes([HID_REPORT_DATA]) + bytes(stream))
+
+    def counters(self):
+        return parsecounters(self._getfeature(HID_REPORT_PERF, PERF_SIZE))
+
+    def timestamps(self):
+        return parsetimestamps(self._getfeature(HID_REPORT_TRACE, TRACE_SIZE))
+
+    def readconfig(self):
+        return parseconfig(self._getfeature(HID_REPORT_CONFIG, CFG_SIZE))
+
+    def writeconfig(self, config):
+        self._setfeature(HID_REPORT_CONFIG, packconfig(config))
+
+    def _features(self):
+        return self._getfeature(HID_REPORT_FEATURES, FEATURE_SIZE)
+
+    def readcontrol(self):
+        return parsecontrol(self._getfeature(HID_REPORT_CONTROL, CONTROL_SIZE))
+
+    def _writecontrol(self, data):
+        self._setfeature(HID_REPORT_CONTROL, data)
+
+    # Feature report: report ID in wValue and in front of the record
+    def _getfeature(self, report, length):
+        return featurerecord(report, self.dev.ctrl_transfer(0xA1, HID_REQ_GET_REPORT,
+                             0x0300 | report, HID_INTERFACE, length + 1))
+
+    def _setfeature(self, report, data):
+        self.dev.ctrl_transfer(0x21, HID_REQ_SET_REPORT, 0x0300 | report, HID_INTERFACE,
+                               bytes([report]) + bytes(data))
+
+    def beep(self):
+        self.writecontrol(buzzer = 1)
+        time.sleep(0.2)
+        self.writecontrol(buzzer = 0)
+
+    def sendcontrol(self, ctrl, value = 0, index = 0, data = None):
+        self.dev.ctrl_transfer(VEN_REQ_WRITE, ctrl, value, index, data)
+
+    def close(self):
+        import usb.util
+        usb.util.release_interface(self.dev, HID_INTERFACE)
+        self.dev.attach_kernel_driver(HID_INTERFACE)
+
+
+# ===================================================================================
+# HID Bridge via hidraw (Linux)
+# ===================================================================================
+
+# Device nodes of all HID bridges (/dev/hidrawN), also virtual ones (oled_uhid.py)
+def hidrawdevices(vid = VENDOR_ID, pid = HID_PRODUCT_ID):
+    nodes = []
+    if not os.path.isdir('/sys/class/hidraw'):
+        return nodes
+    for name in sorted(os.listdir('/sys/class/hidraw'), key = lambda n: int(n[6:])):
+        try:
+            with open('/sys/class/hidraw/%s/device/uevent' % name) as f:
+                ids = [l.strip()[7:].split(':') for l in f if l.startswith('HID_ID=')]
+        except OSError:
+            continue
+        if ids and (int(ids[0][1], 16), int(ids[0][2], 16)) == (vid, pid):
+            nodes.append('/dev/' + name)
+    return nodes
+
+# The output reports go through the hidraw node of the kernel HID driver, so the
+# interface stays attached and no root rights are needed (see udev rule in the
+# README). A writer thread sends the queued reports back to back, while the caller
+# already prepares the next ones, so that the interrupt endpoint gets a report in
+# every USB frame. Requests that read or write feature reports wait until the queue
+# is empty. Vendor requests (frame store, tiles) need the pyusb backend. With
+# queued = False there is no writer thread and sendstream() writes the report
+# itself (for an event loop that writes to the non-blocking fd, see oled_manager.py).
+class HidrawBridge(Bridge):
+    transport  = 'hid'
+    max_stream = HID_REPORT_SIZE
+
+    def __init__(self, setup = True, path = None, queued = True):
+        import threading
+        from queue import Queue
+        paths = [path] if path else hidrawdevices()
+        if not paths:
+            raise Exception('Device not found')
+        self.fd     = os.open(paths[0], os.O_RDWR | os.O_NONBLOCK)
+        self.queue  = Queue(HIDRAW_QUEUE)
+        self.error  = None          # exception of the writer thread
+        self.thread = None
+        if queued:
+            self.thread = threading.Thread(target = self._writer, daemon = True)
+            self.thread.start()
+        if setup:
+            self.setup()
+
+    # Queue output report (data report ID in front of the stream)
+    def sendstream(self, stream):
+        if len(stream) > HID_REPORT_SIZE:
+            raise Exception('HID report too long')
+        if not self.thread:
+            self._write(bytes([HID_REPORT_DATA]) + bytes(stream))
+            return
+        self._check()
+        self.queue.put(bytes([HID_REPORT_DATA]) + bytes(stream))
+
+    def flush(self):
+        self.queue.join()
+        self._check()
+
+    def counters(self):
+        return parsecounters(self._getfeature(HID_REPORT_PERF, PERF_SIZE))
+
+    def timestamps(self):
+        return parsetimestamps(self._getfeature(HID_REPORT_TRACE, TRACE_SIZE))
+
+    def readconfig(self):
+        return parseconfig(self._getfeature(HID_REPORT_CONFIG, CFG_SIZE))
+
+    def writeconfig(self, config):
+        self._setfeature(HID_REPORT_CONFIG, packconfig(config))
+
+    # Frame store and tiles of the firmware need vendor requests
+    def features(self):
+        return super().features() & ~(FEATURE_FRAMES | FEATURE_TILES | FEATURE_GRAY)
+
+    def _features(self):
+        return self._getfeature(HID_REPORT_FEATURES, FEATURE_SIZE)
+
+    def readcontrol(self):
+        return parsecontrol(self._getfeature(HID_REPORT_CONTROL, CONTROL_SIZE))
+
+    def _writecontrol(self, data):
+        self._setfeature(HID_REPORT_CONTROL, data)
+
+    def beep(self):
+        self.writecontrol(buzzer = 1)
+        time.sleep(0.2)
+        self.writecontrol(buzzer = 0)
+
+    def close(self):
+        try:
+            self.flush()
+        finally:
+            if self.thread:
+                self.queue.put(None)
+                self.thread.join()
+            os.close(self.fd)
+
+    # Feature report: the kernel takes the report ID from the first byte of the buffer
+    # and returns the report including the ID
+    def _getfeature(self, report, length):
+        import fcntl
+        self.flush()
+        buf    = bytearray(length + 1)
+        buf[0] = report
+        size   = fcntl.ioctl(self.fd, hidraw_ioctl(HIDIOCGFEATURE, len(buf)), buf, True)
+        return featurerecord(report, buf[:size])
+
+    def _setfeature(self, report, data):
+        import fcntl
+        self.flush()
+        buf = bytearray([report]) + bytes(data)
+        fcntl.ioctl(self.fd, hidraw_ioctl(HIDIOCSFEATURE, len(buf)), buf, True)
+
+    def _check(self):
+        if self.error:
+            error, self.error = self.error, None
+            raise error
+
+    # Send the queued reports, after an error the remaining ones are dropped until
+    # the caller has been informed
+    def _writer(self):
+        while True:
+            report = self.queue.get()
+            try:
+                if report is None:
+                    return
+                if not self.error:
+                    self._write(report)
+            except Exception as ex:
+                self.error = ex
+            finally:
+                self.queue.task_done()
+
+    def _write(self, report):
+        while True:
+            try:
+                os.write(self.fd, report)
+                return
+            except BlockingIOError:
+                if not select.select([], [self.fd], [], HIDRAW_TIMEOUT)[1]:
+                    raise Exception('HID device does not accept reports')
+
+
+# ===================================================================================
+# Vendor Class Bridge Class
+# ===================================================================================
+
+class VendorBridge(Bridge):
+    transport = 'vendor'
+
+    def __init__(self, setup = True, dev = None):
+        import usb.core
+        self.dev = dev or usb.core.find(idVendor = VENDOR_ID, idProduct = VEN_PRODUCT_ID)
+        if self.dev is None:
+            raise Exception('Device not found')
+        try:
+            if self.dev.bDeviceClass != COMPOSITE_CLASS:    # (a reset would also drop
+                self.dev.reset()                            # the serial port of the
+                self.dev.set_configuration()                # composite terminal)
+            self.ep_out = self.bulkendpoint()
+        except:
+            raise Exception('Could not access USB device')
+        if setup:
+            self.setup()
+
+    # Bulk OUT endpoint of the vendor interface (EP1 of the bridge, EP3 of the
+    # composite terminal)
+    def bulkendpoint(self):
+        import usb.util
+        intf = usb.util.find_descriptor(self.dev.get_active_configuration(),
+                                        bInterfaceClass = VEN_CLASS)
+        ep   = usb.util.find_descriptor(intf, custom_match = lambda e:
+                   usb.util.endpoint_direction(e.bEndpointAddress) == usb.util.ENDPOINT_OUT)
+        return ep.bEndpointAddress
+
+    def sendcontrol(self, ctrl, value = 0, index = 0, data = None):
+        self.dev.ctrl_transfer(VEN_REQ_WRITE, ctrl, value, index, data)
+
+    def sendstream(self, stream):
+        self.sendcontrol(VEN_REQ_I2C_START)
+        self.dev.write(self.ep_out, stream, BULK_TIMEOUT)
+        self.sendcontrol(VEN_REQ_I2C_STOP)
+
+    def beep(self):
+        self.sendcontrol(VEN_REQ_BUZZER_ON)
+        time.sleep(0.2)
+        self.sendcontrol(VEN_REQ_BUZZER_OFF)
+
+    def boot(self):
+        self.sendcontrol(VEN_REQ_BOOTLOADER)
+
+    def counters(self):
+        return parsecounters(self.dev.ctrl_transfer(VEN_REQ_READ, VEN_REQ_GET_PERF, 0, 0,
+                                                    PERF_SIZE))
+
+    def timestamps(self):
+        return parsetimestamps(self.dev.ctrl_transfer(VEN_REQ_READ, VEN_REQ_GET_TRACE, 0, 0,
+                                                      TRACE_SIZE))
+
+    def readconfig(self):
+        return parseconfig(self.dev.ctrl_transfer(VEN_REQ_READ, VEN_REQ_GET_CONFIG, 0, 0,
+                                                  CFG_SIZE))
+
+    def writeconfig(self, config):
+        self.dev.ctrl_transfer(VEN_REQ_WRITE, VEN_REQ_SET_CONFIG, 0, 0, packconfig(config))
+
+    def _features(self):
+        return self.dev.ctrl_transfer(VEN_REQ_READ, VEN_REQ_GET_FEATURES, 0, 0,
+                                      FEATURE_SIZE)
+
+    def setgray(self, period):
+        self.sendcontrol(VEN_REQ_GRAY_MODE, period)
+
+    def graystatus(self):
+        return parsegray(self.dev.ctrl_transfer(VEN_REQ_READ, VEN_REQ_GET_GRAY, 0, 0,
+                                                GRAY_SIZE))
+
+
+# ===================================================================================
+# Tile Map
+# ===================================================================================
+
+TILEMAP_COLUMNS = OLED_WIDTH // TILE_SIZE
+TILEMAP_CELLS   = TILEMAP_COLUMNS * OLED_PAGES
+TILEMAP_GAP     = 8         # unchanged cells that are redrawn to join two runs
+
+# Screen as a grid of 16x8 tile indices. draw() only sends the cells that differ
+# from the last drawn map, neighbouring changes are joined into one request.
+class TileMap():
+    def __init__(self, bridge, tiles = None):
+        self.bridge = bridge
+        self.tiles  = {}            # tile table of the device (index: tile)
+        self.shown  = None          # map on the display (None: unknown)
+        if tiles:
+            self.load(tiles)
+
+    # Store tiles in the tile table of the device
+    def load(self, tiles, first = 0):
+        tiles = [bytes(tile) for tile in tiles]
+        self.bridge.loadtiles(first, tiles)
+        for i, tile in enumerate(tiles):
+            self.tiles[first + i] = tile
+        self.shown = None           # cells may show changed tiles
+
+    # Draw map (list of 128 indices or 8 rows of 16), returns number of cells sent
+    def draw(self, tilemap):
+        cells = bytes(self._flatten(tilemap))
+        if len(cells) != TILEMAP_CELLS:
+            raise Exception('Invalid tile map')
+        runs = self._runs(cells)
+        for start, end in runs:
+            page, column = divmod(start, TILEMAP_COLUMNS)
+            self.bridge.drawtiles(page, column * TILE_SIZE, cells[start:end])
+        self.shown = cells
+        return sum(end - start for start, end in runs)
+
+    # Forget the displayed map, the next draw() sends all cells
+    def invalidate(self):
+        self.shown = None
+
+    # Display RAM content of the displayed map (display RAM byte order)
+    def frame(self):
+        if self.shown is None:
+            return None
+        rows = [b''.join(self.tiles.get(i, bytes(TILE_SIZE)) for i in
+                         self.shown[page*TILEMAP_COLUMNS:(page+1)*TILEMAP_COLUMNS])
+                for page in range(OLED_PAGES)]
+        return b''.join(rows)
+
+    def _flatten(self, tilemap):
+        tilemap = list(tilemap)
+        if tilemap and isinstance(tilemap[0], (list, tuple, bytes, bytearray)):
+            return [i for row in tilemap for i in row]
+        return tilemap
+
+    # Ranges of changed cells [start, end), joined if the gap is small
+    def _runs(self, cells):
+        if self.shown is None:
+            return [(0, TILEMAP_CELLS)]
+        runs = []
+        for i in range(TILEMAP_CELLS):
+            if cells[i] == self.shown[i]:
+                continue
+            if runs and i - runs[-1][1] <= TILEMAP_GAP:
+                runs[-1] = (runs[-1][0], i + 1)
+            else:
+                runs.append((i, i + 1))
+        return runs
+
+
+# ===================================================================================
+# Double Buffer
+# ===================================================================================
+
+# Page flipping on panels that show only a part of the display RAM (128x32: 4 of 8
+# pages). Each frame is written into the hidden part, then a single display start
+# line command makes it visible at once, so that the panel never shows a frame that
+# is only half written. Needs the horizontal addressing mode of OLED_INIT_CMD_32.
+class DoubleBuffer():
+    def __init__(self, bridge, height = None):
+        if height is None:
+            height = bridge.geometry.height
+        if height > OLED_HEIGHT // 2 or height % 8:
+            raise Exception('Invalid height for double buffering')
+        self.bridge  = bridge
+        self.pages   = height // 8      # pages per frame
+        self.visible = 0                # first visible page
+        self.bridge.sendcommand([0xD3, 0x00, 0x40])     # no offset, start line 0
+
+    # First page of the hidden buffer
+    def hidden(self):
+        return (self.visible + self.pages) % OLED_PAGES
+
+    # Write frame (pages * 128 bytes) into the hidden buffer and show it
+    def draw(self, data):
+        data = bytes(data)
+        if len(data) != self.pages * OLED_WIDTH:
+            raise Exception('Invalid frame')
+        page = self.hidden()
+        self.bridge.sendcommand([0x21, 0, OLED_WIDTH - 1,                 # columns
+                                 0x22, page, page + self.pages - 1])      # pages
+        self.bridge.senddata(data)
+        self.flip()
+
+    # Show the hidden buffer (and set the address window back to the full screen)
+    def flip(self):
+        page = self.hidden()
+        self.bridge.sendcommand([0x40 | page * 8,                         # start line
+                                 0x21, 0, OLED_WIDTH - 1, 0x22, 0, OLED_PAGES - 1])
+        self.visible = page
+
+
+# ===================================================================================
+# Grayscale Framebuffer
+# ===================================================================================
+
+GRAY_HEIGHT     = 32        # visible lines (128x32 window)
+GRAY_PAGES      = GRAY_HEIGHT // 8
+
+# Reduce gray values (0 - 255, row by row) to GRAY_LEVELS levels, the quantization
+# error is distributed to the neighbouring pixels (Floyd-Steinberg) if diffuse is set
+def quantize(image, width, height, diffuse = True):
+    image  = [float(v) for v in image]
+    levels = []
+    step   = 255 / (GRAY_LEVELS - 1)
+    for y in range(height):
+        for x in range(width):
+            i     = y * width + x
+            level = min(GRAY_LEVELS - 1, max(0, int(image[i] / step + 0.5)))
+            levels.append(level)
+            if not diffuse:
+                continue
+            error = image[i] - level * step
+            if x + 1 < width:
+                image[i + 1] += error * 7 / 16
+            if y + 1 < height:
+                if x > 0:
+                    image[i + width - 1] += error * 3 / 16
+                image[i + width] += error * 5 / 16
+                if x + 1 < width:
+                    image[i + width + 1] += error / 16
+    return levels
+
+# Split levels (row by row) into the two bitplanes in display RAM byte order: plane A
+# (most significant bit, shown two thirds of the time) and plane B
+def bitplanes(levels, width, height):
+    planes = [bytearray(width * (height // 8)), bytearray(width * (height // 8))]
+    for y in range(height):
+        page, bit = divmod(y, 8)
+        for x in range(width):
+            level = levels[y * width + x]
+            if level & 2:
+                planes[0][page * width + x] |= 1 << bit
+            if level & 1:
+                planes[1][page * width + x] |= 1 << bit
+    return [bytes(plane) for plane in planes]
+
+# Four gray levels on a 128x32 window with the vendor bridge: plane A is kept in the
+# pages 0 - 3 of the display RAM, plane B in the pages 4 - 7, and the bridge
+# alternates them (A, A, B) with the cadence of the USB start-of-frame packets.
+# Only pages that changed are sent, each in its own I2C transaction, so that the
+# bridge can switch the planes in between. Needs the 128x32 init sequence.
+class GrayFramebuffer():
+    def __init__(self, bridge, period = GRAY_PERIOD, diffuse = True):
+        self.bridge  = bridge
+        self.diffuse = diffuse
+        self.shown   = [None, None]     # planes on the display (None: unknown)
+        self.bridge.sendcommand([0xD3, 0x00])           # no display offset
+        self.bridge.setgray(period)
+
+    # Draw gray values (0 - 255, 128x32 row by row), returns number of pages sent
+    def draw(self, image):
+        image = list(image)
+        if len(image) != OLED_WIDTH * GRAY_HEIGHT:
+            raise Exception('Invalid image')
+        return self.show(quantize(image, OLED_WIDTH, GRAY_HEIGHT, self.diffuse))
+
+    # Show levels (0 - 3, 128x32 row by row), returns number of pages sent
+    def show(self, levels):
+        levels = list(levels)
+        if len(levels) != OLED_WIDTH * GRAY_HEIGHT:
+            raise Exception('Invalid levels')
+        planes = bitplanes(levels, OLED_WIDTH, GRAY_HEIGHT)
+        sent   = 0
+        for plane, data in enumerate(planes):
+            for page in range(GRAY_PAGES):
+                row = data[page * OLED_WIDTH:(page + 1) * OLED_WIDTH]
+                if self.shown[plane] and row == self.shown[plane][page * OLED_WIDTH:
+                                                                  (page + 1) * OLED_WIDTH]:
+                    continue
+                ram = plane * GRAY_PAGES + page
+                self.bridge.sendcommand([0x21, 0, OLED_WIDTH - 1, 0x22, ram, ram])
+                self.bridge.senddata(row)
+                sent += 1
+        if sent:
+            self.bridge.sendcommand([0x21, 0, OLED_WIDTH - 1, 0x22, 0, OLED_PAGES - 1])
+        self.shown = planes
+        return sent
+
+    # Forget the displayed planes, the next draw() sends all pages
+    def invalidate(self):
+        self.shown = [None, None]
+
+    # Counters of the bridge (dict, see GRAY_FIELDS)
+    def status(self):
+        return self.bridge.graystatus()
+
+    # Stop alternating, plane A stays visible
+    def close(self):
+        self.bridge.setgray(0)
+
+
+# ===================================================================================
+# Bridge Factory
+# ===================================================================================
+
+TRANSPORTS = {'cdc': CDCBridge, 'hid': HIDBridge, 'vendor': VendorBridge}
+BACKENDS   = ['device', 'hidraw', 'emulator', 'sim']
+
+# Geometry: name in GEOMETRIES or Geometry object of the connected panel
+def open_bridge(transport, backend = 'device', geometry = '128x64', **kwargs):
+    if transport not in TRANSPORTS:
+        raise Exception('Unknown transport ' + str(transport))
+    if isinstance(geometry, str):
+        if geometry not in GEOMETRIES:
+            raise Exception('Unknown geometry ' + geometry)
+        geometry = GEOMETRIES[geometry]
+    setup = kwargs.pop('setup', True)
+    if backend == 'device':
+        bridge = TRANSPORTS[transport](setup = False, **kwargs)
+    elif backend == 'hidraw':
+        if transport != 'hid':
+            raise Exception('Backend hidraw needs the HID transport')
+        bridge = HidrawBridge(setup = False, **kwargs)
+    elif backend == 'emulator':
+        from oled_emulator import open_emulator
+        bridge = open_emulator(transport, setup = False, **kwargs)
+    elif backend == 'sim':
+        from oled_sim import open_sim
+        bridge = open_sim(transport, setup = False, **kwargs)
+    else:
+        raise Exception('Unknown backend ' + str(backend))
+    bridge.geometry = geometry
+    if os.environ.get('OLED_RECORD'):               # record traffic (see oled_record.py)
+        from oled_record import Recorder
+        Recorder(bridge, os.environ['OLED_RECORD'])
+    if setup:
+        bridge.setup()
+    return bridge
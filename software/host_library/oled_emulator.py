@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   USB OLED Emulated Device for CH551, CH552, CH554
+# Version:   v1.0
+# Year:      2022
+# Author:    Stefan Wagner
+# Github:    https://github.com/wagiminator
+# License:   http://creativecommons.org/licenses/by-sa/3.0/
+# ===================================================================================
+#
+# Description:
+# ------------
+# Emulation of the three I2C bridge firmwares together with an SSD1306 model, so
+# that host tools can be exercised and benchmarked without hardware. Every bridge
+# runs on a virtual clock which follows the behavior of the firmware:
+# - The device has a single 64-byte OUT buffer and NAKs further packets until all
+#   bytes of the buffer have been clocked out via I2C.
+# - HID reports are polled by the host once per USB frame (bInterval = 1ms).
+# - Control requests (vendor I2C start/stop, CDC RTS) cost one control transfer.
+# The timing parameters can be adjusted via the Timing class.
+
+from oled_bridge import Bridge, HID_REPORT_SIZE, OLED_ADDR, OLED_WIDTH, OLED_PAGES
+
+# ===================================================================================
+# Timing Model
+# ===================================================================================
+
+class Timing():
+    usb_frame     = 0.001       # USB full-speed frame period (s)
+    usb_packet    = 0.000060    # time of a 64-byte data packet incl. handshake (s)
+    usb_control   = 0.000250    # time of a complete control transfer (s)
+    i2c_clock     = 500000      # I2C clock frequency (Hz)
+    i2c_overhead  = 0.000002    # firmware overhead per I2C byte (s)
+    i2c_condition = 0.000002    # time of an I2C start or stop condition (s)
+    cdc_gap       = 0.001       # pause after RTS release (see CDC bridge scripts)
+
+    def i2c_byte(self):
+        return 9.0 / self.i2c_clock + self.i2c_overhead
+
+
+# ===================================================================================
+# SSD1306 Model
+# ===================================================================================
+
+# Number of argument bytes of multi-byte SSD1306 commands
+SSD1306_ARGS = {
+    0x20: 1, 0x21: 2, 0x22: 2, 0x26: 6, 0x27: 6, 0x29: 5, 0x2A: 5,
+    0x81: 1, 0x8D: 1, 0xA3: 2, 0xA8: 1, 0xD3: 1, 0xD5: 1, 0xD9: 1,
+    0xDA: 1, 0xDB: 1
+}
+
+class SSD1306():
+    def __init__(self, address = OLED_ADDR):
+        self.address  = address
+        self.gddram   = bytearray(OLED_WIDTH * OLED_PAGES)
+        self.mode     = 2                   # page addressing mode after reset
+        self.col      = 0
+        self.page     = 0
+        self.col_lo   = 0                   # column range (horizontal/vertical mode)
+        self.col_hi   = OLED_WIDTH - 1
+        self.page_lo  = 0                   # page range (horizontal/vertical mode)
+        self.page_hi  = OLED_PAGES - 1
+        self.offset   = 0                   # display offset (0xD3)
+        self.startline= 0                   # display start line (0x40-0x7F)
+        self.display  = False               # display on/off
+        self.cmd      = []                  # pending multi-byte command
+        self.commands = 0                   # number of command bytes received
+        self.data     = 0                   # number of data bytes received
+
+    # Decode one complete I2C transaction (address byte first)
+    def transaction(self, stream):
+        if len(stream) == 0 or stream[0] != self.address:
+            return False                    # not addressed -> NAK
+        i = 1
+        while i < len(stream):
+            ctrl = stream[i]
+            i += 1
+            if ctrl & 0x80:                 # Co = 1: one byte follows, then control
+                if i < len(stream):
+                    self._byte(ctrl & 0x40, stream[i])
+                    i += 1
+            else:                           # Co = 0: all following bytes
+                for b in stream[i:]:
+                    self._byte(ctrl & 0x40, b)
+                break
+        return True
+
+    def _byte(self, isdata, b):
+        if isdata:
+            self.data += 1
+            self._write(b)
+        else:
+            self.commands += 1
+            self._command(b)
+
+    def _write(self, b):
+        self.gddram[self.page * OLED_WIDTH + self.col] = b
+        if self.mode == 0:                  # horizontal addressing mode
+            self.col += 1
+            if self.col > self.col_hi:
+                self.col = self.col_lo
+                self.page = self.page + 1 if self.page < self.page_hi else self.page_lo
+        elif self.mode == 1:                # vertical addressing mode
+            self.page += 1
+            if self.page > self.page_hi:
+                self.page = self.page_lo
+                self.col = self.col + 1 if self.col < self.col_hi else self.col_lo
+        else:                               # page addressing mode
+            self.col = (self.col + 1) % OLED_WIDTH
+
+    def _command(self, b):
+        self.cmd.append(b)
+        if len(self.cmd) <= SSD1306_ARGS.get(self.cmd[0], 0):
+            return                          # wait for argument bytes
+        cmd, self.cmd = self.cmd, []
+        c = cmd[0]
+        if   c <= 0x0F: self.col = (self.col & 0xF0) | c
+        elif c <= 0x1F: self.col = (self.col & 0x0F) | ((c & 0x0F) << 4)
+        elif c == 0x20: self.mode = cmd[1] & 3
+        elif c == 0x21:
+            self.col_lo, self.col_hi = cmd[1] & 0x7F, cmd[2] & 0x7F
+            self.col = self.col_lo
+        elif c == 0x22:
+            self.page_lo, self.page_hi = cmd[1] & 0x07, cmd[2] & 0x07
+            self.page = self.page_lo
+        elif 0x40 <= c <= 0x7F: self.startline = c & 0x3F
+        elif c == 0xAE: self.display = False
+        elif c == 0xAF: self.display = True
+        elif 0xB0 <= c <= 0xB7: self.page = c & 0x07
+        elif c == 0xD3: self.offset = cmd[1] & 0x3F
+
+
+# ===================================================================================
+# Emulated Bridge Base Class
+# ===================================================================================
+
+class EmulatedBridge(Bridge):
+    def __init__(self, timing = None, setup = True):
+        self.timing = timing or Timing()
+        self.oled   = SSD1306()
+        self.now    = 0.0               # virtual host time
+        self.busy   = 0.0               # time until device has emptied its buffer
+        self.stream = []                # bytes of the current I2C transaction
+        self.naks   = 0                 # number of NAKed OUT transactions
+        if setup:
+            self.setup()
+
+    def clock(self):
+        return self.now
+
+    def sleep(self, seconds):
+        self.now += seconds
+
+    def framebuffer(self):
+        return bytes(self.oled.gddram)
+
+    # Device time when all received bytes have been passed to the OLED
+    def idle(self):
+        return max(self.now, self.busy)
+
+    def _control(self):
+        self.now += self.timing.usb_control
+
+    def _i2c_start(self):
+        self.stream = []
+        self.busy   = max(self.busy, self.now) + self.timing.i2c_condition
+
+    def _i2c_stop(self):
+        self.busy = max(self.busy, self.now) + self.timing.i2c_condition
+        self.oled.transaction(self.stream)
+        self.stream = []
+
+    # One OUT packet: NAK until the device buffer is empty, then receive packet
+    def _packet(self, data, polled = False):
+        start = max(self.now, self.busy)
+        if start > self.now:
+            self.naks += 1
+        if polled:                      # interrupt endpoint: next frame boundary
+            frame = self.timing.usb_frame
+            start = -(-start // frame) * frame
+        self.now  = start + self.timing.usb_packet
+        self.busy = self.now + len(data) * self.timing.i2c_byte()
+        self.stream += list(data)
+
+    def _bulk(self, data):
+        data = list(data)
+        for i in range(0, len(data), 64):
+            self._packet(data[i:i+64])
+
+
+# ===================================================================================
+# Emulated Bridges
+# ===================================================================================
+
+class EmulatedCDCBridge(EmulatedBridge):
+    transport = 'cdc'
+
+    def sendstream(self, stream):
+        self._control()                 # RTS set
+        self._i2c_start()
+        self._bulk(stream)              # write and flush
+        self._control()                 # RTS cleared
+        self._i2c_stop()
+        self.sleep(self.timing.cdc_gap)
+
+
+class EmulatedHIDBridge(EmulatedBridge):
+    transport  = 'hid'
+    max_stream = HID_REPORT_SIZE
+
+    def sendstream(self, stream):
+        if len(stream) > HID_REPORT_SIZE:
+            raise Exception('HID report too long')
+        self.stream = []
+        self._packet(stream, polled = True)
+        self.busy  += 2 * self.timing.i2c_condition
+        self.oled.transaction(self.stream)
+        self.stream = []
+
+
+class EmulatedVendorBridge(EmulatedBridge):
+    transport = 'vendor'
+
+    def sendstream(self, stream):
+        self._control()                 # VEN_REQ_I2C_START
+        self._i2c_start()
+        self._bulk(stream)
+        self._control()                 # VEN_REQ_I2C_STOP
+        self._i2c_stop()
+
+    def beep(self):
+        self._control()
+        self.sleep(0.2)
+        self._control()
+
+
+EMULATORS = {
+    'cdc':    EmulatedCDCBridge,
+    'hid':    EmulatedHIDBridge,
+    'vendor': EmulatedVendorBridge
+}
+
+def open_emulator(transport, **kwargs):
+    return EMULATORS[transport](**kwargs)
@@ -0,0 +1,247 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   USB OLED Adaptive Frame Encoder for CH551, CH552, CH554
+# Version:   v1.0
+# Year:      2022
+# Author:    Stefan Wagner
+# Github:    https://github.com/wagiminator
+# License:   http://creativecommons.org/licenses/by-sa/3.0/
+# ===================================================================================
+#
+# Description:
+# ------------
+# Sends each frame in the encoding that costs the least time for the connected
+# bridge. Which one wins depends on the content: a full frame has no addressing
+# overhead, a window around the changes or one span per changed page skips the
+# unchanged bytes, and tile indices (8 pixel columns per byte, see TileMap) are the
+# cheapest for screens built from known tiles. Every candidate is built with the
+# normal bridge methods on a dummy bridge, which prices each I2C transaction and
+# control request with the packetization of the transport:
+# - HID:    reports of up to 61 pixel bytes (plus address and control byte), at most
+#           one per USB frame, the next one is NAKed until the I2C bus is done.
+# - vendor: 64-byte bulk packets, each one clocked out before the next is accepted,
+#           plus the two control transfers for the I2C start and stop condition.
+# - CDC:    as vendor, the control transfers set and clear RTS, plus the pause
+#           after the RTS release.
+# - tiles:  one control transfer per 64 indices, then the firmware writes the tile
+#           columns together with a window command per row.
+# The transfer and I2C times are those of the emulated device (Timing class of
+# oled_emulator.py), the I2C clock follows the speed in the device configuration.
+# Only encodings the device supports are tried: tiles need the tile table, which
+# the firmware reports in its feature bits (FEATURE_TILES, read once when the
+# encoder is created; not on the emulated device, older firmware and the hidraw
+# backend), and tiles loaded with loadtiles(). The firmwares have no run-length
+# decoder, so RLE is not among the candidates.
+#
+# Usage example:
+# --------------
+# from oled_bridge import open_bridge
+# from oled_encoder import FrameEncoder
+# oled    = open_bridge('hid')
+# encoder = FrameEncoder(oled)
+# encoder.send(frame)                               (returns the encoding used)
+# print(encoder.estimate(frame))                    (time of each candidate in s)
+# encoder.close()
+
+from oled_bridge import Bridge, CFG_SPEED_SLOW, OLED_WIDTH, OLED_PAGES, TILE_SIZE
+from oled_bridge import FEATURE_TILES
+from oled_bridge import VEN_REQ_DRAW_TILES, TILEMAP_COLUMNS, TILEMAP_GAP
+from oled_emulator import Timing
+
+ENCODINGS       = ['frame', 'window', 'spans', 'tiles']
+ENCODER_BULK    = 64        # bytes per bulk packet (CDC and vendor bridge)
+ENCODER_LOCATE  = 11        # I2C bytes of a window command of the firmware (frames.c)
+ENCODER_SLOW    = 100000    # I2C clock in Hz with CFG_SPEED_SLOW
+
+# ===================================================================================
+# Cost Model
+# ===================================================================================
+
+# Time of one I2C transaction of length bytes on the bus
+def i2ctime(timing, length):
+    return length * timing.i2c_byte() + 2 * timing.i2c_condition
+
+# Time of one I2C transaction sent via the transport (sendstream())
+def streamtime(transport, length, timing):
+    if transport == 'hid':
+        frame = timing.usb_frame
+        return -(-(timing.usb_packet + i2ctime(timing, length)) // frame) * frame
+    packets = max(1, -(-length // ENCODER_BULK))
+    time    = 2 * timing.usb_control + packets * timing.usb_packet + i2ctime(timing, length)
+    if transport == 'cdc':
+        time += timing.cdc_gap
+    return time
+
+# Time of a vendor control request, incl. the I2C traffic of the firmware
+def controltime(ctrl, value, data, timing):
+    time = timing.usb_control
+    if ctrl == VEN_REQ_DRAW_TILES:
+        column, rows, pixels = value >> 8, 0, 0
+        for i in range(len(data or b'')):
+            if not i or not column:
+                rows += 1
+            pixels += min(TILE_SIZE, OLED_WIDTH - column)
+            column += TILE_SIZE
+            if column >= OLED_WIDTH:
+                column = 0
+        time += (rows * (i2ctime(timing, ENCODER_LOCATE) + i2ctime(timing, 2))
+                 + pixels * timing.i2c_byte() + i2ctime(timing, ENCODER_LOCATE))
+    return time
+
+# Collects the requests of a candidate and their time, send() replays them
+class _CostBridge(Bridge):
+    def __init__(self, bridge, timing):
+        self.transport  = bridge.transport
+        self.max_stream = bridge.max_stream
+        self.geometry   = bridge.geometry
+        self.timing     = timing
+        self.calls      = []        # (control request, arguments)
+        self.time       = 0.0
+
+    def sendstream(self, stream):
+        self.calls.append((False, (bytes(stream),)))
+        self.time += streamtime(self.transport, len(stream), self.timing)
+
+    def sendcontrol(self, ctrl, value = 0, index = 0, data = None):
+        self.calls.append((True, (ctrl, value, index, data)))
+        self.time += controltime(ctrl, value, data, self.timing)
+
+    def send(self, bridge):
+        for control, args in self.calls:
+            if control:
+                bridge.sendqueued(*args)
+            else:
+                bridge.sendstream(*args)
+
+
+# ===================================================================================
+# Frame Encoder
+# ===================================================================================
+
+class FrameEncoder():
+    def __init__(self, bridge, timing = None):
+        self.bridge   = bridge
+        self.geometry = bridge.geometry
+        self.timing   = timing or getattr(bridge, 'timing', None) or Timing()
+        self.shown    = None        # frame on the display (None: unknown)
+        self.windowed = True        # address window may not be the full frame
+        self.tiles    = {}          # tile content: index in the tile table
+        self.stats    = dict.fromkeys(ENCODINGS + ['none'], 0)
+        self.time     = 0.0         # estimated time of all frames sent
+        self.features = bridge.features()
+        if timing is None:
+            try:
+                if bridge.readconfig()['speed'] == CFG_SPEED_SLOW:
+                    self.timing = Timing()
+                    self.timing.i2c_clock = ENCODER_SLOW
+            except Exception:
+                pass
+
+    # Encodings the device supports
+    def encodings(self):
+        result = ['frame', 'window', 'spans']
+        if self.tiles and self.geometry.window is None and self.features & FEATURE_TILES:
+            result.append('tiles')
+        return result
+
+    # Store tiles in the tile table of the device, they are then used for the cells
+    # of a frame with the same content
+    def loadtiles(self, tiles, first = 0):
+        tiles = [bytes(tile) for tile in tiles]
+        self.bridge.loadtiles(first, tiles)
+        for tile, index in list(self.tiles.items()):
+            if first <= index < first + len(tiles):
+                del self.tiles[tile]
+        for i, tile in enumerate(tiles):
+            self.tiles.setdefault(tile, first + i)
+
+    # Estimated time in s of each applicable encoding of the frame
+    def estimate(self, frame):
+        return {name: cost.time for name, cost in self._candidates(bytes(frame)).items()}
+
+    # Send frame in the cheapest encoding, returns its name ('none': no change)
+    def send(self, frame):
+        frame = bytes(frame)
+        if len(frame) != self.geometry.frame:
+            raise Exception('Frame must have %d bytes' % self.geometry.frame)
+        candidates = self._candidates(frame)
+        if not candidates:
+            self.stats['none'] += 1
+            return 'none'
+        name = min(candidates, key = lambda n: candidates[n].time)
+        candidates[name].send(self.bridge)
+        self.shown    = frame
+        self.windowed = name in ('window', 'spans')
+        self.stats[name] += 1
+        self.time += candidates[name].time
+        return name
+
+    # Forget the displayed frame, the next frame is sent completely
+    def invalidate(self):
+        self.shown = None
+
+    # Set the address window back to the full frame of the panel
+    def close(self):
+        if self.windowed:
+            self.bridge.restorewindow()
+            self.windowed = False
+
+    # Requests of each candidate (dict name: _CostBridge), empty if nothing changed
+    def _candidates(self, frame):
+        width = self.geometry.width
+        spans = []                              # changed columns per page
+        for page in range(self.geometry.pages):
+            row = frame[page*width:(page+1)*width]
+            if self.shown is None:
+                spans.append((page, 0, width - 1))
+                continue
+            old  = self.shown[page*width:(page+1)*width]
+            diff = [x for x in range(width) if row[x] != old[x]]
+            if diff:
+                spans.append((page, diff[0], diff[-1]))
+        if not spans:
+            return {}
+        available  = self.encodings()
+        candidates = {}
+        cost = candidates['frame'] = _CostBridge(self.bridge, self.timing)
+        if self.windowed and self.geometry.window is None:
+            cost.restorewindow()
+        cost.sendframe(frame)
+        if self.shown is not None:
+            cost = candidates['window'] = _CostBridge(self.bridge, self.timing)
+            p0, p1 = spans[0][0], spans[-1][0]
+            c0, c1 = min(s[1] for s in spans), max(s[2] for s in spans)
+            cost.sendwindow((p0, p1), (c0, c1), b''.join(
+                frame[p*width+c0:p*width+c1+1] for p in range(p0, p1 + 1)))
+            cost = candidates['spans'] = _CostBridge(self.bridge, self.timing)
+            for page, c0, c1 in spans:
+                cost.sendwindow((page, page), (c0, c1), frame[page*width+c0:page*width+c1+1])
+        if 'tiles' in available:
+            runs = self._tileruns(frame)
+            if runs is not None:
+                cost = candidates['tiles'] = _CostBridge(self.bridge, self.timing)
+                for start, indices in runs:
+                    page, column = divmod(start, TILEMAP_COLUMNS)
+                    cost.drawtiles(page, column * TILE_SIZE, indices)
+        return candidates
+
+    # Runs of tile indices (start cell, indices) for the changed cells, None if a
+    # changed cell is not in the tile table
+    def _tileruns(self, frame):
+        cells = [self.tiles.get(frame[page*OLED_WIDTH+x:page*OLED_WIDTH+x+TILE_SIZE])
+                 for page in range(OLED_PAGES) for x in range(0, OLED_WIDTH, TILE_SIZE)]
+        runs, last = [], None
+        for i, index in enumerate(cells):
+            offset = i // TILEMAP_COLUMNS * OLED_WIDTH + i % TILEMAP_COLUMNS * TILE_SIZE
+            if (self.shown is not None and
+                    frame[offset:offset+TILE_SIZE] == self.shown[offset:offset+TILE_SIZE]):
+                continue
+            if index is None:
+                return None
+            if last is not None and i - last <= TILEMAP_GAP and \
+                    None not in cells[last:i]:
+                runs[-1][1].extend(cells[last:i + 1])
+            else:
+                runs.append((i, [index]))
+            last = i + 1
+        return [(start, bytes(indices)) for start, indices in runs]
@@ -0,0 +1,309 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   USB OLED Framebuffer Daemon for CH551, CH552, CH554
+# Version:   v1.0
+# Year:      2022
+# Author:    Stefan Wagner
+# Github:    https://github.com/wagiminator
+# License:   http://creativecommons.org/licenses/by-sa/3.0/
+# ===================================================================================
+#
+# Description:
+# ------------
+# Shares one display between any number of local programs. The daemon owns the
+# bridge and exposes the display as a framebuffer file in the byte order of the
+# display RAM (geometry.frame bytes, 1024 on 128x64 panels), which the clients map
+# into memory and write directly. A client then reports the changed bytes on the
+# Unix domain socket of the daemon (damage notification). The daemon collects the
+# reports of all clients for a short time, compares the damaged pages with the
+# content of the display and sends only the changed column spans, neighbouring
+# pages in one address window. Clients need neither USB access nor a bridge
+# protocol, and many small updates cost one transfer.
+#
+# Socket protocol (one line per request):
+#   DAMAGE <offset> <length>    bytes of the framebuffer changed (no response)
+#   SYNC                        response 'OK' when all reported damage is sent
+#   INFO                        response '<width> <height>'
+#
+# Usage examples:
+# ---------------
+# python3 oled_framebuffer.py -t vendor             (daemon)
+# python3 oled_framebuffer.py -b emulator -g 128x32 --fb /tmp/oled-fb
+#
+# from oled_framebuffer import FramebufferClient
+# fb = FramebufferClient()
+# fb.write(0, [0xFF] * 128)                         (first page lit)
+# fb.sync()
+#
+# Dependencies:
+# -------------
+# - pyserial / pyusb (only for real devices)
+
+import os
+import sys
+import mmap
+import time
+import socket
+import argparse
+import selectors
+import tempfile
+from oled_bridge import open_bridge, TRANSPORTS, BACKENDS, GEOMETRIES
+
+FB_DIR      = '/dev/shm' if os.path.isdir('/dev/shm') else tempfile.gettempdir()
+FB_PATH     = os.path.join(FB_DIR, 'oled-fb')     # framebuffer file
+FB_SOCKET   = '.sock'                             # socket: framebuffer path + suffix
+FB_COALESCE = 0.005         # time in s to collect damage reports before sending
+FB_JOIN     = 16            # extra bytes accepted to send two pages in one window
+FB_ORDER    = ['vendor', 'cdc', 'hid']            # fastest bridge first
+
+# ===================================================================================
+# Daemon
+# ===================================================================================
+
+class FramebufferDaemon():
+    def __init__(self, bridge, path = FB_PATH, coalesce = FB_COALESCE):
+        self.bridge   = bridge
+        self.geometry = bridge.geometry
+        self.path     = path
+        self.coalesce = coalesce
+        self.shown    = None                          # display content (None: unknown)
+        self.dirty    = set()                         # damaged pages
+        self.since    = None                          # time of the first damage report
+        self.waiting  = []                            # clients waiting for SYNC
+        self.stats    = {'reports': 0, 'updates': 0, 'bytes': 0}
+        with open(path, 'wb') as f:
+            f.write(bytes(self.geometry.frame))
+        self.file = open(path, 'r+b')
+        self.fb   = mmap.mmap(self.file.fileno(), self.geometry.frame)
+        if os.path.exists(path + FB_SOCKET):
+            os.unlink(path + FB_SOCKET)
+        self.server = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.server.bind(path + FB_SOCKET)
+        self.server.listen()
+        self.server.setblocking(False)
+        self.selector = selectors.DefaultSelector()
+        self.selector.register(self.server, selectors.EVENT_READ)
+        self.buffers  = {}                            # received partial lines per client
+
+    # Serve the clients until stop() or KeyboardInterrupt
+    def run(self):
+        self.running = True
+        self.damage(0, self.geometry.frame)           # show the initial (blank) frame
+        while self.running:
+            self.poll()
+
+    def stop(self):
+        self.running = False
+
+    # Handle socket events, send the damage when the coalescing time is over
+    def poll(self):
+        timeout = None
+        if self.dirty:
+            timeout = max(0, self.since + self.coalesce - time.monotonic())
+        for key, _ in self.selector.select(timeout):
+            if key.fileobj is self.server:
+                client, _ = self.server.accept()
+                client.setblocking(False)
+                self.selector.register(client, selectors.EVENT_READ)
+                self.buffers[client] = b''
+            else:
+                self._receive(key.fileobj)
+        if self.dirty and time.monotonic() >= self.since + self.coalesce:
+            self.flush()
+
+    # Mark bytes of the framebuffer as changed
+    def damage(self, offset, length):
+        width  = self.geometry.width
+        offset = max(0, offset)
+        end    = min(self.geometry.frame, offset + length)
+        if end <= offset:
+            return
+        if not self.dirty:
+            self.since = time.monotonic()
+        self.dirty.update(range(offset // width, (end - 1) // width + 1))
+        self.stats['reports'] += 1
+
+    # Send the changed spans of the damaged pages
+    def flush(self):
+        width = self.geometry.width
+        frame = self.fb[:]
+        spans = []                                    # [first page, last page, c0, c1]
+        for page in sorted(self.dirty):
+            row = frame[page*width:(page+1)*width]
+            if self.shown is None:
+                c0, c1 = 0, width - 1
+            else:
+                old = self.shown[page*width:(page+1)*width]
+                diff = [x for x in range(width) if row[x] != old[x]]
+                if not diff:
+                    continue
+                c0, c1 = diff[0], diff[-1]
+            last = spans[-1] if spans else None
+            if last and last[1] == page - 1 and not self.geometry.pageonly:
+                u0, u1 = min(last[2], c0), max(last[3], c1)
+                joined = (page - last[0] + 1) * (u1 - u0 + 1)
+                single = (page - last[0]) * (last[3] - last[2] + 1) + c1 - c0 + 1
+                if joined <= single + FB_JOIN:        # one window for both
+                    last[1:] = [page, u0, u1]
+                    continue
+            spans.append([page, page, c0, c1])
+        for p0, p1, c0, c1 in spans:
+            data = b''.join(frame[p*width+c0:p*width+c1+1] for p in range(p0, p1 + 1))
+            self.bridge.sendwindow((p0, p1), (c0, c1), data)
+            self.stats['bytes'] += len(data)
+        self.stats['updates'] += len(spans)
+        self.shown = frame
+        self.dirty.clear()
+        for client in self.waiting:
+            self._send(client, b'OK\n')
+        self.waiting = []
+
+    def close(self):
+        self.bridge.restorewindow()
+        for key in list(self.selector.get_map().values()):
+            key.fileobj.close()
+        self.selector.close()
+        os.unlink(self.path + FB_SOCKET)
+        self.fb.close()
+        self.file.close()
+
+    def _receive(self, client):
+        try:
+            data = client.recv(4096)
+        except OSError:
+            data = b''
+        if not data:                                  # client closed the connection
+            self.selector.unregister(client)
+            del self.buffers[client]
+            if client in self.waiting:
+                self.waiting.remove(client)
+            client.close()
+            return
+        lines = (self.buffers[client] + data).split(b'\n')
+        self.buffers[client] = lines.pop()
+        for line in lines:
+            words = line.split()
+            if not words:
+                continue
+            if words[0] == b'DAMAGE' and len(words) == 3:
+                try:
+                    offset, length = int(words[1]), int(words[2])
+                except ValueError:              # bad input must not stop the daemon
+                    self._send(client, b'ERROR\n')
+                    continue
+                self.damage(offset, length)
+            elif words[0] == b'SYNC':
+                if self.dirty:
+                    self.waiting.append(client)
+                else:
+                    self._send(client, b'OK\n')
+            elif words[0] == b'INFO':
+                self._send(client, b'%d %d\n' % (self.geometry.width, self.geometry.height))
+            else:
+                self._send(client, b'ERROR\n')
+
+    def _send(self, client, data):
+        try:
+            client.sendall(data)
+        except OSError:
+            pass                                      # cleaned up at the next receive
+
+
+# ===================================================================================
+# Client
+# ===================================================================================
+
+class FramebufferClient():
+    def __init__(self, path = FB_PATH):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(path + FB_SOCKET)
+        self.file = self.sock.makefile('rwb')
+        self.width, self.height = [int(x) for x in self._request(b'INFO').split()]
+        self.size = self.width * (self.height // 8)
+        with open(path, 'r+b') as f:
+            self.fb = mmap.mmap(f.fileno(), self.size)
+
+    # Write bytes (display RAM byte order) at offset and report them
+    def write(self, offset, data):
+        data = bytes(data)
+        self.fb[offset:offset+len(data)] = data
+        self.damage(offset, len(data))
+
+    # Report bytes that were changed directly in self.fb
+    def damage(self, offset = 0, length = None):
+        if length is None:
+            length = self.size - offset
+        self.file.write(b'DAMAGE %d %d\n' % (offset, length))
+        self.file.flush()
+
+    # Wait until the reported changes are on the display
+    def sync(self):
+        self._request(b'SYNC')
+
+    def close(self):
+        self.fb.close()
+        self.file.close()
+        self.sock.close()
+
+    def _request(self, request):
+        self.file.write(request + b'\n')
+        self.file.flush()
+        response = self.file.readline().strip()
+        if not response or response == b'ERROR':
+            raise Exception('Framebuffer daemon did not accept ' + request.decode())
+        return response
+
+
+# ===================================================================================
+# Main Function
+# ===================================================================================
+
+def _main():
+    parser = argparse.ArgumentParser(description = 'USB OLED framebuffer daemon')
+    parser.add_argument('-t', '--transport', choices = list(TRANSPORTS),
+                        help = 'transport of the bridge (default: fastest one found)')
+    parser.add_argument('-b', '--backend', default = 'device', choices = BACKENDS,
+                        help = 'real hardware, emulated device or simulated firmware')
+    parser.add_argument('-g', '--geometry', default = '128x64', choices = list(GEOMETRIES),
+                        help = 'panel geometry (size of the framebuffer)')
+    parser.add_argument('--fb', default = FB_PATH,
+                        help = 'framebuffer file (socket: same name + ' + FB_SOCKET + ')')
+    parser.add_argument('--coalesce', type = float, default = FB_COALESCE * 1000,
+                        help = 'time in ms to collect damage reports')
+    args = parser.parse_args()
+
+    try:
+        oled   = openfastest(args)
+        daemon = FramebufferDaemon(oled, args.fb, args.coalesce / 1000)
+        print('Serving %s (%s bridge), Ctrl+C to stop ...' % (args.fb, oled.transport))
+        try:
+            daemon.run()
+        except KeyboardInterrupt:
+            pass
+        finally:
+            daemon.close()
+            oled.close()
+        print('  %(reports)d damage reports, %(updates)d windows, %(bytes)d bytes sent'
+              % daemon.stats)
+    except Exception as ex:
+        sys.stderr.write('ERROR: ' + str(ex) + '!\n')
+        sys.exit(1)
+
+    print('DONE.')
+    sys.exit(0)
+
+# Open the given transport or the fastest bridge that is connected
+def openfastest(args):
+    for transport in [args.transport] if args.transport else FB_ORDER:
+        try:
+            return open_bridge(transport, args.backend, args.geometry)
+        except Exception:
+            if args.transport:
+                raise
+    raise Exception('No bridge found')
+
+
+# ===================================================================================
+
+if __name__ == "__main__":
+    _main()
@@ -0,0 +1,266 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   USB OLED Image Processing for CH551, CH552, CH554
+# Version:   v1.0
+# Year:      2022
+# Author:    Stefan Wagner
+# Github:    https://github.com/wagiminator
+# License:   http://creativecommons.org/licenses/by-sa/3.0/
+# ===================================================================================
+#
+# Description:
+# ------------
+# Turns images and animations into frames in the byte order of the SSD1306 display
+# RAM: decoding (everything Pillow reads, animated GIFs frame by frame), scaling to
+# the panel, dithering to one bit per pixel and packing into pages. All per-pixel
+# work except the error diffusion runs on whole numpy arrays (vectorized), the
+# error diffusion only keeps its unavoidable left-to-right dependency in a loop.
+#
+# VideoStream sends a sequence of frames in real time: each frame in the encoding
+# that is the fastest for the bridge and the changes (see oled_encoder.py), frames
+# that are already late are skipped.
+#
+# convertimage() converts a still image into page format for assets, formatpython()
+# and formatc() turn the result into a Python list or a C __code array. Converted
+# images are kept in a cache, indexed by the hash of the file content and the
+# options, so that asset builds are instant and do not depend on anything online.
+#
+# Usage example:
+# --------------
+# from oled_bridge import open_bridge
+# from oled_image import loadframes, dither, packpages, VideoStream
+# oled   = open_bridge('vendor')
+# stream = VideoStream(oled)
+# for gray, duration in loadframes('animation.gif', 128, 64):
+#     stream.show(packpages(dither(gray, 'floyd')), duration)
+# stream.close()
+#
+# Dependencies:
+# -------------
+# - numpy
+# - pillow
+
+import os
+import io
+import json
+import hashlib
+import numpy as np
+from PIL import Image, ImageSequence
+from oled_bridge import OLED_WIDTH
+
+# ===================================================================================
+# Loading and Scaling
+# ===================================================================================
+
+DEFAULT_DURATION = 0.1      # frame duration in s if the file has none
+
+# Gray values (float32 array height x width, 0 - 255) of a Pillow image. fit keeps
+# the aspect ratio (black borders), otherwise the image is stretched to the panel.
+def scaleimage(image, width, height, fit = True):
+    if image.mode in ('RGBA', 'LA', 'P'):
+        image = image.convert('RGBA')
+        background = Image.new('RGBA', image.size, (0, 0, 0, 255))
+        image = Image.alpha_composite(background, image)    # transparent: black
+    image = image.convert('L')
+    if fit:
+        scale  = min(width / image.width, height / image.height)
+        size   = (max(1, round(image.width * scale)), max(1, round(image.height * scale)))
+        canvas = Image.new('L', (width, height))
+        canvas.paste(image.resize(size, Image.LANCZOS),
+                     ((width - size[0]) // 2, (height - size[1]) // 2))
+        image  = canvas
+    else:
+        image  = image.resize((width, height), Image.LANCZOS)
+    return np.asarray(image, dtype = np.float32)
+
+# Frames of an image file or a list of image files: (gray values, duration in s)
+def loadframes(files, width, height, fit = True):
+    if isinstance(files, str):
+        files = [files]
+    for filename in files:
+        with Image.open(filename) as image:
+            for frame in ImageSequence.Iterator(image):
+                duration = frame.info.get('duration', 0) / 1000 or DEFAULT_DURATION
+                yield scaleimage(frame, width, height, fit), duration
+
+
+# ===================================================================================
+# Dithering
+# ===================================================================================
+
+# Bayer threshold matrix (size x size, size a power of 2), values 0 - 255
+def bayer(size = 8):
+    matrix = np.zeros((1, 1), dtype = np.int32)
+    while matrix.shape[0] < size:
+        matrix = np.block([[4 * matrix,     4 * matrix + 2],
+                           [4 * matrix + 3, 4 * matrix + 1]])
+    return (matrix + 0.5) * 256 / matrix.size
+
+# Blue noise threshold matrix: white noise that is repeatedly high-pass filtered and
+# equalized, so the thresholds have no low frequency clusters. Deterministic (seed).
+def bluenoise(size = 64, seed = 1, rounds = 8):
+    noise  = np.random.default_rng(seed).random((size, size))
+    freq   = np.fft.fftfreq(size)
+    radius = np.sqrt(freq[:, None] ** 2 + freq[None, :] ** 2)
+    for _ in range(rounds):
+        noise = np.real(np.fft.ifft2(np.fft.fft2(noise) * radius))
+        noise = np.argsort(np.argsort(noise, axis = None)).reshape(size, size)
+    return (noise + 0.5) * 256 / noise.size
+
+_MATRICES = {}
+
+# Threshold matrix of a method, tiled to the size of the image
+def _thresholds(method, height, width):
+    if method not in _MATRICES:
+        _MATRICES[method] = bayer() if method == 'ordered' else bluenoise()
+    matrix = _MATRICES[method]
+    reps   = (-(-height // matrix.shape[0]), -(-width // matrix.shape[1]))
+    return np.tile(matrix, reps)[:height, :width]
+
+# Floyd-Steinberg error diffusion. The error to the next row is added for a whole
+# row at once, only the error to the right neighbour needs the pixel loop.
+def _floyd(gray, level):
+    height, width = gray.shape
+    bits  = np.zeros((height, width), dtype = bool)
+    below = np.zeros(width + 2, dtype = np.float32)     # error for the next row
+    for y in range(height):
+        row    = (gray[y] + below[1:-1]).tolist()
+        errors = [0.0] * width
+        lit    = [False] * width
+        carry  = 0.0
+        for x in range(width):
+            value = row[x] + carry
+            if value >= level:
+                lit[x] = True
+                value -= 255.0
+            errors[x] = value
+            carry = value * 0.4375                      # 7/16 to the right
+        bits[y] = lit
+        err   = np.asarray(errors, dtype = np.float32)
+        below = np.zeros(width + 2, dtype = np.float32)
+        below[:-2] += err * 0.1875                      # 3/16 below left
+        below[1:-1] += err * 0.3125                     # 5/16 below
+        below[2:]  += err * 0.0625                      # 1/16 below right
+    return bits
+
+DITHERS = ['floyd', 'ordered', 'bluenoise', 'threshold']
+
+# One bit per pixel (bool array) of gray values with the given method
+def dither(gray, method = 'floyd', level = 128):
+    gray = np.asarray(gray, dtype = np.float32)
+    if method == 'threshold':
+        return gray >= level
+    if method == 'floyd':
+        return _floyd(gray, level)
+    if method in ('ordered', 'bluenoise'):
+        return gray >= _thresholds(method, *gray.shape) + (level - 128)
+    raise Exception('Unknown dither method ' + str(method))
+
+
+# ===================================================================================
+# Page Format
+# ===================================================================================
+
+# Pack pixels (bool array height x width, height a multiple of 8) into display RAM
+# byte order: pages top down, one byte per column, bit 0 is the top line of a page
+def packpages(bits):
+    bits = np.asarray(bits, dtype = bool)
+    height, width = bits.shape
+    if height % 8:
+        raise Exception('Height must be a multiple of 8')
+    pages = bits.reshape(height // 8, 8, width)
+    return np.packbits(pages, axis = 1, bitorder = 'little').tobytes()
+
+
+# ===================================================================================
+# Image Conversion
+# ===================================================================================
+
+CONVERT_VERSION = 1         # change when the result of the conversion changes
+CONVERT_CACHE   = os.path.join(os.path.expanduser('~'), '.cache', 'oled-convert')
+
+# Convert the first frame of an image file into page format. cache: directory of
+# the cache (None: no cache).
+def convertimage(filename, width = OLED_WIDTH, height = 64, method = 'threshold',
+                 level = 128, invert = False, fit = True, cache = None):
+    with open(filename, 'rb') as f:
+        data = f.read()
+    options = json.dumps([CONVERT_VERSION, width, height, method, level, invert, fit])
+    key  = hashlib.sha256(options.encode() + data).hexdigest()
+    path = os.path.join(cache, key + '.bin') if cache else None
+    if path and os.path.exists(path):
+        with open(path, 'rb') as f:
+            return f.read()
+    with Image.open(io.BytesIO(data)) as image:
+        gray = scaleimage(image, width, height, fit)
+    if invert:
+        gray = 255 - gray
+    frame = packpages(dither(gray, method, level))
+    if path:
+        os.makedirs(cache, exist_ok = True)
+        with open(path + '.tmp', 'wb') as f:
+            f.write(frame)
+        os.replace(path + '.tmp', path)             # never leave half written entries
+    return frame
+
+# Python list of the bytes, 10 per line (like the pictures of the demos)
+def formatpython(name, data, comment = None):
+    lines = ['# ' + comment] if comment else []
+    rows  = [', '.join('0x%02X' % b for b in data[i:i+10]) for i in range(0, len(data), 10)]
+    lines.append(name + ' = [')
+    lines.append(',\n'.join(rows) + ']')
+    return '\n'.join(lines) + '\n'
+
+# C array in code flash (SDCC), 16 bytes per line
+def formatc(name, data, comment = None):
+    lines = ['// ' + comment] if comment else []
+    rows  = ['  ' + ', '.join('0x%02X' % b for b in data[i:i+16])
+             for i in range(0, len(data), 16)]
+    lines.append('__code uint8_t %s[%d] = {' % (name, len(data)))
+    lines.append(',\n'.join(rows))
+    lines.append('};')
+    return '\n'.join(lines) + '\n'
+
+
+# ===================================================================================
+# Video Stream
+# ===================================================================================
+
+# Sends frames (display RAM byte order, size of the panel geometry) with the pacing
+# of their durations. Only the range of pages that changed is written. A frame that
+# is due while the next one is already due as well is skipped.
+class VideoStream():
+    def __init__(self, bridge):
+        from oled_encoder import FrameEncoder
+        self.bridge   = bridge
+        self.encoder  = FrameEncoder(bridge)
+        self.due      = None            # time the next frame is due
+        self.frames   = 0               # frames shown
+        self.skipped  = 0               # frames skipped (too late)
+
+    # Show frame for duration seconds, returns False if it was skipped
+    def show(self, frame, duration):
+        now = self.bridge.clock()
+        if self.due is None:
+            self.due = now
+        due, self.due = self.due, self.due + duration
+        if now > self.due:                              # next frame is due already
+            self.skipped += 1
+            return False
+        if now < due:
+            self.bridge.sleep(due - now)
+        self.update(frame)
+        self.frames += 1
+        return True
+
+    # Write the changes of the frame on the display, returns the encoding used
+    def update(self, frame):
+        return self.encoder.send(frame)
+
+    # Forget the displayed frame, the next frame is sent completely
+    def invalidate(self):
+        self.encoder.invalidate()
+
+    # Set the address window back to the full frame of the panel
+    def close(self):
+        self.encoder.close()
@@ -0,0 +1,424 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   USB OLED Multi-Device Manager for CH551, CH552, CH554
+# Version:   v1.0
+# Year:      2022
+# Author:    Stefan Wagner
+# Github:    https://github.com/wagiminator
+# License:   http://creativecommons.org/licenses/by-sa/3.0/
+# ===================================================================================
+#
+# Description:
+# ------------
+# Finds all connected CDC, HID and vendor class bridges and drives any number of
+# them concurrently from one event loop. Each device has its own job queue and at
+# most one job in progress: a slow or hanging device only delays its own queue.
+# Jobs that only send I2C transactions (MANAGER_STREAMS: frames, windows, commands)
+# are built in the loop and written to the non-blocking file descriptors of the
+# devices, which wait in one selector (epoll on Linux):
+# - HID:    output reports to the hidraw node (HidrawBridge without writer thread).
+# - CDC:    RTS set, the data to the serial port, RTS cleared when the output queue
+#           of the tty is empty.
+# All devices of these transports transfer at the same time with one thread, the
+# aggregate throughput is limited by the USB host controllers. The vendor bridge
+# (and the HID bridge without hidraw) is driven by pyusb, which has no asynchronous
+# transfers, like the jobs that read from a device (counters(), readconfig(), ...)
+# and the other backends (sim, emulator): these jobs run on a small fixed pool of
+# MANAGER_WORKERS threads, so at most that many of them transfer at once.
+# Frames that are still queued when a newer frame for the same device arrives are
+# replaced by it, so a slow device shows fewer frames instead of falling behind.
+#
+# The devices are identified by transport and USB serial number. All bridges of a
+# firmware build have the same serial number (SERIAL_STR in src/config.h), so the
+# USB port path is appended if several devices share one: 'vendor:CH55x@1-4.2'.
+#
+# submit() returns a concurrent.futures.Future (asyncio: asyncio.wrap_future()).
+#
+# Usage example:
+# --------------
+# from oled_manager import BridgeManager
+# manager = BridgeManager()
+# for id in manager.open():
+#     manager.sendframe(id, [0x55] * 1024)
+# manager.wait()
+# manager.close()
+#
+# python3 oled_manager.py           (lists the connected bridges)
+#
+# Dependencies:
+# -------------
+# - pyserial (CDC bridge)
+# - pyusb    (vendor class bridge, HID bridge without hidraw)
+
+import os
+import time
+import socket
+import threading
+import selectors
+from queue import Queue
+from collections import deque
+from concurrent.futures import Future
+from oled_bridge import Bridge, CDCBridge, HidrawBridge, open_bridge, usbpath, hidrawdevices
+from oled_bridge import TRANSPORTS, VENDOR_ID, CDC_PRODUCT_ID, HID_PRODUCT_ID, VEN_PRODUCT_ID
+from oled_bridge import HID_REPORT_DATA
+
+MANAGER_WORKERS = 4         # threads for the jobs that block (pyusb, reading, sim)
+MANAGER_QUEUE   = 16        # max number of queued jobs per device
+MANAGER_TIMEOUT = 1.0       # max time in s to wait until a device accepts data
+MANAGER_POLL    = 0.0005    # time in s between the checks of the CDC output queue
+MANAGER_GAP     = 0.001     # pause in s after the RTS release (as CDCBridge)
+MANAGER_STREAMS = ['sendstream', 'senddata', 'sendcommand', 'sendframe', 'sendwindow',
+                   'restorewindow', 'clearscreen', 'scroll']
+
+# ===================================================================================
+# Device Enumeration
+# ===================================================================================
+
+# All connected bridges: list of dicts with id, transport, serial, path and the
+# backend and arguments for open_bridge() (HID bridges via hidraw on Linux)
+def findbridges(transports = list(TRANSPORTS)):
+    found = []
+    if 'cdc' in transports:
+        from serial.tools.list_ports import comports
+        for p in comports():
+            if p.vid == VENDOR_ID and p.pid == CDC_PRODUCT_ID:
+                found.append({'transport': 'cdc', 'serial': p.serial_number or '',
+                              'path': (p.location or p.device).split(':')[0],
+                              'backend': 'device', 'open': {'port': p.device}})
+    if 'hid' in transports and os.path.isdir('/sys/class/hidraw'):
+        for node in hidrawdevices():
+            serial, path = hidrawinfo(node)
+            found.append({'transport': 'hid', 'serial': serial, 'path': path,
+                          'backend': 'hidraw', 'open': {'path': node, 'queued': False}})
+        transports = [t for t in transports if t != 'hid']
+    for transport, pid in (('hid', HID_PRODUCT_ID), ('vendor', VEN_PRODUCT_ID)):
+        if transport not in transports:
+            continue
+        import usb.core
+        for dev in usb.core.find(find_all = True, idVendor = VENDOR_ID, idProduct = pid):
+            try:
+                serial = dev.serial_number or ''
+            except Exception:
+                serial = ''                         # no access to the string descriptor
+            found.append({'transport': transport, 'serial': serial, 'path': usbpath(dev),
+                          'backend': 'device', 'open': {'dev': dev}})
+    names = [(d['transport'], d['serial']) for d in found]
+    for d in found:
+        d['id'] = d['transport'] + ':' + d['serial']
+        if names.count((d['transport'], d['serial'])) > 1:
+            d['id'] += '@' + d['path']
+    return found
+
+# Serial number and USB port path ('1-4.2', as usbpath()) of a hidraw node
+def hidrawinfo(node):
+    device = '/sys/class/hidraw/%s/device' % os.path.basename(node)
+    serial = ''
+    with open(device + '/uevent') as f:
+        for line in f:
+            if line.startswith('HID_UNIQ='):
+                serial = line.strip()[9:]
+    interface = os.path.basename(os.path.dirname(os.path.realpath(device)))
+    return serial, interface.split(':')[0]
+
+
+# ===================================================================================
+# Transfer Steps of the Event Loop
+# ===================================================================================
+
+# Generators that send the I2C transactions of a job. They yield what they wait
+# for: a file descriptor (until it is writable) or a time in s.
+
+def _hidrawsteps(bridge, streams):
+    for stream in streams:
+        report = bytes([HID_REPORT_DATA]) + stream
+        while True:
+            try:
+                os.write(bridge.fd, report)
+                break
+            except BlockingIOError:
+                yield bridge.fd
+
+def _cdcsteps(bridge, streams):
+    fd = bridge.ser.fileno()
+    for stream in streams:
+        bridge.ser.rts = True
+        try:
+            while stream:
+                try:
+                    stream = stream[os.write(fd, stream):]
+                except BlockingIOError:
+                    yield fd
+            while bridge.ser.out_waiting:           # data not yet sent to the device
+                yield MANAGER_POLL
+        finally:
+            bridge.ser.rts = False                  # stop condition, also on timeout
+        yield MANAGER_GAP
+
+# Steps of a bridge for the event loop, None if its jobs have to run on the pool
+def _steps(bridge):
+    if 'sendstream' in vars(bridge):                # replaced (e.g. by oled_record.py)
+        return None
+    if isinstance(bridge, HidrawBridge) and not bridge.thread:
+        return _hidrawsteps
+    if isinstance(bridge, CDCBridge):
+        os.set_blocking(bridge.ser.fileno(), False)
+        return _cdcsteps
+    return None
+
+# Collects the I2C transactions of a job (methods of MANAGER_STREAMS)
+class _Capture(Bridge):
+    def __init__(self, bridge):
+        self.transport  = bridge.transport
+        self.max_stream = bridge.max_stream
+        self.geometry   = bridge.geometry
+        self.streams    = []
+
+    def sendstream(self, stream):
+        if self.max_stream is not None and len(stream) > self.max_stream:
+            raise Exception('Transaction too long for the ' + self.transport + ' bridge')
+        self.streams.append(bytes(stream))
+
+
+# ===================================================================================
+# Manager Class
+# ===================================================================================
+
+class _Device():
+    def __init__(self, id, bridge):
+        self.id        = id
+        self.bridge    = bridge
+        self.steps     = _steps(bridge)     # None: all jobs on the pool
+        self.jobs      = deque()            # (future, method, args, is frame)
+        self.scheduled = False              # has queued jobs or one in progress
+        self.job       = None               # job in progress (future, is frame)
+        self.task      = None               # its generator (event loop)
+        self.wait      = None               # (fd or None, time in s) of the generator
+        self.stats     = {'jobs': 0, 'frames': 0, 'replaced': 0, 'errors': 0}
+
+class BridgeManager():
+    def __init__(self, workers = MANAGER_WORKERS, queue = MANAGER_QUEUE):
+        self.devices  = {}
+        self.limit    = queue
+        self.lock     = threading.Lock()
+        self.idle     = threading.Condition(self.lock)
+        self.ready    = deque()             # devices with queued jobs (event loop)
+        self.finished = deque()             # (device, result, error) of the pool jobs
+        self.blocking = Queue()             # (device, method, args) for the pool
+        self.running  = True
+        self.selector = selectors.DefaultSelector()
+        self.wakeup, self.waker = socket.socketpair()
+        self.wakeup.setblocking(False)
+        self.waker.setblocking(False)
+        self.selector.register(self.wakeup, selectors.EVENT_READ)
+        self.threads  = [threading.Thread(target = self._loop, daemon = True)]
+        self.threads += [threading.Thread(target = self._worker, daemon = True)
+                         for _ in range(max(1, workers))]
+        for thread in self.threads:
+            thread.start()
+
+    # Open all connected bridges, returns their ids
+    def open(self, transports = list(TRANSPORTS), geometry = '128x64', setup = True):
+        ids = []
+        for info in findbridges(transports):
+            bridge = open_bridge(info['transport'], info['backend'], geometry,
+                                 setup = setup, **info['open'])
+            self.add(info['id'], bridge)
+            ids.append(info['id'])
+        return ids
+
+    # Add an opened bridge (any backend)
+    def add(self, id, bridge):
+        with self.lock:
+            if id in self.devices:
+                raise Exception('Device ' + id + ' already added')
+            self.devices[id] = _Device(id, bridge)
+
+    def bridge(self, id):
+        return self.devices[id].bridge
+
+    # Queue call of a bridge method (name) for a device, returns a Future
+    def submit(self, id, method, *args):
+        return self._queue(id, method, args, False)
+
+    # Queue frame (sendframe()), replaces a frame of the device that is still queued
+    def sendframe(self, id, frame):
+        return self._queue(id, 'sendframe', (bytes(frame),), True)
+
+    # Wait until all queues are empty
+    def wait(self):
+        with self.lock:
+            self.idle.wait_for(lambda: not any(d.scheduled for d in self.devices.values()))
+
+    # Counters of each device: jobs done, frames sent, frames replaced, errors
+    def stats(self):
+        with self.lock:
+            return {id: dict(d.stats) for id, d in self.devices.items()}
+
+    # Finish the queued jobs and close all bridges
+    def close(self):
+        self.wait()
+        self.running = False
+        self._wake()
+        for _ in self.threads[1:]:
+            self.blocking.put(None)
+        for thread in self.threads:
+            thread.join()
+        self.selector.close()
+        self.wakeup.close()
+        self.waker.close()
+        for device in self.devices.values():
+            device.bridge.close()
+
+    def _queue(self, id, method, args, frame):
+        future = Future()
+        with self.lock:
+            device = self.devices[id]
+            last = device.jobs[-1] if device.jobs else None
+            if frame and last and last[3]:          # newer frame replaces queued one
+                device.jobs.pop()[0].cancel()
+                device.stats['replaced'] += 1
+            elif len(device.jobs) >= self.limit:
+                raise Exception('Queue of ' + id + ' is full')
+            device.jobs.append((future, method, args, frame))
+            if not device.scheduled:
+                device.scheduled = True
+                self.ready.append(device)
+        self._wake()
+        return future
+
+    def _wake(self):
+        try:
+            self.waker.send(b'\0')
+        except BlockingIOError:
+            pass                                    # a wakeup is pending anyway
+
+    # Event loop: starts the jobs, drives the transfer steps, collects pool results
+    def _loop(self):
+        while self.running:
+            timeout = None
+            now     = time.monotonic()
+            with self.lock:
+                waiting = [d for d in self.devices.values() if d.wait]
+            if waiting:
+                timeout = max(0, min(d.wait[1] for d in waiting) - now)
+            for key, _ in self.selector.select(timeout):
+                if key.fileobj is self.wakeup:
+                    try:
+                        self.wakeup.recv(4096)
+                    except BlockingIOError:
+                        pass
+                else:
+                    self.selector.unregister(key.fileobj)
+                    key.data.wait = None
+                    self._step(key.data)
+            now = time.monotonic()
+            for device in waiting:
+                if device.wait and device.wait[1] <= now:
+                    fd, device.wait = device.wait[0], None
+                    if fd is None:
+                        self._step(device)
+                    else:
+                        self.selector.unregister(fd)
+                        self._step(device, Exception('Device ' + device.id +
+                                                     ' does not accept data'))
+            with self.lock:
+                finished, self.finished = self.finished, deque()
+                ready, self.ready = self.ready, deque()
+            for device, result, error in finished:
+                self._finish(device, result, error)
+            for device in ready:
+                self._start(device)
+
+    # Start the next job of a device: in the event loop or on the pool
+    def _start(self, device):
+        with self.lock:
+            future, method, args, frame = device.jobs.popleft()
+        device.job = (future, frame)
+        if not future.set_running_or_notify_cancel():   # cancelled by the caller
+            device.job = None
+            self._next(device)
+            return
+        if device.steps and method in MANAGER_STREAMS:
+            capture = _Capture(device.bridge)
+            try:
+                getattr(capture, method)(*args)
+            except Exception as ex:
+                self._finish(device, None, ex)
+                return
+            device.task = device.steps(device.bridge, capture.streams)
+            self._step(device)
+        else:
+            self.blocking.put((device, method, args))
+
+    # Run the generator of a device until it waits, finish the job at its end
+    def _step(self, device, error = None):
+        try:
+            wait = device.task.throw(error) if error else next(device.task)
+        except StopIteration:
+            self._finish(device, None, None)
+            return
+        except Exception as ex:
+            self._finish(device, None, ex)
+            return
+        if isinstance(wait, float):
+            device.wait = (None, time.monotonic() + wait)
+        else:
+            self.selector.register(wait, selectors.EVENT_WRITE, device)
+            device.wait = (wait, time.monotonic() + MANAGER_TIMEOUT)
+
+    def _finish(self, device, result, error):
+        future, frame = device.job
+        device.job = device.task = None
+        if error:
+            future.set_exception(error)
+        else:
+            future.set_result(result)
+        with self.lock:
+            device.stats['jobs']   += not error
+            device.stats['frames'] += frame and not error
+            device.stats['errors'] += bool(error)
+        self._next(device)
+
+    # Schedule the next job of the device or mark it idle
+    def _next(self, device):
+        with self.lock:
+            if device.jobs:
+                self.ready.append(device)
+                self._wake()
+            else:
+                device.scheduled = False
+                self.idle.notify_all()
+
+    # Pool: jobs that block, the result is passed back to the event loop
+    def _worker(self):
+        while True:
+            job = self.blocking.get()
+            if job is None:
+                return
+            device, method, args = job
+            try:
+                result, error = getattr(device.bridge, method)(*args), None
+                device.bridge.flush()
+            except Exception as ex:
+                result, error = None, ex
+            with self.lock:
+                self.finished.append((device, result, error))
+            self._wake()
+
+
+# ===================================================================================
+# List Connected Bridges
+# ===================================================================================
+
+def _main():
+    bridges = findbridges()
+    for info in bridges:
+        print('%-28s %-7s serial %-16s port %s' % (info['id'], info['transport'],
+                                                   info['serial'], info['path']))
+    print('%d bridge(s) found.' % len(bridges))
+
+
+# ===================================================================================
+
+if __name__ == "__main__":
+    _main()
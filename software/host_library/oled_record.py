@@ -0,0 +1,275 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   USB OLED Traffic Recorder for CH551, CH552, CH554
+# Version:   v1.0
+# Year:      2022
+# Author:    Stefan Wagner
+# Github:    https://github.com/wagiminator
+# License:   http://creativecommons.org/licenses/by-sa/3.0/
+# ===================================================================================
+#
+# Description:
+# ------------
+# Records everything a program sends to a bridge (I2C transactions and vendor
+# control requests, with their time) into a compact binary file and replays such
+# recordings on any transport or backend, at the original pace or as fast as
+# possible. Benchmarks and bug reports can so be repeated with exactly the same
+# workload, e.g. to compare firmware versions or transports.
+#
+# Any tool that opens its bridge with open_bridge() records if the environment
+# variable OLED_RECORD is set to a file name. Transactions that are longer than the
+# target bridge accepts (HID: 64 bytes) are split on replay if they carry pixel
+# data. Control requests are retried while the target is busy (see sendqueued()),
+# the ones it does not implement (the emulated device has none) are skipped.
+#
+# File format (little endian, n: unsigned LEB128 varint):
+#   header:  'OLEDREC' version(1) transport(n + ascii) geometry(n + ascii)
+#   records: type(1) delta time in us(n) ...
+#            REC_STREAM   length(n) stream
+#            REC_CONTROL  bRequest(1) wValue(n) wIndex(n) length(n) data
+#            REC_END      (end of recording)
+#
+# Usage examples:
+# ---------------
+# OLED_RECORD=video.rec python3 oled-video.py -t vendor animation.gif
+# python3 oled_record.py video.rec                      (info)
+# python3 oled_record.py video.rec -t hid -b emulator   (replay, original pace)
+# python3 oled_record.py video.rec -t vendor --max      (replay, max speed)
+#
+# Dependencies:
+# -------------
+# - pyserial / pyusb (only for real devices)
+
+import sys
+import argparse
+from oled_bridge import Bridge, open_bridge, TRANSPORTS, BACKENDS, GEOMETRIES, OLED_DAT_MODE
+
+REC_MAGIC   = b'OLEDREC'
+REC_VERSION = 1
+REC_STREAM  = 0x00          # I2C transaction
+REC_CONTROL = 0x01          # vendor control request (host to device)
+REC_END     = 0x02          # end of recording
+
+# ===================================================================================
+# Varint Helpers
+# ===================================================================================
+
+def _varint(value):
+    out = bytearray()
+    while True:
+        byte, value = value & 0x7F, value >> 7
+        out.append(byte | (0x80 if value else 0))
+        if not value:
+            return bytes(out)
+
+class _Reader():
+    def __init__(self, data):
+        self.data = data
+        self.pos  = 0
+
+    def byte(self):
+        if self.pos >= len(self.data):
+            raise Exception('Recording is truncated')
+        self.pos += 1
+        return self.data[self.pos - 1]
+
+    def varint(self):
+        value = shift = 0
+        while True:
+            byte   = self.byte()
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value
+
+    def bytes(self, length):
+        if self.pos + length > len(self.data):
+            raise Exception('Recording is truncated')
+        self.pos += length
+        return self.data[self.pos - length:self.pos]
+
+    def string(self):
+        return self.bytes(self.varint()).decode()
+
+
+# ===================================================================================
+# Recorder
+# ===================================================================================
+
+# Records the traffic of an opened bridge (any backend) until close() of the bridge
+class Recorder():
+    def __init__(self, bridge, filename):
+        geometry = [n for n, g in GEOMETRIES.items() if g is bridge.geometry]
+        self.bridge = bridge
+        self.file   = open(filename, 'wb')
+        self.file.write(REC_MAGIC + bytes([REC_VERSION]))
+        for text in (bridge.transport, geometry[0] if geometry else ''):
+            self.file.write(_varint(len(text)) + text.encode())
+        self.start  = bridge.clock()
+        self.last   = 0             # time of the last record in us
+        self.depth  = 0             # nesting (sendstream() of the vendor bridge calls
+                                    # sendcontrol(), only the outer call is recorded)
+        self._sendstream  = bridge.sendstream
+        self._sendcontrol = bridge.sendcontrol
+        self._close       = bridge.close
+        bridge.sendstream  = self.sendstream
+        bridge.sendcontrol = self.sendcontrol
+        bridge.close       = self.close
+
+    def sendstream(self, stream):
+        stream = bytes(stream)
+        self._call(REC_STREAM, _varint(len(stream)) + stream, self._sendstream, stream)
+
+    def sendcontrol(self, ctrl, value = 0, index = 0, data = None):
+        data = bytes(data or b'')
+        self._call(REC_CONTROL, bytes([ctrl]) + _varint(value) + _varint(index)
+                   + _varint(len(data)) + data, self._sendcontrol, ctrl, value, index,
+                   data or None)
+
+    # Finish the recording and close the bridge
+    def close(self):
+        self._record(REC_END, b'', self.bridge.clock())
+        self.file.close()
+        bridge = self.bridge
+        bridge.sendstream, bridge.sendcontrol, bridge.close = (
+            self._sendstream, self._sendcontrol, self._close)
+        bridge.close()
+
+    # Call the bridge method, record it with its start time if it succeeds (requests
+    # that the device rejected, e.g. while busy, are retried by the caller)
+    def _call(self, kind, payload, method, *args):
+        time = self.bridge.clock()
+        self.depth += 1
+        try:
+            method(*args)
+        finally:
+            self.depth -= 1
+        if not self.depth:
+            self._record(kind, payload, time)
+
+    def _record(self, kind, payload, time):
+        now = int((time - self.start) * 1000000)
+        self.file.write(bytes([kind]) + _varint(max(0, now - self.last)) + payload)
+        self.last = max(self.last, now)
+
+
+# ===================================================================================
+# Recording Reader and Replayer
+# ===================================================================================
+
+# Read a recording: dict with transport, geometry and records (list of time in s,
+# type and arguments: (stream,) or (ctrl, value, index, data))
+def readrecording(filename):
+    with open(filename, 'rb') as f:
+        reader = _Reader(f.read())
+    if reader.bytes(len(REC_MAGIC)) != REC_MAGIC:
+        raise Exception('Not a recording')
+    if reader.byte() != REC_VERSION:
+        raise Exception('Unsupported recording version')
+    recording = {'transport': reader.string(), 'geometry': reader.string(), 'records': []}
+    time = 0
+    while True:
+        kind  = reader.byte()
+        time += reader.varint()
+        if kind == REC_END:
+            break
+        if kind == REC_STREAM:
+            args = (reader.bytes(reader.varint()),)
+        elif kind == REC_CONTROL:
+            ctrl, value, index = reader.byte(), reader.varint(), reader.varint()
+            args = (ctrl, value, index, reader.bytes(reader.varint()))
+        else:
+            raise Exception('Invalid record type %d' % kind)
+        recording['records'].append((time / 1000000, kind, args))
+    recording['duration'] = time / 1000000
+    return recording
+
+# Send the records to a bridge, at the recorded pace or (speed None) without pauses,
+# speed 2 replays twice as fast. Returns counters and the replay time.
+def replay(bridge, recording, speed = 1.0):
+    stats = {'streams': 0, 'controls': 0, 'bytes': 0, 'split': 0, 'skipped': 0}
+    start = bridge.clock()
+    for time, kind, args in recording['records']:
+        if speed:
+            wait = start + time / speed - bridge.clock()
+            if wait > 0:
+                bridge.sleep(wait)
+        if kind == REC_STREAM:
+            stream = args[0]
+            if bridge.max_stream is not None and len(stream) > bridge.max_stream:
+                if len(stream) < 2 or stream[1] != OLED_DAT_MODE:
+                    raise Exception('Command transaction too long for the ' +
+                                    bridge.transport + ' bridge')
+                for part in bridge.datastreams(stream[2:]):
+                    bridge.sendstream(part)
+                stats['split'] += 1
+            else:
+                bridge.sendstream(stream)
+            stats['streams'] += 1
+            stats['bytes']   += len(stream)
+            continue
+        if type(bridge).sendcontrol is Bridge.sendcontrol:     # not implemented
+            stats['skipped'] += 1
+            continue
+        ctrl, value, index, data = args
+        bridge.sendqueued(ctrl, value, index, data or None)
+        stats['controls'] += 1
+    stats['seconds'] = bridge.clock() - start
+    return stats
+
+
+# ===================================================================================
+# Main Function
+# ===================================================================================
+
+def _main():
+    parser = argparse.ArgumentParser(description = 'USB OLED recording info and replay')
+    parser.add_argument('file', help = 'recording')
+    parser.add_argument('-t', '--transport', choices = list(TRANSPORTS),
+                        help = 'replay on this transport (default: info only)')
+    parser.add_argument('-b', '--backend', default = 'device', choices = BACKENDS,
+                        help = 'real hardware, emulated device or simulated firmware')
+    parser.add_argument('-g', '--geometry', choices = list(GEOMETRIES),
+                        help = 'panel geometry (default: the recorded one)')
+    parser.add_argument('-s', '--speed', type = float, default = 1.0,
+                        help = 'replay speed factor')
+    parser.add_argument('--max', action = 'store_true', help = 'replay without pauses')
+    args = parser.parse_args()
+
+    try:
+        recording = readrecording(args.file)
+        records   = recording['records']
+        streams   = [r[2][0] for r in records if r[1] == REC_STREAM]
+        print('%s: %s bridge, geometry %s, %.3f s' % (args.file, recording['transport'],
+              recording['geometry'] or 'custom', recording['duration']))
+        print('  %d transactions (%d bytes), %d control requests' % (len(streams),
+              sum(len(s) for s in streams), len(records) - len(streams)))
+        if args.transport:
+            play(args, recording)
+    except Exception as ex:
+        sys.stderr.write('ERROR: ' + str(ex) + '!\n')
+        sys.exit(1)
+
+    print('DONE.')
+    sys.exit(0)
+
+# Replay on the bridge given by the arguments and print the results
+def play(args, recording):
+    geometry = args.geometry or recording['geometry'] or '128x64'
+    oled = open_bridge(args.transport, args.backend, geometry, setup = False)
+    try:
+        stats = replay(oled, recording, None if args.max else args.speed)
+    finally:
+        oled.close()
+    print('Replayed on %s (%s) in %.3f s' % (args.transport, args.backend, stats['seconds']))
+    print('  %(streams)d transactions, %(bytes)d bytes, %(controls)d control requests' % stats)
+    if stats['split'] or stats['skipped']:
+        print('  %(split)d transactions split, %(skipped)d control requests skipped' % stats)
+    if stats['seconds'] > 0:
+        print('  %.0f bytes/s' % (stats['bytes'] / stats['seconds']))
+
+
+# ===================================================================================
+
+if __name__ == "__main__":
+    _main()
@@ -0,0 +1,381 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   USB OLED Simulated Device for CH551, CH552, CH554
+# Version:   v1.0
+# Year:      2022
+# Author:    Stefan Wagner
+# Github:    https://github.com/wagiminator
+# License:   http://creativecommons.org/licenses/by-sa/3.0/
+# ===================================================================================
+#
+# Description:
+# ------------
+# Runs the real firmware as a host program ('make sim' in the firmware folder, see
+# software/simulator) and talks to it on USB transaction level. In contrast to the
+# emulated device (oled_emulator.py), the actual firmware code is executed: USB
+# requests, endpoint handling, I2C bit-banging and the SSD1306 display RAM can be
+# checked without hardware. The simulation binary is built automatically if it
+# does not exist.
+#
+# Usage example:
+# --------------
+# from oled_bridge import open_bridge
+# oled = open_bridge('vendor', 'sim')
+# oled.senddata([0x55] * 1024)
+# print(oled.framebuffer() == bytes([0x55] * 1024))
+# oled.close()
+#
+# python3 oled_sim.py               (shows text sent to the terminal firmware)
+#
+# Dependencies:
+# -------------
+# - gcc and make (to build the simulation)
+
+import os
+import sys
+import struct
+import subprocess
+from oled_bridge import Bridge, HID_REPORT_SIZE, OLED_WIDTH, OLED_PAGES
+from oled_bridge import PERF_SIZE, CDC_REQ_GET_PERF, HID_REQ_GET_REPORT, VEN_REQ_GET_PERF
+from oled_bridge import TRACE_SIZE, CDC_REQ_GET_TRACE, HID_REPORT_TRACE, VEN_REQ_GET_TRACE
+from oled_bridge import CFG_SIZE, CDC_REQ_GET_CONFIG, CDC_REQ_SET_CONFIG, HID_REQ_SET_REPORT
+from oled_bridge import HID_REPORT_CONFIG, VEN_REQ_GET_CONFIG, VEN_REQ_SET_CONFIG
+from oled_bridge import GRAY_SIZE, VEN_REQ_GRAY_MODE, VEN_REQ_GET_GRAY, VEN_CLASS
+from oled_bridge import HID_REPORT_CONTROL, CONTROL_SIZE, HID_REPORT_DATA, HID_REPORT_PERF
+from oled_bridge import parsecounters, parsetimestamps, parseconfig, packconfig, parsegray
+from oled_bridge import parsecontrol, featurerecord
+from oled_bridge import FEATURE_SIZE, CDC_REQ_GET_FEATURES, HID_REPORT_FEATURES
+from oled_bridge import VEN_REQ_GET_FEATURES
+
+# ===================================================================================
+# Simulation Settings
+# ===================================================================================
+
+SOFTWARE_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+
+# Firmware folder of each transport
+FIRMWARES = {
+    'cdc':      'cdc_i2c_bridge',
+    'hid':      'hid_i2c_bridge',
+    'vendor':   'vendor_i2c_bridge',
+    'terminal': 'cdc_oled_terminal',
+    'composite':'composite_oled_terminal'
+}
+
+# Host protocol (see simulator/sim_ch55x.h)
+SIM_CMD_RESET   = b'R'
+SIM_CMD_SETUP   = b'S'
+SIM_CMD_OUT     = b'O'
+SIM_CMD_IN      = b'I'
+SIM_CMD_GDDRAM  = b'G'
+SIM_CMD_STATS   = b'B'
+SIM_CMD_SYNC    = b'Y'
+SIM_CMD_SUSPEND = b'U'
+SIM_CMD_QUIT    = b'Q'
+
+SIM_ACK   = ord('A')
+SIM_NAK   = ord('N')
+SIM_STALL = ord('S')
+
+SIM_STATS = ['starts', 'stops', 'bytes', 'naks', 'clocks', 'commands', 'data',
+             'display', 'offset', 'startline', 'buzzer', 'usbnaks']
+
+# ===================================================================================
+# Simulated Device Class
+# ===================================================================================
+
+class SimDevice():
+    def __init__(self, firmware, binary = None):
+        folder = os.path.join(SOFTWARE_DIR, firmware)
+        if binary is None:
+            binary = os.path.join(folder, firmware + '_sim')
+            if not os.path.exists(binary):
+                subprocess.run(['make', '-s', '-C', folder, 'sim'], check = True,
+                               stdout = subprocess.DEVNULL)
+        self.proc = subprocess.Popen([binary], stdin = subprocess.PIPE,
+                                     stdout = subprocess.PIPE)
+
+    def request(self, cmd, ep = 0, data = b''):
+        data = bytes(data)
+        self.proc.stdin.write(cmd + struct.pack('<BH', ep, len(data)) + data)
+        self.proc.stdin.flush()
+        head = self.proc.stdout.read(3)
+        if len(head) < 3:
+            raise Exception('Simulation terminated')
+        status, length = struct.unpack('<BH', head)
+        return status, self.proc.stdout.read(length)
+
+    def _check(self, status, what):
+        if status == SIM_STALL:
+            raise Exception(what + ' stalled')
+        if status != SIM_ACK:
+            raise Exception(what + ' failed (' + chr(status) + ')')
+
+    # USB bus reset and enumeration
+    def reset(self):
+        self._check(self.request(SIM_CMD_RESET)[0], 'Bus reset')
+        self.control(0x00, 5, 1)                                # SET_ADDRESS
+        self.descriptor = self.control(0x80, 6, 0x0100, 0, 18)  # GET_DESCRIPTOR
+        self.control(0x00, 9, 1)                                # SET_CONFIGURATION
+
+    # Control transfer (wLength for device to host, data for host to device)
+    def control(self, bmRequestType, bRequest, wValue = 0, wIndex = 0, data = 0):
+        if bmRequestType & 0x80:
+            setup = struct.pack('<BBHHH', bmRequestType, bRequest, wValue, wIndex, data)
+            data  = b''
+        else:
+            data  = bytes(data or b'')
+            setup = struct.pack('<BBHHH', bmRequestType, bRequest, wValue, wIndex, len(data))
+        status, result = self.request(SIM_CMD_SETUP, 0, setup + data)
+        self._check(status, 'Control transfer')
+        return result
+
+    # OUT transaction (repeated by the simulation while the endpoint NAKs)
+    def out(self, ep, data):
+        self._check(self.request(SIM_CMD_OUT, ep, data)[0], 'OUT transaction')
+
+    # Bulk/interrupt transfer split into packets
+    def write(self, ep, data, packet = 64):
+        data = bytes(data)
+        for i in range(0, len(data), packet):
+            self.out(ep, data[i:i+packet])
+
+    # IN transaction (None if the endpoint NAKs)
+    def read(self, ep):
+        status, data = self.request(SIM_CMD_IN, ep)
+        if status == SIM_NAK:
+            return None
+        self._check(status, 'IN transaction')
+        return data
+
+    # Configuration descriptor (all interfaces and endpoints)
+    def configuration(self):
+        head = self.control(0x80, 6, 0x0200, 0, 9)              # GET_DESCRIPTOR
+        return self.control(0x80, 6, 0x0200, 0, struct.unpack_from('<H', head, 2)[0])
+
+    # Address of the first endpoint of an interface class and direction (0x80: IN)
+    def endpoint(self, interfaceclass, direction = 0x00):
+        config, pos, current = self.configuration(), 0, None
+        while pos + 1 < len(config) and config[pos]:
+            if config[pos + 1] == 0x04:                         # interface descriptor
+                current = config[pos + 5]
+            elif config[pos + 1] == 0x05 and current == interfaceclass:
+                if config[pos + 2] & 0x80 == direction:         # endpoint descriptor
+                    return config[pos + 2]
+            pos += config[pos]
+        raise Exception('Endpoint not found')
+
+    # Display RAM of the SSD1306 model (after the firmware has finished)
+    def gddram(self):
+        status, data = self.request(SIM_CMD_GDDRAM)
+        self._check(status, 'Display RAM read')
+        return data
+
+    # Wait until the firmware has passed all received data to the I2C bus
+    def sync(self):
+        self._check(self.request(SIM_CMD_SYNC)[0], 'Synchronization')
+
+    # USB bus suspend (host disconnected or sleeping) and resume
+    def suspend(self, suspend = True):
+        self._check(self.request(SIM_CMD_SUSPEND, 1 if suspend else 0)[0], 'Suspend')
+
+    # I2C bus statistics
+    def stats(self):
+        status, data = self.request(SIM_CMD_STATS)
+        self._check(status, 'Statistics read')
+        return dict(zip(SIM_STATS, struct.unpack('<%dI' % (len(data) // 4), data)))
+
+    def close(self):
+        try:
+            self.request(SIM_CMD_QUIT)
+        except Exception:
+            pass
+        self.proc.wait()
+
+
+# ===================================================================================
+# Simulated Bridge Base Class
+# ===================================================================================
+
+# firmware: key of FIRMWARES if not the one of the transport (e.g. 'composite' for the
+# vendor interface of the composite terminal)
+class SimulatedBridge(Bridge):
+    def __init__(self, binary = None, setup = True, firmware = None):
+        self.sim = SimDevice(FIRMWARES[firmware or self.transport], binary)
+        self.sim.reset()
+        if setup:
+            self.setup()
+
+    def framebuffer(self):
+        return self.sim.gddram()
+
+    def sendcontrol(self, ctrl, value = 0, index = 0, data = None):
+        self.sim.control(0x40, ctrl, value, index, data)
+
+    def suspend(self, suspend = True):
+        self.sim.suspend(suspend)
+
+    def stats(self):
+        return self.sim.stats()
+
+    def close(self):
+        self.sim.close()
+
+
+# ===================================================================================
+# Simulated Bridges
+# ===================================================================================
+
+class SimulatedCDCBridge(SimulatedBridge):
+    transport = 'cdc'
+
+    def setrts(self, rts):
+        self.sim.control(0x21, 0x22, 2 if rts else 0)           # SET_CONTROL_LINE_STATE
+
+    def sendstream(self, stream):
+        self.setrts(True)
+        self.sim.write(2, stream)
+        self.sim.out(2, b'')            # ZLP is accepted after last packet is consumed
+        self.setrts(False)
+        self.sim.sync()                 # wait for stop condition
+
+    def counters(self):
+        return parsecounters(self.sim.control(0xA0, CDC_REQ_GET_PERF, 0, 0, PERF_SIZE))
+
+    def timestamps(self):
+        return parsetimestamps(self.sim.control(0xA0, CDC_REQ_GET_TRACE, 0, 0, TRACE_SIZE))
+
+    def readconfig(self):
+        return parseconfig(self.sim.control(0xA0, CDC_REQ_GET_CONFIG, 0, 0, CFG_SIZE))
+
+    def writeconfig(self, config):
+        self.sim.control(0x20, CDC_REQ_SET_CONFIG, 0, 0, packconfig(config))
+
+    def _features(self):
+        return self.sim.control(0xA0, CDC_REQ_GET_FEATURES, 0, 0, FEATURE_SIZE)
+
+
+class SimulatedHIDBridge(SimulatedBridge):
+    transport  = 'hid'
+    max_stream = HID_REPORT_SIZE
+
+    def sendstream(self, stream):
+        if len(stream) > HID_REPORT_SIZE:
+            raise Exception('HID report too long')
+        self.sim.out(1, bytes([HID_REPORT_DATA]) + bytes(stream))
+
+    def counters(self):
+        return parsecounters(self._getfeature(HID_REPORT_PERF, PERF_SIZE))
+
+    def timestamps(self):
+        return parsetimestamps(self._getfeature(HID_REPORT_TRACE, TRACE_SIZE))
+
+    def readconfig(self):
+        return parseconfig(self._getfeature(HID_REPORT_CONFIG, CFG_SIZE))
+
+    def writeconfig(self, config):
+        self._setfeature(HID_REPORT_CONFIG, packconfig(config))
+
+    def _features(self):
+        return self._getfeature(HID_REPORT_FEATURES, FEATURE_SIZE)
+
+    def readcontrol(self):
+        return parsecontrol(self._getfeature(HID_REPORT_CONTROL, CONTROL_SIZE))
+
+    def _writecontrol(self, data):
+        self._setfeature(HID_REPORT_CONTROL, data)
+
+    def _getfeature(self, report, length):
+        return featurerecord(report, self.sim.control(0xA1, HID_REQ_GET_REPORT,
+                                                      0x0300 | report, 0, length + 1))
+
+    def _setfeature(self, report, data):
+        self.sim.control(0x21, HID_REQ_SET_REPORT, 0x0300 | report, 0,
+                         bytes([report]) + bytes(data))
+
+    def beep(self):
+        self.writecontrol(buzzer = 1)
+        self.writecontrol(buzzer = 0)
+
+
+class SimulatedVendorBridge(SimulatedBridge):
+    transport = 'vendor'
+
+    def __init__(self, binary = None, setup = True, firmware = None):
+        super().__init__(binary, False, firmware)
+        self.ep_out = self.sim.endpoint(VEN_CLASS)
+        if setup:
+            self.setup()
+
+    def sendstream(self, stream):
+        self.sendcontrol(4)             # VEN_REQ_I2C_START
+        self.sim.write(self.ep_out, stream)
+        self.sim.out(self.ep_out, b'')  # ZLP is accepted after last packet is consumed
+        self.sendcontrol(5)             # VEN_REQ_I2C_STOP
+        self.sim.sync()                 # wait for stop condition
+
+    def beep(self):
+        self.sendcontrol(2)             # VEN_REQ_BUZZER_ON
+        self.sendcontrol(3)             # VEN_REQ_BUZZER_OFF
+
+    def counters(self):
+        return parsecounters(self.sim.control(0xC0, VEN_REQ_GET_PERF, 0, 0, PERF_SIZE))
+
+    def timestamps(self):
+        return parsetimestamps(self.sim.control(0xC0, VEN_REQ_GET_TRACE, 0, 0, TRACE_SIZE))
+
+    def readconfig(self):
+        return parseconfig(self.sim.control(0xC0, VEN_REQ_GET_CONFIG, 0, 0, CFG_SIZE))
+
+    def writeconfig(self, config):
+        self.sim.control(0x40, VEN_REQ_SET_CONFIG, 0, 0, packconfig(config))
+
+    def _features(self):
+        return self.sim.control(0xC0, VEN_REQ_GET_FEATURES, 0, 0, FEATURE_SIZE)
+
+    def setgray(self, period):
+        self.sendcontrol(VEN_REQ_GRAY_MODE, period)
+
+    def graystatus(self):
+        return parsegray(self.sim.control(0xC0, VEN_REQ_GET_GRAY, 0, 0, GRAY_SIZE))
+
+
+SIMULATORS = {
+    'cdc':    SimulatedCDCBridge,
+    'hid':    SimulatedHIDBridge,
+    'vendor': SimulatedVendorBridge
+}
+
+def open_sim(transport, **kwargs):
+    return SIMULATORS[transport](**kwargs)
+
+
+# ===================================================================================
+# Terminal Simulation
+# ===================================================================================
+
+def render(gddram, scroll = 0):
+    rows = []
+    for y in range(OLED_PAGES * 8):
+        line = (y + scroll) % (OLED_PAGES * 8)
+        page, bit = divmod(line, 8)
+        rows.append(''.join('#' if gddram[page * OLED_WIDTH + x] >> bit & 1 else ' '
+                            for x in range(OLED_WIDTH)))
+    return '\n'.join(rows)
+
+def _main():
+    text = ' '.join(sys.argv[1:]) or 'Hello World!'
+    sim  = SimDevice(FIRMWARES['terminal'])
+    try:
+        sim.reset()
+        sim.write(2, (text + '\n').encode())
+        stats = sim.stats()
+        print(render(sim.gddram(), stats['startline'] + stats['offset']))
+    finally:
+        sim.close()
+
+
+# ===================================================================================
+
+if __name__ == "__main__":
+    _main()
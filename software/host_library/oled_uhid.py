@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   USB OLED Virtual HID Bridge for CH551, CH552, CH554
+# Version:   v1.0
+# Year:      2022
+# Author:    Stefan Wagner
+# Github:    https://github.com/wagiminator
+# License:   http://creativecommons.org/licenses/by-sa/3.0/
+# ===================================================================================
+#
+# Description:
+# ------------
+# Creates a virtual HID bridge in the Linux kernel via /dev/uhid, so that the
+# hidraw backend of the host library (HidrawBridge) can be tested without hardware.
+# The device has the VID/PID and report descriptor of the HID bridge and is served
+# by the simulated firmware (oled_sim.py): output reports are passed to the
+# interrupt endpoint, feature reports become GET_REPORT/SET_REPORT requests. All
+# reports of the bridge have a report ID, which the kernel passes with the data in
+# the first byte, just like the USB HID driver.
+#
+# /dev/uhid needs root rights, the created hidraw node is made accessible to all
+# users, so that the tools can run as a normal user. The picture of the simulated
+# display is shown when the program is stopped (Ctrl-C).
+#
+# Usage example:
+# --------------
+# sudo python3 oled_uhid.py &
+# python3 bridge-benchmark.py -t hid -b hidraw
+#
+# Dependencies:
+# -------------
+# - gcc and make (to build the simulation)
+
+import os
+import sys
+import time
+import struct
+from oled_bridge import VENDOR_ID, HID_PRODUCT_ID, CFG_SIZE, HID_REQ_GET_REPORT
+from oled_bridge import HID_REQ_SET_REPORT, hidrawdevices
+from oled_sim import SimulatedHIDBridge, render
+
+# Events of linux/uhid.h
+UHID_DESTROY            = 1
+UHID_START              = 2
+UHID_STOP               = 3
+UHID_OPEN               = 4
+UHID_CLOSE              = 5
+UHID_OUTPUT             = 6
+UHID_GET_REPORT         = 9
+UHID_GET_REPORT_REPLY   = 10
+UHID_CREATE2            = 11
+UHID_SET_REPORT         = 13
+UHID_SET_REPORT_REPLY   = 14
+
+UHID_FEATURE_REPORT     = 0
+UHID_DATA_MAX           = 4096
+UHID_EVENT_SIZE         = 4380      # sizeof(struct uhid_event)
+UHID_EIO                = 5         # error code for stalled requests
+
+BUS_USB                 = 0x03
+
+# ===================================================================================
+# Virtual HID Bridge
+# ===================================================================================
+
+class UHIDBridge():
+    def __init__(self, name = 'OLED HID Bridge (uhid)'):
+        self.bridge  = SimulatedHIDBridge(setup = False)
+        self.sim     = self.bridge.sim
+        self.known   = set(hidrawdevices())                     # nodes of real bridges
+        self.reports = 0                                        # output reports received
+        report  = self.sim.control(0x81, 6, 0x2200, 0, 255)     # report descriptor
+        self.fd = os.open('/dev/uhid', os.O_RDWR)
+        self._send(UHID_CREATE2, struct.pack('<128s64s64sHHIIII', name.encode(), b'', b'',
+                   len(report), BUS_USB, VENDOR_ID, HID_PRODUCT_ID, 0x0100, 0) + report)
+
+    # Serve the events of the kernel until the program is stopped
+    def run(self):
+        while True:
+            event = os.read(self.fd, UHID_EVENT_SIZE)
+            kind  = struct.unpack_from('<I', event)[0]
+            if kind == UHID_START:
+                self._permit()
+            elif kind == UHID_OUTPUT:
+                size = struct.unpack_from('<H', event, 4 + UHID_DATA_MAX)[0]
+                self._output(event[4:4 + size])
+            elif kind == UHID_GET_REPORT:
+                self._getreport(*struct.unpack_from('<IBB', event, 4))
+            elif kind == UHID_SET_REPORT:
+                id, number, rtype, size = struct.unpack_from('<IBBH', event, 4)
+                self._setreport(id, number, rtype, event[12:12 + size])
+
+    def close(self):
+        self._send(UHID_DESTROY, b'')
+        os.close(self.fd)
+        gddram = self.sim.gddram()
+        stats  = self.sim.stats()
+        self.bridge.close()
+        return gddram, stats
+
+    def _send(self, kind, payload):
+        os.write(self.fd, struct.pack('<I', kind) + payload)
+
+    # Output report (report ID in the first byte)
+    def _output(self, data):
+        self.sim.out(1, data)
+        self.reports += 1
+
+    def _getreport(self, id, number, rtype):
+        try:
+            if rtype != UHID_FEATURE_REPORT:
+                raise Exception('Not a feature report')
+            data = self.sim.control(0xA1, HID_REQ_GET_REPORT, 0x0300 | number, 0,
+                                    CFG_SIZE + 1)
+            self._send(UHID_GET_REPORT_REPLY, struct.pack('<IHH', id, 0, len(data)) + data)
+        except Exception:
+            self._send(UHID_GET_REPORT_REPLY, struct.pack('<IHH', id, UHID_EIO, 0))
+
+    def _setreport(self, id, number, rtype, data):
+        try:
+            if rtype != UHID_FEATURE_REPORT:
+                raise Exception('Not a feature report')
+            self.sim.control(0x21, HID_REQ_SET_REPORT, 0x0300 | number, 0, data)
+            self._send(UHID_SET_REPORT_REPLY, struct.pack('<IH', id, 0))
+        except Exception:
+            self._send(UHID_SET_REPORT_REPLY, struct.pack('<IH', id, UHID_EIO))
+
+    # Make the hidraw node of the new device accessible to all users
+    def _permit(self):
+        for _ in range(50):
+            for node in set(hidrawdevices()) - self.known:
+                os.chmod(node, 0o666)
+                print('Virtual HID bridge at', node)
+                return
+            time.sleep(0.01)
+
+
+# ===================================================================================
+# Main Function
+# ===================================================================================
+
+def _main():
+    try:
+        device = UHIDBridge()
+    except Exception as ex:
+        sys.stderr.write('ERROR: ' + str(ex) + '!\n')
+        sys.exit(1)
+
+    try:
+        device.run()
+    except KeyboardInterrupt:
+        pass
+    gddram, stats = device.close()
+    print(render(gddram, stats['startline'] + stats['offset']))
+    print('%d output reports, %d I2C transactions' % (device.reports, stats['stops']))
+    print('DONE.')
+    sys.exit(0)
+
+
+# ===================================================================================
+
+if __name__ == "__main__":
+    _main()
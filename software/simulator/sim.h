@@ -0,0 +1,56 @@
+// ===================================================================================
+// Host Simulation Header for CH551, CH552 and CH554                          * v1.0 *
+// ===================================================================================
+//
+// This header is force-included (gcc -include sim.h -DSIMULATOR) into every firmware
+// source file when the firmware is built as a host program with 'make sim'. It maps
+// the SDCC specific keywords to standard C, turns all SFRs into ordinary variables
+// and routes the pin macros of gpio.h to the simulated hardware:
+// - I2C bus (PIN_SDA/PIN_SCL) with an attached SSD1306 OLED model
+// - buzzer pin
+// The USB device controller, the interrupt system and the timing sources are
+// simulated by the sources in this folder (see readme.md).
+//
+// 2022 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+#include <stdint.h>
+
+// ===================================================================================
+// SDCC Keywords
+// ===================================================================================
+#define __xdata
+#define __data
+#define __idata
+#define __pdata
+#define __code
+#define __bit                   uint8_t
+#define __at(addr)
+#define __interrupt(num)
+#define __asm__(code)
+#define inline                  static inline
+
+// ===================================================================================
+// Special Function Registers (ordinary variables, merged by the linker -fcommon)
+// ===================================================================================
+#define SBIT(name, addr, bit)   volatile uint8_t  name
+#define SFR(name, addr)         volatile uint8_t  name
+#define SFRX(name, addr)        volatile uint8_t  name
+#define SFR16(name, addr)       volatile uint16_t name
+#define SFR16E(name, fulladdr)  volatile uint16_t name
+#define SFR32(name, addr)       volatile uint32_t name
+#define SFR32E(name, fulladdr)  volatile uint32_t name
+
+// USB descriptors and setup packets must not be padded
+#pragma pack(1)
+
+// ===================================================================================
+// Simulated Hardware
+// ===================================================================================
+void    SIM_pinWrite(uint8_t pin, uint8_t val); // write output latch of pin
+uint8_t SIM_pinRead(uint8_t pin);               // read pin (bus level)
+void    SIM_boot(void);                         // jump to bootloader (ends simulation)
+uint8_t SIM_flashRead(uint8_t addr);           // read DataFlash byte
+uint8_t SIM_flashWrite(uint8_t addr, uint8_t data); // write DataFlash byte (0: ok)
+uint8_t SIM_codeRead(uint16_t addr);            // read code flash byte
+uint8_t SIM_codeWrite(uint16_t addr, uint16_t data); // write code flash word (0: ok)
@@ -0,0 +1,94 @@
+// ===================================================================================
+// Host Simulation Internals for CH551, CH552 and CH554                       * v1.0 *
+// ===================================================================================
+//
+// Shared declarations of the simulation sources (sim_core.c, sim_usb.c and
+// sim_ssd1306.c). Must be included after all system headers, since sim.h redefines
+// some keywords. The register definitions are taken from the ch554.h of the firmware
+// that is being simulated.
+//
+// 2022 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+#include <stdint.h>
+#include "sim.h"
+#include "ch554.h"
+
+// ===================================================================================
+// Board Wiring (see schematic)
+// ===================================================================================
+#define SIM_PIN_BUZZER    5             // P15
+#define SIM_PIN_SDA       6             // P16
+#define SIM_PIN_SCL       7             // P17
+#define SIM_PINS          16            // P10..P17, P30..P37
+
+// ===================================================================================
+// Host Protocol
+// ===================================================================================
+// Request:  [cmd][ep][len low][len high][data ...]
+// Response: [status][len low][len high][data ...]
+#define SIM_CMD_RESET     'R'           // USB bus reset
+#define SIM_CMD_SETUP     'S'           // control transfer: setup packet + OUT data
+#define SIM_CMD_OUT       'O'           // OUT transaction to endpoint
+#define SIM_CMD_IN        'I'           // IN transaction from endpoint
+#define SIM_CMD_GDDRAM    'G'           // read display RAM of the SSD1306 model
+#define SIM_CMD_STATS     'B'           // read I2C bus statistics
+#define SIM_CMD_SYNC      'Y'           // wait until firmware has passed all data to I2C
+#define SIM_CMD_SUSPEND   'U'           // USB bus suspend (ep 1) or resume (ep 0)
+#define SIM_CMD_QUIT      'Q'           // end simulation
+
+#define SIM_ACK           'A'           // transaction acknowledged
+#define SIM_NAK           'N'           // endpoint busy, try again
+#define SIM_STALL         'S'           // endpoint stalled
+#define SIM_ERROR         'E'           // unknown command or device not ready
+#define SIM_BUSY          0             // internal: retry later
+
+#define SIM_DATA_SIZE     4096          // max data length of a request/response
+
+typedef struct {
+  uint8_t  cmd;                         // command
+  uint8_t  ep;                          // endpoint number
+  uint16_t len;                         // length of data
+  uint8_t  data[SIM_DATA_SIZE];         // request data
+  uint8_t  status;                      // response status
+  uint16_t rlen;                        // response length
+  uint8_t  rdata[SIM_DATA_SIZE];        // response data
+} SIM_REQ;
+
+// ===================================================================================
+// I2C Bus and SSD1306 Model
+// ===================================================================================
+#define SSD1306_ADDR      0x78          // I2C write address of the OLED
+#define SSD1306_WIDTH     128
+#define SSD1306_PAGES     8
+#define SSD1306_RAM       (SSD1306_WIDTH * SSD1306_PAGES)
+
+typedef struct {
+  uint32_t starts;                      // number of start conditions
+  uint32_t stops;                       // number of stop conditions
+  uint32_t bytes;                       // number of bytes transferred
+  uint32_t naks;                        // number of not acknowledged addresses
+  uint32_t clocks;                      // number of SCL clock pulses
+  uint32_t commands;                    // number of SSD1306 command bytes
+  uint32_t data;                        // number of SSD1306 data bytes
+  uint32_t display;                     // display on (1) or off (0)
+  uint32_t offset;                      // display offset (0xD3)
+  uint32_t startline;                   // display start line (0x40-0x7F)
+  uint32_t buzzer;                      // number of buzzer pin toggles
+  uint32_t usbnaks;                     // number of NAKed OUT transactions
+} SIM_STATS;
+
+extern SIM_STATS SIM_stats;
+extern uint8_t   SSD1306_gddram[SSD1306_RAM];
+
+void    SIM_i2cUpdate(uint8_t sda, uint8_t scl);  // new output state of the MCU
+uint8_t SIM_i2cSDA(void);                         // current bus level of SDA
+uint8_t SIM_i2cIdle(void);                        // bus idle (after stop)
+void    SIM_i2cLog(const char* filename);         // log all transactions to file
+
+// ===================================================================================
+// USB Device Controller
+// ===================================================================================
+void    SIM_usbProcess(SIM_REQ* req);             // execute USB request (in interrupt)
+uint8_t SIM_usbIdle(void);                        // all OUT buffers consumed by firmware
+void    SIM_usbFrame(void);                       // start of frame (every millisecond)
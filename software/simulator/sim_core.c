@@ -0,0 +1,344 @@
+// ===================================================================================
+// Host Simulation Core for CH551, CH552 and CH554                            * v1.0 *
+// ===================================================================================
+//
+// The firmware runs unmodified on the main thread of the host program. This file
+// provides the missing pieces of the microcontroller around it:
+// - Interrupts: Host requests are received by a separate I/O thread and handed over
+//   to the main thread via SIGUSR1. The signal handler plays the role of the USB
+//   interrupt, so that the ISR interrupts the main loop of the firmware exactly like
+//   on the real chip. Requests are deferred while interrupts are disabled (EA,
+//   IE_USB, USB_INT_EN).
+// - Timing: A 0.5ms interval timer (SIGALRM) toggles the touch-key timer flag, which
+//   is the time base of DLY_ms(). Every second period the timer2 interrupt is
+//   executed if enabled (millisecond tick, the timer2 count itself is not simulated),
+//   as well as the USB start-of-frame interrupt, if the firmware enabled it.
+// - GPIO: Pin writes are passed to the I2C bus/SSD1306 model (sim_ssd1306.c).
+// - Flash: 128 bytes DataFlash and 14KB code flash (only the data written by the
+//   firmware, the program itself is not contained), erased (0xFF) at startup or
+//   loaded from/saved to a file.
+//
+// The host talks to the simulated device via stdin/stdout or, if the environment
+// variable SIM_SOCKET is set, via a Unix domain socket with that path. The protocol
+// is described in sim_ch55x.h and implemented on the host side in
+// software/host_library/oled_sim.py.
+//
+// Environment variables:
+// SIM_SOCKET   - path of the Unix domain socket (default: stdin/stdout)
+// SIM_I2C_LOG  - write all I2C transactions to this file
+// SIM_FLASH    - file holding the DataFlash and code flash content (kept between
+//                simulation runs)
+//
+// 2022 by Stefan Wagner:   https://github.com/wagiminator
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "sim_ch55x.h"
+
+// ===================================================================================
+// Variables
+// ===================================================================================
+#define SIM_TICK_us       500                   // interval timer period
+#define SIM_IDLE_TICKS    4                     // quiet time (I2C, USB) before GDDRAM read
+#define SIM_TIMEOUT_us    2000000               // max time a request is deferred
+#define SIM_RETRY_us      20                    // retry interval of deferred requests
+#define SIM_FLASH_SIZE    128                   // DataFlash bytes
+#define SIM_CODE_SIZE     0x3800                // code flash bytes (below bootloader)
+
+static pthread_t          SIM_mainThread;       // thread running the firmware
+static pthread_t          SIM_hostThread;       // thread talking to the host
+static sem_t              SIM_done;             // request processed by interrupt
+static SIM_REQ            SIM_req;              // current host request
+static volatile uint32_t  SIM_ticks;            // interval timer ticks
+static volatile uint32_t  SIM_activity;         // tick of last I2C pin change
+static uint8_t            SIM_pins[SIM_PINS];   // output latches
+static int                SIM_fdIn  = 0;        // host connection
+static int                SIM_fdOut = 1;
+static uint8_t            SIM_flash[SIM_FLASH_SIZE + SIM_CODE_SIZE]; // Data/code flash
+static char*              SIM_flashFile;       // flash file (optional)
+
+extern void TMR2_ISR(void) __attribute__((weak)); // timer2 interrupt vector (optional)
+
+// ===================================================================================
+// GPIO
+// ===================================================================================
+
+// Write output latch of pin
+void SIM_pinWrite(uint8_t pin, uint8_t val) {
+  val = val ? 1 : 0;
+  if(pin >= SIM_PINS) return;
+  if(pin == SIM_PIN_BUZZER && SIM_pins[pin] != val) SIM_stats.buzzer++;
+  SIM_pins[pin] = val;
+  if(pin == SIM_PIN_SDA || pin == SIM_PIN_SCL) {
+    SIM_activity = SIM_ticks;
+    SIM_i2cUpdate(SIM_pins[SIM_PIN_SDA], SIM_pins[SIM_PIN_SCL]);
+  }
+}
+
+// Read pin (bus level for SDA, output latch otherwise)
+uint8_t SIM_pinRead(uint8_t pin) {
+  if(pin == SIM_PIN_SDA) return SIM_i2cSDA();
+  return pin < SIM_PINS ? SIM_pins[pin] : 1;
+}
+
+// Jump to bootloader: ends the simulation
+void SIM_boot(void) {
+  fprintf(stderr, "SIM: bootloader requested\n");
+  exit(0);
+}
+
+// ===================================================================================
+// Flash (file: DataFlash followed by code flash)
+// ===================================================================================
+
+// Save flash content to file (replaced at once, the host may end the simulation
+// at any time)
+static void SIM_flashSave(void) {
+  FILE* f;
+  char  tmp[4096];
+  if(!SIM_flashFile) return;
+  snprintf(tmp, sizeof(tmp), "%s.tmp", SIM_flashFile);
+  if((f = fopen(tmp, "wb"))) {
+    fwrite(SIM_flash, 1, sizeof(SIM_flash), f);
+    fclose(f);
+    rename(tmp, SIM_flashFile);
+  }
+}
+
+// Read DataFlash byte
+uint8_t SIM_flashRead(uint8_t addr) {
+  return addr < SIM_FLASH_SIZE ? SIM_flash[addr] : 0xFF;
+}
+
+// Write DataFlash byte and update file, returns 0 on success
+uint8_t SIM_flashWrite(uint8_t addr, uint8_t data) {
+  if(addr >= SIM_FLASH_SIZE) return 1;
+  SIM_flash[addr] = data;
+  SIM_flashSave();
+  return 0;
+}
+
+// Read code flash byte
+uint8_t SIM_codeRead(uint16_t addr) {
+  return addr < SIM_CODE_SIZE ? SIM_flash[SIM_FLASH_SIZE + addr] : 0xFF;
+}
+
+// Write code flash word and update file, returns 0 on success
+uint8_t SIM_codeWrite(uint16_t addr, uint16_t data) {
+  if((addr & 1) || addr >= SIM_CODE_SIZE) return 1;
+  SIM_flash[SIM_FLASH_SIZE + addr]     = data & 0xFF;
+  SIM_flash[SIM_FLASH_SIZE + addr + 1] = data >> 8;
+  SIM_flashSave();
+  return 0;
+}
+
+// Load flash content from file (erased if it does not exist)
+static void SIM_flashLoad(void) {
+  FILE* f;
+  memset(SIM_flash, 0xFF, sizeof(SIM_flash));
+  SIM_flashFile = getenv("SIM_FLASH");
+  if(SIM_flashFile && (f = fopen(SIM_flashFile, "rb"))) {
+    if(fread(SIM_flash, 1, sizeof(SIM_flash), f) != sizeof(SIM_flash))
+      memset(SIM_flash, 0xFF, sizeof(SIM_flash));
+    fclose(f);
+  }
+}
+
+// ===================================================================================
+// Interrupts
+// ===================================================================================
+
+// Interval timer: touch-key timer flag as time base for DLY_ms()
+static void SIM_timer(int sig) {
+  (void)sig;
+  SIM_ticks++;
+  TKEY_CTRL ^= bTKC_IF;
+  if((SIM_ticks & 1) && TMR2_ISR && TR2 && ET2 && EA) {
+    TF2 = 1;
+    TMR2_ISR();
+  }
+  if((SIM_ticks & 1) && EA && IE_USB) SIM_usbFrame();
+}
+
+// Firmware has passed all received data to the I2C bus
+static uint8_t SIM_synced(void) {
+  return SIM_i2cIdle() && SIM_usbIdle();
+}
+
+// Firmware is not processing any data
+static uint8_t SIM_idle(void) {
+  return SIM_synced() && (SIM_ticks - SIM_activity >= SIM_IDLE_TICKS);
+}
+
+// Host request: executed on the firmware thread like an interrupt
+static void SIM_interrupt(int sig) {
+  SIM_REQ* req = &SIM_req;
+  (void)sig;
+  req->rlen   = 0;
+  req->status = SIM_BUSY;
+  switch(req->cmd) {
+    case SIM_CMD_GDDRAM:
+      if(!SIM_idle()) break;
+      memcpy(req->rdata, SSD1306_gddram, SSD1306_RAM);
+      req->rlen   = SSD1306_RAM;
+      req->status = SIM_ACK;
+      break;
+
+    case SIM_CMD_STATS:
+      if(!SIM_idle()) break;
+      memcpy(req->rdata, &SIM_stats, sizeof(SIM_stats));
+      req->rlen   = sizeof(SIM_stats);
+      req->status = SIM_ACK;
+      break;
+
+    case SIM_CMD_SYNC:
+      if(SIM_synced()) req->status = SIM_ACK;
+      break;
+
+    default:                                    // USB interrupt enabled?
+      if(EA && IE_USB && USB_INT_EN) SIM_usbProcess(req);
+      SIM_activity = SIM_ticks;                 // main loop may act on the request
+      break;
+  }
+  sem_post(&SIM_done);
+}
+
+// ===================================================================================
+// Host Communication (I/O thread)
+// ===================================================================================
+
+// Read exactly len bytes from host
+static int SIM_read(uint8_t* buf, uint16_t len) {
+  ssize_t n;
+  while(len) {
+    n = read(SIM_fdIn, buf, len);
+    if(n < 0 && errno == EINTR) continue;
+    if(n <= 0) return 0;
+    buf += n; len -= n;
+  }
+  return 1;
+}
+
+// Write exactly len bytes to host
+static void SIM_write(uint8_t* buf, uint16_t len) {
+  ssize_t n;
+  while(len) {
+    n = write(SIM_fdOut, buf, len);
+    if(n < 0 && errno == EINTR) continue;
+    if(n <= 0) return;
+    buf += n; len -= n;
+  }
+}
+
+// Hand request over to the firmware thread, repeat while it is deferred or the
+// endpoint NAKs an OUT transaction (like the host controller does)
+static void SIM_execute(void) {
+  uint32_t waited = 0;
+  while(1) {
+    pthread_kill(SIM_mainThread, SIGUSR1);
+    while(sem_wait(&SIM_done) && errno == EINTR);
+    if(SIM_req.status == SIM_NAK && SIM_req.cmd == SIM_CMD_OUT) SIM_stats.usbnaks++;
+    else if(SIM_req.status != SIM_BUSY) return;
+    if(waited >= SIM_TIMEOUT_us) {
+      SIM_req.status = SIM_ERROR;
+      SIM_req.rlen   = 0;
+      return;
+    }
+    usleep(SIM_RETRY_us);
+    waited += SIM_RETRY_us;
+  }
+}
+
+// Serve requests of one host connection
+static void SIM_serve(void) {
+  uint8_t hdr[4];
+  while(SIM_read(hdr, 4)) {
+    SIM_req.cmd = hdr[0];
+    SIM_req.ep  = hdr[1];
+    SIM_req.len = hdr[2] | (hdr[3] << 8);
+    if(SIM_req.len > SIM_DATA_SIZE || !SIM_read(SIM_req.data, SIM_req.len)) return;
+    if(SIM_req.cmd == SIM_CMD_QUIT) exit(0);
+    SIM_execute();
+    hdr[0] = SIM_req.status;
+    hdr[1] = SIM_req.rlen & 0xFF;
+    hdr[2] = SIM_req.rlen >> 8;
+    SIM_write(hdr, 3);
+    SIM_write(SIM_req.rdata, SIM_req.rlen);
+  }
+}
+
+static void* SIM_host(void* arg) {
+  struct sockaddr_un addr;
+  char* path = getenv("SIM_SOCKET");
+  int   server;
+  (void)arg;
+
+  if(!path) {                                   // stdin/stdout: end with host
+    SIM_serve();
+    exit(0);
+  }
+
+  server = socket(AF_UNIX, SOCK_STREAM, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+  unlink(path);
+  if(server < 0 || bind(server, (struct sockaddr*)&addr, sizeof(addr)) || listen(server, 1)) {
+    fprintf(stderr, "SIM: could not open socket %s\n", path);
+    exit(1);
+  }
+  while(1) {                                    // socket: device stays plugged in
+    SIM_fdIn = SIM_fdOut = accept(server, NULL, NULL);
+    if(SIM_fdIn < 0) continue;
+    SIM_serve();
+    close(SIM_fdIn);
+  }
+  return NULL;
+}
+
+// ===================================================================================
+// Startup (before main() of the firmware)
+// ===================================================================================
+__attribute__((constructor)) static void SIM_init(void) {
+  struct sigaction  sa;
+  struct itimerval  timer;
+  sigset_t          mask, old;
+  char*             log = getenv("SIM_I2C_LOG");
+
+  if(log) SIM_i2cLog(log);
+  SIM_flashLoad();
+  memset(SIM_pins, 1, sizeof(SIM_pins));        // port latches are HIGH after reset
+  SIM_mainThread = pthread_self();
+  sem_init(&SIM_done, 0, 0);
+  signal(SIGPIPE, SIG_IGN);
+
+  memset(&sa, 0, sizeof(sa));                   // handlers must not interrupt each other
+  sigfillset(&sa.sa_mask);
+  sa.sa_flags   = SA_RESTART;
+  sa.sa_handler = SIM_interrupt;
+  sigaction(SIGUSR1, &sa, NULL);
+  sa.sa_handler = SIM_timer;
+  sigaction(SIGALRM, &sa, NULL);
+
+  sigemptyset(&mask);                           // only the firmware thread gets signals
+  sigaddset(&mask, SIGUSR1);
+  sigaddset(&mask, SIGALRM);
+  pthread_sigmask(SIG_BLOCK, &mask, &old);
+  pthread_create(&SIM_hostThread, NULL, SIM_host, NULL);
+  pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+  timer.it_interval.tv_sec  = 0;
+  timer.it_interval.tv_usec = SIM_TICK_us;
+  timer.it_value = timer.it_interval;
+  setitimer(ITIMER_REAL, &timer, NULL);
+}
@@ -0,0 +1,216 @@
+// ===================================================================================
+// Simulated I2C Bus with SSD1306 OLED for CH551, CH552 and CH554             * v1.0 *
+// ===================================================================================
+//
+// Bit-level model of the open-drain I2C bus: SDA and SCL are the wired-AND of the
+// MCU outputs and the slave. START and STOP conditions are detected on SDA edges
+// while SCL is HIGH, data bits are sampled on the rising edge of SCL. The SSD1306
+// acknowledges its address and decodes the control bytes (Co, D/C), the commands
+// relevant for the display RAM and all three addressing modes.
+//
+// If a log file is given (SIM_I2C_LOG), every transaction is written to it as
+// [length low][length high][bytes ...] for later inspection.
+//
+// 2022 by Stefan Wagner:   https://github.com/wagiminator
+
+#include <stdio.h>
+#include <string.h>
+#include "sim_ch55x.h"
+
+// ===================================================================================
+// Variables
+// ===================================================================================
+SIM_STATS SIM_stats;
+uint8_t   SSD1306_gddram[SSD1306_RAM];
+
+// I2C bus state
+static uint8_t  I2C_mcuSDA   = 1;       // SDA output of MCU (1: released)
+static uint8_t  I2C_slaveSDA = 1;       // SDA output of slave (1: released)
+static uint8_t  I2C_busSDA   = 1;       // bus levels
+static uint8_t  I2C_busSCL   = 1;
+static uint8_t  I2C_active   = 0;       // between START and STOP
+static uint8_t  I2C_bitCount = 0;       // bits of current byte received
+static uint8_t  I2C_shift    = 0;       // shift register
+static uint8_t  I2C_ackPhase = 0;       // 9th clock pulse
+static uint16_t I2C_byteCount= 0;       // bytes in current transaction
+static uint8_t  I2C_selected = 0;       // SSD1306 addressed
+
+// Transaction log
+static FILE*    I2C_logFile  = NULL;
+static uint8_t  I2C_logBuf[SIM_DATA_SIZE];
+
+// SSD1306 state
+static uint8_t  SSD_ctrl;               // last control byte
+static uint8_t  SSD_expectCtrl;         // next byte is a control byte
+static uint8_t  SSD_mode    = 2;        // page addressing mode after reset
+static uint8_t  SSD_col, SSD_page;
+static uint8_t  SSD_colLo   = 0, SSD_colHi  = SSD1306_WIDTH - 1;
+static uint8_t  SSD_pageLo  = 0, SSD_pageHi = SSD1306_PAGES - 1;
+static uint8_t  SSD_cmd[8];             // pending multi-byte command
+static uint8_t  SSD_cmdLen  = 0;
+
+// ===================================================================================
+// SSD1306 Model
+// ===================================================================================
+
+// Number of argument bytes of multi-byte SSD1306 commands
+static uint8_t SSD1306_args(uint8_t cmd) {
+  switch(cmd) {
+    case 0x26: case 0x27:                       return 6;
+    case 0x29: case 0x2A:                       return 5;
+    case 0x21: case 0x22: case 0xA3:            return 2;
+    case 0x20: case 0x81: case 0x8D: case 0xA8:
+    case 0xD3: case 0xD5: case 0xD9: case 0xDA:
+    case 0xDB:                                  return 1;
+    default:                                    return 0;
+  }
+}
+
+// Write data byte to display RAM and advance pointer
+static void SSD1306_write(uint8_t b) {
+  SSD1306_gddram[SSD_page * SSD1306_WIDTH + SSD_col] = b;
+  SIM_stats.data++;
+  if(SSD_mode == 0) {                           // horizontal addressing mode
+    if(++SSD_col > SSD_colHi) {
+      SSD_col  = SSD_colLo;
+      SSD_page = (SSD_page < SSD_pageHi) ? SSD_page + 1 : SSD_pageLo;
+    }
+  }
+  else if(SSD_mode == 1) {                      // vertical addressing mode
+    if(++SSD_page > SSD_pageHi) {
+      SSD_page = SSD_pageLo;
+      SSD_col  = (SSD_col < SSD_colHi) ? SSD_col + 1 : SSD_colLo;
+    }
+  }
+  else SSD_col = (SSD_col + 1) & (SSD1306_WIDTH - 1);  // page addressing mode
+}
+
+// Execute command byte
+static void SSD1306_command(uint8_t b) {
+  uint8_t c;
+  SIM_stats.commands++;
+  SSD_cmd[SSD_cmdLen++] = b;
+  if(SSD_cmdLen <= SSD1306_args(SSD_cmd[0])) return;  // wait for arguments
+  SSD_cmdLen = 0;
+  c = SSD_cmd[0];
+  if(c <= 0x0F)       SSD_col = (SSD_col & 0xF0) | c;
+  else if(c <= 0x1F)  SSD_col = (SSD_col & 0x0F) | ((c & 0x0F) << 4);
+  else if(c == 0x20)  SSD_mode = SSD_cmd[1] & 3;
+  else if(c == 0x21) {
+    SSD_colLo  = SSD_cmd[1] & 0x7F; SSD_colHi  = SSD_cmd[2] & 0x7F;
+    SSD_col    = SSD_colLo;
+  }
+  else if(c == 0x22) {
+    SSD_pageLo = SSD_cmd[1] & 0x07; SSD_pageHi = SSD_cmd[2] & 0x07;
+    SSD_page   = SSD_pageLo;
+  }
+  else if(c >= 0x40 && c <= 0x7F) SIM_stats.startline = c & 0x3F;
+  else if(c == 0xAE)  SIM_stats.display = 0;
+  else if(c == 0xAF)  SIM_stats.display = 1;
+  else if(c >= 0xB0 && c <= 0xB7) SSD_page = c & 0x07;
+  else if(c == 0xD3)  SIM_stats.offset = SSD_cmd[1] & 0x3F;
+}
+
+// Handle received byte of the current transaction
+static void SSD1306_byte(uint8_t b) {
+  if(SSD_expectCtrl) {                          // control byte
+    SSD_ctrl = b;
+    SSD_expectCtrl = 0;
+    return;
+  }
+  if(SSD_ctrl & 0x40) SSD1306_write(b);         // D/C = 1: data
+  else                SSD1306_command(b);       // D/C = 0: command
+  if(SSD_ctrl & 0x80) SSD_expectCtrl = 1;       // Co = 1: control byte follows
+}
+
+// ===================================================================================
+// I2C Bus Model
+// ===================================================================================
+
+// Byte received (address byte first)
+static void I2C_received(uint8_t b) {
+  if(I2C_byteCount < SIM_DATA_SIZE) I2C_logBuf[I2C_byteCount] = b;
+  if(!I2C_byteCount++) {                        // address byte
+    I2C_selected = ((b & 0xFE) == SSD1306_ADDR) && !(b & 0x01);
+    if(!I2C_selected) SIM_stats.naks++;
+    SSD_expectCtrl = 1;
+    return;
+  }
+  SIM_stats.bytes++;
+  if(I2C_selected) SSD1306_byte(b);
+}
+
+static void I2C_startCondition(void) {
+  if(I2C_active) SIM_stats.stops++;             // repeated start
+  SIM_stats.starts++;
+  I2C_active    = 1;
+  I2C_bitCount  = 0;
+  I2C_ackPhase  = 0;
+  I2C_byteCount = 0;
+  I2C_selected  = 0;
+  SSD_cmdLen    = 0;
+}
+
+static void I2C_stopCondition(void) {
+  uint16_t len = I2C_byteCount < SIM_DATA_SIZE ? I2C_byteCount : SIM_DATA_SIZE;
+  SIM_stats.stops++;
+  I2C_active = 0;
+  I2C_slaveSDA = 1;
+  if(I2C_logFile && len) {
+    fputc(len & 0xFF, I2C_logFile);
+    fputc(len >> 8,   I2C_logFile);
+    fwrite(I2C_logBuf, 1, len, I2C_logFile);
+    fflush(I2C_logFile);
+  }
+}
+
+// New output state of the MCU pins
+void SIM_i2cUpdate(uint8_t sda, uint8_t scl) {
+  uint8_t newSDA, newSCL;
+  I2C_mcuSDA = sda;
+  newSDA = I2C_mcuSDA & I2C_slaveSDA;
+  newSCL = scl;
+
+  if(I2C_busSCL && newSCL) {                    // SCL stays HIGH: SDA edge = condition
+    if(I2C_busSDA && !newSDA)       I2C_startCondition();
+    else if(!I2C_busSDA && newSDA)  I2C_stopCondition();
+  }
+  else if(!I2C_busSCL && newSCL) {              // rising edge of SCL: sample
+    SIM_stats.clocks++;
+    if(I2C_active && !I2C_ackPhase && I2C_bitCount < 8) {
+      I2C_shift = (I2C_shift << 1) | newSDA;
+      I2C_bitCount++;
+    }
+  }
+  else if(I2C_busSCL && !newSCL && I2C_active) {  // falling edge of SCL
+    if(I2C_ackPhase) {                          // end of ACK bit: release SDA
+      I2C_ackPhase = 0;
+      I2C_bitCount = 0;
+      I2C_slaveSDA = 1;
+    }
+    else if(I2C_bitCount == 8) {                // byte complete: ACK if selected
+      I2C_received(I2C_shift);
+      I2C_ackPhase = 1;
+      I2C_slaveSDA = I2C_selected ? 0 : 1;
+    }
+  }
+
+  I2C_busSDA = I2C_mcuSDA & I2C_slaveSDA;
+  I2C_busSCL = newSCL;
+}
+
+// Current bus level of SDA
+uint8_t SIM_i2cSDA(void) {
+  return I2C_busSDA;
+}
+
+// Bus idle (no transaction in progress)
+uint8_t SIM_i2cIdle(void) {
+  return !I2C_active;
+}
+
+// Log all transactions to file
+void SIM_i2cLog(const char* filename) {
+  I2C_logFile = fopen(filename, "wb");
+  if(!I2C_logFile) fprintf(stderr, "SIM: could not open %s\n", filename);
+}
@@ -0,0 +1,239 @@
+// ===================================================================================
+// Simulated USB Device Controller for CH551, CH552 and CH554                 * v1.0 *
+// ===================================================================================
+//
+// Executes host transactions against the endpoint registers of the firmware like the
+// USB SIE does: the response of an endpoint (ACK/NAK/STALL) is taken from UEPn_CTRL,
+// received data is copied into the endpoint buffer, USB_INT_ST/USB_RX_LEN are set and
+// the USB interrupt service routine of the firmware is called. Control transfers are
+// split into SETUP, DATA and STATUS stages with the EP0 packet size taken from the
+// device descriptor. This function is always executed in interrupt context (see
+// sim_core.c).
+//
+// 2022 by Stefan Wagner:   https://github.com/wagiminator
+
+#include <string.h>
+#include "sim_ch55x.h"
+
+// ===================================================================================
+// Firmware Symbols
+// ===================================================================================
+extern void    USB_ISR(void);                   // USB interrupt vector of the firmware
+extern uint8_t DevDescr[];                      // device descriptor
+extern uint8_t EP0_buffer[];                    // endpoint buffers (if used)
+extern uint8_t EP1_buffer[] __attribute__((weak));
+extern uint8_t EP2_buffer[] __attribute__((weak));
+extern uint8_t EP3_buffer[] __attribute__((weak));
+
+#define SIM_EP_MAX        4                     // highest endpoint number
+
+// ===================================================================================
+// Endpoint Helper Functions
+// ===================================================================================
+
+// Endpoint control register
+static volatile uint8_t* SIM_epCtrl(uint8_t ep) {
+  switch(ep) {
+    case 0:  return &UEP0_CTRL;
+    case 1:  return &UEP1_CTRL;
+    case 2:  return &UEP2_CTRL;
+    case 3:  return &UEP3_CTRL;
+    default: return &UEP4_CTRL;
+  }
+}
+
+// Endpoint transmit length register
+static volatile uint8_t* SIM_epTLen(uint8_t ep) {
+  switch(ep) {
+    case 0:  return &UEP0_T_LEN;
+    case 1:  return &UEP1_T_LEN;
+    case 2:  return &UEP2_T_LEN;
+    case 3:  return &UEP3_T_LEN;
+    default: return &UEP4_T_LEN;
+  }
+}
+
+// Endpoint receive buffer (OUT)
+static uint8_t* SIM_epBuffer(uint8_t ep) {
+  switch(ep) {
+    case 0:  return EP0_buffer;
+    case 1:  return EP1_buffer;
+    case 2:  return EP2_buffer;
+    case 3:  return EP3_buffer;
+    default: return EP0_buffer + 64;            // EP4 follows EP0 (UEP0_DMA)
+  }
+}
+
+// Endpoint transmit buffer (IN), follows receive buffer if both are enabled
+static uint8_t* SIM_epTxBuffer(uint8_t ep) {
+  uint8_t* buf = SIM_epBuffer(ep);
+  switch(ep) {
+    case 1:  return (UEP4_1_MOD & bUEP1_RX_EN) ? buf + 64 : buf;
+    case 2:  return (UEP2_3_MOD & bUEP2_RX_EN) ? buf + 64 : buf;
+    case 3:  return (UEP2_3_MOD & bUEP3_RX_EN) ? buf + 64 : buf;
+    case 4:  return (UEP4_1_MOD & bUEP4_RX_EN) ? buf + 64 : buf;
+    default: return buf;
+  }
+}
+
+// Endpoint enabled for OUT/IN transactions
+static uint8_t SIM_epEnabled(uint8_t ep, uint8_t in) {
+  switch(ep) {
+    case 0:  return 1;
+    case 1:  return EP1_buffer && (UEP4_1_MOD & (in ? bUEP1_TX_EN : bUEP1_RX_EN));
+    case 2:  return EP2_buffer && (UEP2_3_MOD & (in ? bUEP2_TX_EN : bUEP2_RX_EN));
+    case 3:  return EP3_buffer && (UEP2_3_MOD & (in ? bUEP3_TX_EN : bUEP3_RX_EN));
+    case 4:  return UEP4_1_MOD & (in ? bUEP4_TX_EN : bUEP4_RX_EN);
+    default: return 0;
+  }
+}
+
+// Raise transfer interrupt for token on endpoint and call ISR of the firmware
+static void SIM_usbInterrupt(uint8_t token, uint8_t ep) {
+  USB_INT_ST   = token | ep;
+  U_TOG_OK     = 1;
+  UIF_TRANSFER = 1;
+  USB_ISR();
+  UIF_TRANSFER = 0;
+}
+
+// ===================================================================================
+// Transactions
+// ===================================================================================
+
+// OUT transaction: data from host to device
+static uint8_t SIM_usbOut(uint8_t ep, uint8_t* data, uint8_t len) {
+  uint8_t res = *SIM_epCtrl(ep) & MASK_UEP_R_RES;
+  if(res == UEP_R_RES_STALL) return SIM_STALL;
+  if(res != UEP_R_RES_ACK)   return SIM_NAK;
+  if(len) memcpy(SIM_epBuffer(ep), data, len);
+  USB_RX_LEN = len;
+  SIM_usbInterrupt(UIS_TOKEN_OUT, ep);
+  return SIM_ACK;
+}
+
+// IN transaction: data from device to host
+static uint8_t SIM_usbIn(uint8_t ep, uint8_t* data, uint8_t* len) {
+  uint8_t res = *SIM_epCtrl(ep) & MASK_UEP_T_RES;
+  if(res == UEP_T_RES_STALL) return SIM_STALL;
+  if(res != UEP_T_RES_ACK)   return SIM_NAK;
+  *len = *SIM_epTLen(ep);
+  memcpy(data, SIM_epTxBuffer(ep), *len);
+  SIM_usbInterrupt(UIS_TOKEN_IN, ep);
+  return SIM_ACK;
+}
+
+// Control transfer on EP0: SETUP, DATA and STATUS stage
+static void SIM_usbControl(SIM_REQ* req) {
+  uint8_t  maxp    = DevDescr[7];
+  uint16_t wLength = req->data[6] | (req->data[7] << 8);
+  uint16_t ptr     = 8;
+  uint8_t  len, status;
+
+  // SETUP stage
+  memcpy(EP0_buffer, req->data, 8);
+  USB_RX_LEN = 8;
+  SIM_usbInterrupt(UIS_TOKEN_SETUP, 0);
+
+  if(req->data[0] & 0x80) {                     // device to host
+    while(req->rlen < wLength && req->rlen + maxp <= SIM_DATA_SIZE) {  // DATA (IN)
+      status = SIM_usbIn(0, req->rdata + req->rlen, &len);
+      if(status == SIM_STALL) {
+        req->status = SIM_STALL;
+        return;
+      }
+      if(status != SIM_ACK) break;              // no more data
+      req->rlen += len;
+      if(len < maxp) break;                     // short packet ends data stage
+    }
+    if(SIM_usbOut(0, NULL, 0) == SIM_STALL) {   // STATUS stage (zero-length OUT)
+      req->status = SIM_STALL;
+      return;
+    }
+  }
+  else {                                        // host to device
+    while(ptr < req->len) {                     // DATA stage (OUT)
+      len = (req->len - ptr) > maxp ? maxp : (req->len - ptr);
+      status = SIM_usbOut(0, req->data + ptr, len);
+      if(status != SIM_ACK) {
+        req->status = status;
+        return;
+      }
+      ptr += len;
+    }
+    status = SIM_usbIn(0, req->rdata, &len);    // STATUS stage (zero-length IN)
+    if(status != SIM_ACK) {
+      req->status = status;
+      return;
+    }
+    req->rlen = 0;
+  }
+  req->status = SIM_ACK;
+}
+
+// ===================================================================================
+// Request Handler (called in interrupt context)
+// ===================================================================================
+void SIM_usbProcess(SIM_REQ* req) {
+  uint8_t len;
+  req->rlen   = 0;
+  req->status = 0;
+  switch(req->cmd) {
+    case SIM_CMD_RESET:
+      UIF_TRANSFER = 0;
+      UIF_BUS_RST  = 1;
+      USB_ISR();
+      UIF_BUS_RST  = 0;
+      req->status  = SIM_ACK;
+      break;
+
+    case SIM_CMD_SUSPEND:                       // ep: 1 = suspend, 0 = resume
+      if(req->ep) USB_MIS_ST |= bUMS_SUSPEND;
+      else        USB_MIS_ST &= ~bUMS_SUSPEND;
+      UIF_SUSPEND  = 1;
+      USB_ISR();
+      req->status  = SIM_ACK;
+      break;
+
+    case SIM_CMD_SETUP:
+      if(req->len < 8) req->status = SIM_ERROR;
+      else SIM_usbControl(req);
+      break;
+
+    case SIM_CMD_OUT:
+      if(req->ep > SIM_EP_MAX || !SIM_epEnabled(req->ep, 0) || req->len > 64)
+        req->status = SIM_ERROR;
+      else req->status = SIM_usbOut(req->ep, req->data, req->len);
+      break;
+
+    case SIM_CMD_IN:
+      if(req->ep > SIM_EP_MAX || !SIM_epEnabled(req->ep, 1))
+        req->status = SIM_ERROR;
+      else {
+        req->status = SIM_usbIn(req->ep, req->rdata, &len);
+        if(req->status == SIM_ACK) req->rlen = len;
+      }
+      break;
+
+    default:
+      req->status = SIM_ERROR;
+      break;
+  }
+}
+
+// Start of frame: the host sends it every millisecond, the SOF interrupt is only
+// raised if enabled by the firmware and the bus is not suspended
+void SIM_usbFrame(void) {
+  if((USB_INT_EN & bUIE_DEV_SOF) && !(USB_MIS_ST & bUMS_SUSPEND))
+    SIM_usbInterrupt(UIS_TOKEN_SOF, 0);
+}
+
+// All OUT endpoints have been emptied by the firmware
+uint8_t SIM_usbIdle(void) {
+  uint8_t ep;
+  for(ep = 1; ep <= SIM_EP_MAX; ep++) {
+    if(SIM_epEnabled(ep, 0) && ((*SIM_epCtrl(ep) & MASK_UEP_R_RES) == UEP_R_RES_NAK))
+      return 0;
+  }
+  return 1;
+}
@@ -0,0 +1,83 @@
+// ===================================================================================
+// Temporal Dithering Grayscale for CH551, CH552 and CH554                    * v1.0 *
+// ===================================================================================
+
+#include "gray.h"
+
+#ifdef GRAY_DITHER
+#include "devcfg.h"
+#include "i2c.h"
+#include "usb_handler.h"
+
+// ===================================================================================
+// Variables
+// ===================================================================================
+__xdata GRAY_STATUS_TYPE GRAY_status;             // counters read by the host
+__xdata uint8_t GRAY_period;                      // slot length in ms (0: off)
+__xdata uint8_t GRAY_count;                       // ms in the current slot
+__xdata uint8_t GRAY_slot;                        // current slot of the cycle
+volatile __xdata uint8_t GRAY_line;               // display start line to be sent
+volatile __bit GRAY_due = 0;                      // start line not yet sent
+
+// ===================================================================================
+// Dithering Functions
+// ===================================================================================
+
+// Send requested display start line (main loop)
+void GRAY_update(void) {
+  uint8_t line;
+  if(GRAY_due) {
+    GRAY_due = 0;                                 // a newer request is sent next time
+    line = GRAY_line;
+    I2C_start();
+    I2C_write(CFG_record.addr);
+    I2C_write(0x00);                              // command mode
+    I2C_write(0x40 | line);                       // display start line
+    I2C_stop();
+  }
+}
+
+// Request next plane at the start of its slot (USB start-of-frame, every ms)
+void GRAY_SOF(void) {
+  GRAY_status.frames++;
+  if(++GRAY_count < GRAY_period) return;
+  GRAY_count = 0;
+  if(++GRAY_slot == GRAY_SLOTS) GRAY_slot = 0;
+  if(GRAY_slot == 1) return;                      // plane A stays for two slots
+  GRAY_status.deadlines++;
+  if(GRAY_due) GRAY_status.dropped++;             // previous change not sent in time
+  GRAY_line = GRAY_slot ? GRAY_LINE_B : GRAY_LINE_A;
+  GRAY_due  = 1;
+}
+
+// ===================================================================================
+// USB Request Functions
+// ===================================================================================
+
+// Handle vendor setup requests of the grayscale mode
+uint8_t GRAY_control(void) {
+  uint8_t i;
+  switch(USB_SetupReq) {
+    case GRAY_REQ_MODE:                           // set slot length (0: off)
+      if(USB_SetupBuf->wValueH) return 0xff;
+      GRAY_period = USB_SetupBuf->wValueL;
+      GRAY_count  = 0;
+      GRAY_slot   = 0;
+      for(i=0; i<sizeof(GRAY_status); i++) ((__xdata uint8_t*)&GRAY_status)[i] = 0;
+      if(GRAY_period) USB_INT_EN |=  bUIE_DEV_SOF;
+      else            USB_INT_EN &= ~bUIE_DEV_SOF;
+      GRAY_line = GRAY_LINE_A;                    // start (or end) with plane A
+      GRAY_due  = 1;
+      return 0;
+
+    case GRAY_REQ_STATUS:                         // read counters
+      if(USB_SetupLen > sizeof(GRAY_status)) USB_SetupLen = sizeof(GRAY_status);
+      USB_pData = (__xdata uint8_t*)&GRAY_status;
+      return USB_EP0_copyData();
+
+    default:
+      return 0xff;
+  }
+}
+
+#endif
@@ -0,0 +1,71 @@
+// ===================================================================================
+// Temporal Dithering Grayscale for CH551, CH552 and CH554                    * v1.0 *
+// ===================================================================================
+//
+// The display RAM of the SSD1306 holds two 128x32 bitplanes: the most significant
+// one in pages 0 - 3 (plane A), the least significant one in pages 4 - 7 (plane B).
+// The OLED runs with the multiplex ratio of a 128x32 panel and shows one half at a
+// time. Alternating the halves with the display start line in the sequence A, A, B
+// gives four brightness levels, so the host only writes the two planes and the
+// device keeps the cadence without any further USB traffic.
+//
+// The cadence is derived from the start-of-frame packets (SOF), which the host sends
+// every millisecond. The SOF interrupt counts the slots and requests the next start
+// line, the main loop sends it between two I2C transactions of the host. If the
+// previous start line has not been sent yet when the next one is due (e.g. the host
+// keeps the bus busy with a long transaction), the deadline is dropped and counted.
+//
+// The vendor request GRAY_REQ_MODE (wValueL: slot length in ms, 0 = off) starts the
+// dithering and resets the counters, switching it off shows plane A again.
+// GRAY_REQ_STATUS (control IN) reads GRAY_status.
+//
+// GRAY_DITHER must be defined in config.h, otherwise everything is compiled out.
+// USB_SOF_handler in usb_handler.h must call GRAY_SOF().
+//
+// Functions available:
+// --------------------
+// GRAY_update()            send requested display start line (main loop)
+// GRAY_SOF()               USB start-of-frame handler (in USB interrupt)
+// GRAY_control()           handle vendor setup requests, returns length or 0xff
+//
+// 2022 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+#include <stdint.h>
+#include "config.h"
+
+#ifdef GRAY_DITHER
+
+// ===================================================================================
+// Bitplanes
+// ===================================================================================
+#define GRAY_LINE_A       0                       // display start line of plane A
+#define GRAY_LINE_B       32                      // display start line of plane B
+#define GRAY_SLOTS        3                       // slots per cycle (A, A, B)
+
+#define GRAY_REQ_MODE     14                      // vendor request: set slot length
+#define GRAY_REQ_STATUS   15                      // vendor request: read status (IN)
+
+// ===================================================================================
+// Status
+// ===================================================================================
+typedef struct {
+  uint32_t frames;        // USB frames (SOF) since the start
+  uint32_t deadlines;     // plane changes that were due
+  uint32_t dropped;       // plane changes not sent before the next one was due
+} GRAY_STATUS_TYPE;
+
+extern __xdata GRAY_STATUS_TYPE GRAY_status;
+
+// ===================================================================================
+// Functions
+// ===================================================================================
+void GRAY_update(void);
+void GRAY_SOF(void);
+uint8_t GRAY_control(void);
+
+#else
+
+#define GRAY_update()
+
+#endif
@@ -0,0 +1,57 @@
+// ===================================================================================
+// USB Suspend and Power-Down for CH551, CH552 and CH554                      * v1.0 *
+// ===================================================================================
+
+#include "power.h"
+#include "ch554.h"
+#include "system.h"
+#include "i2c.h"
+#include "devcfg.h"
+#include "perf.h"
+#include "tick.h"
+
+volatile __bit POWER_request = 0;                 // USB bus suspended, not yet handled
+
+// ===================================================================================
+// Functions
+// ===================================================================================
+
+// Send one command byte to the OLED
+void POWER_command(uint8_t cmd) {
+  I2C_start();
+  I2C_write(CFG_record.addr);                     // OLED write address
+  I2C_write(0x00);                                // command mode
+  I2C_write(cmd);
+  I2C_stop();
+}
+
+// USB suspend interrupt: handled by the main loop (I2C bus may be in use)
+void POWER_suspend(void) {
+  POWER_request = 1;
+}
+
+// Switch OLED off, power-down until the bus resumes, switch OLED on again
+void POWER_update(void) {
+  uint32_t start;
+  __bit display;
+  if(!POWER_request) return;
+  POWER_request = 0;
+  if(!(USB_MIS_ST & bUMS_SUSPEND)) return;        // resumed in the meantime
+  PERF_inc(suspends);
+  display = !(CFG_record.mode & CFG_MODE_SUSPEND);  // suspend frame stays on
+  if(display) POWER_command(0xAE);                // OLED off (sleep mode)
+  SAFE_MOD = 0x55; SAFE_MOD = 0xAA;               // enter safe mode
+  WAKE_USB_enable();                              // wake-up by USB event
+  SAFE_MOD = 0x00;                                // terminate safe mode
+  while(USB_MIS_ST & bUMS_SUSPEND) {              // power-down until resume or reset
+    WDT_reset();                                  // (watchdog stops in power-down)
+    SLEEP_now();
+  }
+  SAFE_MOD = 0x55; SAFE_MOD = 0xAA;
+  WAKE_USB_disable();
+  SAFE_MOD = 0x00;
+  start = TICK_stamp();
+  if(display) POWER_command(0xAF);                // OLED on (display RAM is kept)
+  start = (TICK_stamp() - start) / 3;             // timer2 runs three times faster
+  PERF_set(resumeTime, start > 0xFFFF ? 0xFFFF : start);
+}
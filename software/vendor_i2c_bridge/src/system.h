@@ -171,9 +171,13 @@ inline void RST_now(void) {
 // Bootloader (BOOT) Functions
 // ===================================================================================
 inline void BOOT_now(void) {
+  #ifdef SIMULATOR
+  SIM_boot();
+  #else
   __asm
     ljmp #BOOT_LOAD_ADDR
   __endasm;
+  #endif
 }
 
 inline void BOOT_prepare(void) {
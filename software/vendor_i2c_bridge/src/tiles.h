@@ -0,0 +1,46 @@
+// ===================================================================================
+// Tile Table in Code Flash for CH551, CH552 and CH554                        * v1.0 *
+// ===================================================================================
+//
+// User interfaces are mostly built from repeated glyphs, icons and borders. The host
+// uploads them once as 8x8 pixel tiles (8 bytes each, one byte per column in the
+// bit order of the SSD1306 display RAM) into the tile table in front of the frame
+// store and then only sends the tile indices: a full screen is 128 bytes instead of
+// 1024. The table keeps its content while the power is off.
+//
+// The vendor request TILE_REQ_LOAD (wValue: first tile, control OUT) stores up to
+// TILE_CHUNK / TILE_SIZE tiles. TILE_REQ_DRAW (wValueL: page, wValueH: column 0 -
+// 127, control OUT) draws a run of up to TILE_CHUNK tile indices from left to
+// right. A tile that crosses the right edge is cut off, the run continues at column
+// 0 of the next page. Both are executed by TILE_update() in the main loop, the next
+// request is stalled until then.
+//
+// Functions available:
+// --------------------
+// TILE_update()            store received tiles or draw received run (main loop)
+// TILE_control()           handle vendor setup requests, returns length or 0xff
+// TILE_EP0_OUT()           handle vendor control OUT data
+//
+// 2022 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+#include <stdint.h>
+#include "flash.h"
+
+// ===================================================================================
+// Tile Table
+// ===================================================================================
+#define TILE_ADDR         0x2800                  // start address in code flash
+#define TILE_SIZE         8                       // bytes per tile (8x8 pixels)
+#define TILE_COUNT        256                     // number of tiles
+#define TILE_CHUNK        64                      // max bytes per request
+
+#define TILE_REQ_LOAD     12                      // vendor request: store tiles (OUT)
+#define TILE_REQ_DRAW     13                      // vendor request: draw tiles (OUT)
+
+// ===================================================================================
+// Functions
+// ===================================================================================
+void TILE_update(void);
+uint8_t TILE_control(void);
+void TILE_EP0_OUT(void);
@@ -6,6 +6,7 @@
 #include <stdint.h>
 #include "ch554.h"
 #include "usb_descr.h"
+#include "config.h"
 
 // ===================================================================================
 // Variables
@@ -15,6 +16,7 @@ extern volatile uint8_t  USB_SetupReq, USB_SetupTyp;
 extern volatile uint16_t USB_SetupLen;
 extern volatile __bit    USB_ENUM_OK;
 extern __code uint8_t*   USB_pDescr;
+extern __xdata uint8_t*  USB_pData;
 
 // ===================================================================================
 // Custom External USB Handler Functions
@@ -22,8 +24,11 @@ extern __code uint8_t*   USB_pDescr;
 uint8_t VEN_control(void);
 void VEN_setup(void);
 void VEN_EP0_IN(void);
+void VEN_EP0_OUT(void);
 void VEN_EP1_IN(void);
 void VEN_EP1_OUT(void);
+void FRAME_suspend(void);
+void GRAY_SOF(void);
 
 // ===================================================================================
 // USB Handler Defines
@@ -32,6 +37,11 @@ void VEN_EP1_OUT(void);
 #define USB_INIT_endpoints        VEN_setup       // init custom endpoints
 #define USB_VENDOR_SETUP_handler  VEN_control     // handle vendor setup requests
 #define USB_VENDOR_IN_handler     VEN_EP0_IN      // handle vendor in transfers
+#define USB_VENDOR_OUT_handler    VEN_EP0_OUT     // handle vendor out transfers
+#define USB_SUSPEND_handler       FRAME_suspend   // suspend frame, power-down
+#ifdef GRAY_DITHER
+#define USB_SOF_handler           GRAY_SOF        // grayscale cadence
+#endif
 
 // Endpoint callback functions
 #define EP0_SETUP_callback        USB_EP0_SETUP
@@ -46,3 +56,5 @@ void VEN_EP1_OUT(void);
 void USB_init(void);
 void USB_interrupt(void);
 void USB_EP0_copyDescr(uint8_t len);
+uint8_t USB_EP0_copyData(void);
+uint8_t USB_EP0_storeData(void);
@@ -3,6 +3,12 @@
 // ===================================================================================
 
 #include "usb_vendor.h"
+#include "perf.h"
+#include "tick.h"
+#include "devcfg.h"
+#include "frames.h"
+#include "tiles.h"
+#include "gray.h"
 
 // ===================================================================================
 // Variables and Defines
@@ -43,8 +49,11 @@ uint8_t VEN_read(void) {
   uint8_t b;
   while(!VEN_available());                                  // wait for data
   b = EP1_buffer[VEN_EP1_readPointer++];                    // get data byte
-  if(--VEN_EP1_readByteCount == 0)                          // dec number of bytes in buffer
+  if(--VEN_EP1_readByteCount == 0) {                        // dec number of bytes in buffer
     UEP1_CTRL = UEP1_CTRL & ~MASK_UEP_R_RES | UEP_R_RES_ACK;// request new data if empty
+    PERF_nakStop();                                         // end of endpoint stall
+    TICK_drained();
+  }
   return b;
 }
 
@@ -93,6 +102,39 @@ uint8_t VEN_control(void) {
       VEN_I2C_flag = 0;
       return 0;
 
+    #ifdef PERF_COUNTERS
+    case VEN_REQ_GET_PERF:                  // read performance counters
+      return PERF_copy();
+    #endif
+
+    #ifdef TICK_TIMESTAMPS
+    case VEN_REQ_GET_TRACE:                 // read transaction timestamps
+      return TICK_copy();
+    #endif
+
+    case VEN_REQ_GET_CONFIG:                // read device configuration
+      return CFG_copy();
+
+    case VEN_REQ_SET_CONFIG:                // write device configuration (OUT)
+      return CFG_receive();
+
+    case VEN_REQ_GET_FEATURES:              // read device feature bits
+      return CFG_copyFeatures();
+
+    case VEN_REQ_WRITE_FRAME:               // write frame store (see src/frames.h)
+    case VEN_REQ_SHOW_FRAME:                // show frame
+      return FRAME_control();
+
+    case VEN_REQ_LOAD_TILES:                // store tiles (see src/tiles.h)
+    case VEN_REQ_DRAW_TILES:                // draw tiles
+      return TILE_control();
+
+    #ifdef GRAY_DITHER
+    case VEN_REQ_GRAY_MODE:                 // grayscale mode (see src/gray.h)
+    case VEN_REQ_GET_GRAY:                  // read grayscale counters
+      return GRAY_control();
+    #endif
+
     #ifdef WCID_VENDOR_CODE
     case WCID_VENDOR_CODE:
       if(USB_SetupBuf->wIndexL == 0x04) {
@@ -124,6 +166,20 @@ void VEN_EP0_IN(void) {
       break;
     #endif
 
+    #ifdef PERF_COUNTERS
+    case VEN_REQ_GET_PERF:
+    #endif
+    #ifdef TICK_TIMESTAMPS
+    case VEN_REQ_GET_TRACE:
+    #endif
+    #ifdef GRAY_DITHER
+    case VEN_REQ_GET_GRAY:
+    #endif
+    case VEN_REQ_GET_CONFIG:
+    case VEN_REQ_GET_FEATURES:
+      len = USB_EP0_copyData();
+      break;
+
     default:
       UEP0_CTRL = bUEP_R_TOG | UEP_T_RES_NAK | UEP_R_RES_ACK;
       return;
@@ -134,19 +190,35 @@ void VEN_EP0_IN(void) {
   UEP0_CTRL    ^= bUEP_T_TOG;
 }
 
-/*
 // Endpoint 0 Vendor-Specific USB OUT Transfers
 void VEN_EP0_OUT(void) {
-  uint8_t len;
-
   switch(USB_SetupReq) {
 
-    default:
-      UEP0_CTRL = bUEP_T_TOG | UEP_T_RES_ACK | UEP_R_RES_ACK;
+    case VEN_REQ_SET_CONFIG:
+      if(USB_EP0_storeData()) {             // more packets to come?
+        UEP0_CTRL ^= bUEP_R_TOG;
+        return;
+      }
+      if(CFG_received() == 0xff) {          // invalid record: stall status stage
+        UEP0_CTRL = bUEP_R_TOG | bUEP_T_TOG | UEP_R_RES_STALL | UEP_T_RES_STALL;
+        return;
+      }
+      break;
+
+    case VEN_REQ_WRITE_FRAME:
+      FRAME_EP0_OUT();
+      return;
+
+    case VEN_REQ_LOAD_TILES:
+    case VEN_REQ_DRAW_TILES:
+      TILE_EP0_OUT();
       return;
+
+    default:
+      break;
   }
+  UEP0_CTRL = bUEP_T_TOG | UEP_T_RES_ACK | UEP_R_RES_ACK;
 }
-*/
 
 // ===================================================================================
 // Vendor-Specific BULK Transfers
@@ -159,11 +231,19 @@ void VEN_EP1_IN(void) {
 }
 
 // Endpoint 1 OUT handler (bulk data transfer from host)
+// Data outside an I2C transaction (late packets of a stream aborted by the timeout
+// of the main loop) is discarded, so it never becomes the start of the next one.
 void VEN_EP1_OUT(void) {
   if(U_TOG_OK) {                            // discard unsynchronized packets
+    if(!VEN_I2C_flag) return;               // no transaction open: discard data
     VEN_EP1_readByteCount = USB_RX_LEN;     // set number of received data bytes
     VEN_EP1_readPointer = 0;                // reset read pointer for fetching
-    if(VEN_EP1_readByteCount) 
+    if(VEN_EP1_readByteCount) {
       UEP1_CTRL = (UEP1_CTRL & ~MASK_UEP_R_RES) | UEP_R_RES_NAK; // respond NAK after a packet. Let main code change response after handling.
+      PERF_add(bytes, VEN_EP1_readByteCount);
+      PERF_inc(naks);
+      PERF_nakStart();
+      TICK_packet(VEN_EP1_readByteCount);
+    }
   }
 }
@@ -18,6 +18,17 @@
 #define VEN_REQ_BUZZER_OFF  3                       // turn off buzzer
 #define VEN_REQ_I2C_START   4                       // set start condition on I2C bus
 #define VEN_REQ_I2C_STOP    5                       // set stop condition on I2C bus
+#define VEN_REQ_GET_PERF    6                       // read performance counters (IN)
+#define VEN_REQ_GET_TRACE   7                       // read transaction timestamps (IN)
+#define VEN_REQ_GET_CONFIG  8                       // read device configuration (IN)
+#define VEN_REQ_SET_CONFIG  9                       // write device configuration (OUT)
+#define VEN_REQ_WRITE_FRAME 10                      // write frame store chunk (OUT)
+#define VEN_REQ_SHOW_FRAME  11                      // show frame of frame store
+#define VEN_REQ_LOAD_TILES  12                      // store tiles in tile table (OUT)
+#define VEN_REQ_DRAW_TILES  13                      // draw run of tile indices (OUT)
+#define VEN_REQ_GRAY_MODE   14                      // set grayscale slot length
+#define VEN_REQ_GET_GRAY    15                      // read grayscale counters (IN)
+#define VEN_REQ_GET_FEATURES 16                     // read device feature bits (IN)
 
 // Bulk data transfer functions
 #define VEN_available()   (VEN_EP1_readByteCount)   // number of received bytes
@@ -134,7 +134,7 @@ OLED_INIT_CMD = [
 ]
 
 # ===================================================================================
-# OLED Picture (Bitmap Converter: http://www.majer.ch/lcd/adf_bitmap.php)
+# OLED Picture (Bitmap Converter: host_library/oled-convert.py -n PIC1 picture.png)
 # ===================================================================================
 
 PIC1 = [
@@ -46,7 +46,7 @@
 // Compilation Instructions:
 // -------------------------
 // - Chip:  CH551, CH552 or CH554
-// - Clock: 16 MHz internal
+// - Clock: 16 MHz internal (or 24 MHz with 5V supply: 'make flash FREQ_SYS=24000000')
 // - Adjust the firmware parameters in src/config.h if necessary.
 // - Make sure SDCC toolchain and Python3 with PyUSB is installed.
 // - Press BOOT button on the board and keep it pressed while connecting it via USB
@@ -73,6 +73,14 @@
 #include "src/delay.h"                    // for delays
 #include "src/i2c.h"                      // for I²C
 #include "src/usb_vendor.h"               // for USB vendor-specific functions
+#include "src/perf.h"                     // for performance counters
+#include "src/tick.h"                     // for millisecond tick and timestamps
+#include "src/devcfg.h"                   // for persistent device configuration
+#include "src/frames.h"                   // for frame store (splash, suspend)
+#include "src/tiles.h"                    // for tile table (tile based drawing)
+#include "src/gray.h"                     // for grayscale mode (temporal dithering)
+#include "src/task.h"                     // for cooperative tasks and timeouts
+#include "src/power.h"                    // for USB suspend and power-down
 
 // Prototypes for used interrupts
 void USB_interrupt(void);
@@ -80,6 +88,72 @@ void USB_ISR(void) __interrupt(INT_NO_USB) {
   USB_interrupt();
 }
 
+void TMR2_ISR(void) __interrupt(INT_NO_TMR2) {
+  TICK_interrupt();
+}
+
+// ===================================================================================
+// Tasks of the Main Loop
+// ===================================================================================
+
+// Task numbers (performance counter taskId)
+#define TASK_CONFIG     0
+#define TASK_STREAM     1
+#define TASK_FRAME      2
+#define TASK_TILE       3
+#define TASK_GRAY       4
+#define TASK_CONTROL    5
+#define TASK_POWER      6
+
+__bit streaming = 0;                            // I2C transaction of the bulk stream open
+TASK_TIMER streamTimer;                         // timeout of the open transaction
+
+// Pass one received bulk packet to the I2C bus. The transaction is opened by the
+// I2C start request and closed when the stop request has come and all received
+// bytes have been written (the host sends the stop request after the bulk data).
+// It is aborted with an I2C bus clear if no data has come for STREAM_TIMEOUT ms,
+// bulk data that comes after that is discarded (see VEN_EP1_OUT()).
+void streamTask(void) {
+  uint8_t len;
+  if(!streaming) {
+    if(!VEN_I2C_flag) return;                   // I2C start?
+    I2C_start();                                // set I2C start condition
+    streaming = 1;
+    TASK_timerStart(streamTimer, STREAM_TIMEOUT);
+  }
+  if(!VEN_I2C_flag && !VEN_available()) {       // I2C stop and all bytes written?
+    I2C_stop();                                 // set I2C stop condition
+    streaming = 0;
+    return;
+  }
+  len = VEN_available();                        // bytes of the current packet
+  if(!len) {
+    if(TASK_timerExpired(streamTimer)) {        // stop request lost (host died)?
+      I2C_clear();                              // abort transaction, free the bus
+      VEN_I2C_flag = 0;                         // wait for the next start request
+      while(VEN_available()) VEN_read();        // discard data that came meanwhile
+      streaming = 0;
+      PERF_inc(timeouts);
+    }
+    return;
+  }
+  TASK_timerStart(streamTimer, STREAM_TIMEOUT);
+  while(len--) I2C_write(VEN_read());           // write received data bytes via I2C
+}
+
+// Bootloader and buzzer requests
+void controlTask(void) {
+  if(VEN_BOOT_flag) {                           // enter bootloader?
+    WDT_stop();                                 // (does not feed the watchdog)
+    BOOT_now();
+  }
+  if(VEN_BUZZER_flag) PWM_start(PIN_BUZZER);    // buzzer start?
+  else {                                        // buzzer stop?
+    PWM_stop(PIN_BUZZER);
+    PIN_high(PIN_BUZZER);
+  }
+}
+
 // ===================================================================================
 // Main Function
 // ===================================================================================
@@ -88,27 +162,30 @@ void main(void) {
   // Setup
   CLK_config();                                 // configure system clock
   DLY_ms(5);                                    // wait for clock to stabilize
-  VEN_init();                                   // init USB vendor-specific device
+  PERF_init();                                  // init performance counters
+  TICK_init();                                  // start millisecond tick
+  CFG_init();                                   // load device configuration
   I2C_init();                                   // init I2C
+  CFG_initOLED();                               // init OLED according to power-up mode
+  VEN_init();                                   // init USB vendor-specific device
   PWM_set_freq(2000);                           // set buzzer tone frequency
   PWM_write(PIN_BUZZER, 127);                   // set buzzer duty cycle 50%
+  #ifdef WATCHDOG
+  WDT_start();                                  // start watchdog timer
+  #endif
 
   // Loop
   while(1) {
-    if(VEN_BOOT_flag)   BOOT_now();             // enter bootloader?
-    if(VEN_BUZZER_flag) PWM_start(PIN_BUZZER);  // buzzer start?
-    else {                                      // buzzer stop?
-      PWM_stop(PIN_BUZZER);
-      PIN_high(PIN_BUZZER);
-    }
-
-    if(VEN_I2C_flag) {                          // I2C start?
-      I2C_start();                              // set I2C start condition
-      while(VEN_I2C_flag) {                     // repeat for all incoming bytes
-        while(VEN_available())                  // incoming bulk data?
-          I2C_write(VEN_read());                // write received data byte via I2C
-      }
-      I2C_stop();                               // set I2C stop condition
+    WDT_reset();                                // feed watchdog
+    PERF_loop();                                // measure main loop latency
+    TASK_run(TASK_CONFIG,  CFG_update);         // store received device configuration
+    TASK_run(TASK_STREAM,  streamTask);         // pass bulk data to I2C
+    if(!streaming) {                            // tasks with own I2C transactions:
+      TASK_run(TASK_FRAME, FRAME_update);       // store frame chunk, show frame
+      TASK_run(TASK_TILE,  TILE_update);        // store tiles, draw tile run
+      TASK_run(TASK_GRAY,  GRAY_update);        // send next bitplane
+      TASK_run(TASK_POWER, POWER_update);       // OLED off and power-down on suspend
     }
+    TASK_run(TASK_CONTROL, controlTask);        // bootloader and buzzer
   }
 }